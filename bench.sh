@@ -0,0 +1,5 @@
+mkdir -p bin
+
+# Benchmarks are built from the sources directly, they do not need the console objects of run.sh.
+g++ -std=c++14 -O2 -pthread -o bin/bench_scaling bench/bench_scaling.cpp src/*.cpp src/QuantumGates/*.cpp
+g++ -std=c++14 -O2 -pthread -o bin/bench_gemm bench/bench_gemm.cpp src/*.cpp src/QuantumGates/*.cpp
@@ -0,0 +1,114 @@
+#include "../include/QuantumGate.hpp"
+#include "../include/ThreadPool.hpp"
+#include <chrono>
+#include <random>
+
+/*
+Benchmark of the dense gate product QuantumGate::operator*.
+
+For every matrix size 2^min_log .. 2^max_log, two random matrices are multiplied with the tiled SIMD
+kernel (1 thread and max_threads threads) and with the naive triple loop over operator() that the class
+used before. The table shows the time, the rate in GFLOP/s (8 n^3 real operations) and the largest
+difference to the naive product. The naive loop is skipped above 2^naive_max_log, it takes minutes there.
+
+Usage: bin/bench_gemm [min_log=4] [max_log=12] [naive_max_log=10] [max_threads=hardware threads]
+*/
+
+static QuantumGate random_gate(size_t n, std::mt19937_64 &rng)
+{
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    QuantumGate gate(n);
+    for (size_t i = 1; i <= n; i++)
+        for (size_t j = 1; j <= n; j++)
+            gate(i, j) = {uniform(rng), uniform(rng)};
+    return gate;
+}
+
+static QuantumGate naive_product(const QuantumGate &a, const QuantumGate &b)
+{
+    const size_t n = a.get_rows();
+    QuantumGate result(n);
+    for (size_t i = 1; i <= n; i++)
+    {
+        for (size_t j = 1; j <= n; j++)
+        {
+            std::complex<double> sum{0.0, 0.0};
+            for (size_t k = 1; k <= n; k++)
+                sum += a(i, k) * b(k, j);
+            result(i, j) = sum;
+        }
+    }
+    return result;
+}
+
+static double max_difference(const QuantumGate &a, const QuantumGate &b)
+{
+    double difference = 0.0;
+    for (size_t i = 1; i <= a.get_rows(); i++)
+        for (size_t j = 1; j <= a.get_cols(); j++)
+            difference = std::max(difference, std::abs(a(i, j) - b(i, j)));
+    return difference;
+}
+
+static void print_row(size_t n, const std::string &method, size_t thread_n, double ms, const std::string &difference)
+{
+    const double gflops = 8.0 * n * n * n / (ms * 1e6);
+    std::cout << std::setw(8) << n << std::setw(10) << method << std::setw(10) << thread_n
+              << std::setw(14) << std::fixed << std::setprecision(3) << ms
+              << std::setw(10) << std::setprecision(2) << gflops
+              << std::setw(14) << difference << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t min_log = argc > 1 ? std::stoul(argv[1]) : 4;
+    size_t max_log = argc > 2 ? std::stoul(argv[2]) : 12;
+    size_t naive_max_log = argc > 3 ? std::stoul(argv[3]) : 10;
+    size_t max_threads = argc > 4 ? std::stoul(argv[4]) : std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+
+    std::vector<size_t> thread_counts{1};
+    if (max_threads > 1)
+        thread_counts.push_back(max_threads);
+
+    std::cout << std::setw(8) << "n" << std::setw(10) << "method" << std::setw(10) << "threads"
+              << std::setw(14) << "ms" << std::setw(10) << "GFLOP/s" << std::setw(14) << "max diff" << std::endl;
+
+    std::mt19937_64 rng(2024);
+    for (size_t log_n = min_log; log_n <= max_log; log_n++)
+    {
+        const size_t n = size_t(1) << log_n;
+        const QuantumGate a = random_gate(n, rng), b = random_gate(n, rng);
+        // Small products are repeated so that the timings are not below the clock resolution
+        const size_t repeats = std::max<size_t>(1, (size_t(1) << 24) / (n * n * n));
+
+        QuantumGate reference(1);
+        bool has_reference = log_n <= naive_max_log;
+        if (has_reference)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t r = 0; r < repeats; r++)
+                reference = naive_product(a, b);
+            auto stop = std::chrono::steady_clock::now();
+            print_row(n, "naive", 1, std::chrono::duration<double, std::milli>(stop - start).count() / repeats, "-");
+        }
+
+        for (auto it = thread_counts.begin(); it != thread_counts.end(); it++)
+        {
+            set_thread_count(*it);
+            QuantumGate product(1);
+            auto start = std::chrono::steady_clock::now();
+            for (size_t r = 0; r < repeats; r++)
+                product = a * b;
+            auto stop = std::chrono::steady_clock::now();
+
+            std::ostringstream difference;
+            if (has_reference)
+                difference << std::scientific << std::setprecision(1) << max_difference(product, reference);
+            else
+                difference << "-";
+            print_row(n, "tiled", *it, std::chrono::duration<double, std::milli>(stop - start).count() / repeats, difference.str());
+        }
+    }
+
+    return 0;
+}
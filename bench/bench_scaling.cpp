@@ -0,0 +1,93 @@
+#include "../include/QuantumCircuit.hpp"
+#include <chrono>
+#include <cstdint>
+
+/*
+Scaling benchmark of the multithreaded gate kernels.
+
+For every register size from min_qubits to max_qubits, one layer of Hadamard gates, a ladder of CNOT gates
+and one layer of Phase gates is applied to |0...0> with 1, 2, 4, ... up to max_threads threads.
+The table shows the time per gate and the speedup over one thread. The last column checks that the final
+amplitudes are bit-identical to the serial run (compared through a hash of their bytes).
+
+Usage: bin/bench_scaling [min_qubits=16] [max_qubits=30] [max_threads=hardware threads]
+A 30 qubit state takes 16 GB.
+*/
+
+// FNV-1a hash of the raw amplitude bytes
+static uint64_t hash_state(const Statevector &state)
+{
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(state.data());
+    uint64_t hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < state.size() * sizeof(std::complex<double>); i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static std::vector<GateOp> benchmark_gates(size_t qubit_n)
+{
+    std::vector<GateOp> gates;
+    for (size_t q = 0; q < qubit_n; q++)
+        gates.push_back(make_gate_op(GateCode::Hadamard, {q}));
+    for (size_t q = 0; q + 1 < qubit_n; q++)
+        gates.push_back(make_gate_op(GateCode::CNOT, {q, q + 1}));
+    for (size_t q = 0; q < qubit_n; q++)
+        gates.push_back(make_gate_op(GateCode::Phase, {q}, 0.1 * (q + 1)));
+    return gates;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t min_qubits = argc > 1 ? std::stoul(argv[1]) : 16;
+    size_t max_qubits = argc > 2 ? std::stoul(argv[2]) : 30;
+    size_t max_threads = argc > 3 ? std::stoul(argv[3]) : std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+
+    // 1, 2, 4, ... and max_threads itself
+    std::vector<size_t> thread_counts;
+    for (size_t thread_n = 1; thread_n < max_threads; thread_n *= 2)
+        thread_counts.push_back(thread_n);
+    thread_counts.push_back(max_threads);
+
+    std::cout << std::setw(8) << "qubits" << std::setw(10) << "threads" << std::setw(16) << "ms per gate"
+              << std::setw(10) << "speedup" << std::setw(12) << "identical" << std::endl;
+
+    for (size_t qubit_n = min_qubits; qubit_n <= max_qubits; qubit_n++)
+    {
+        std::vector<GateOp> gates = benchmark_gates(qubit_n);
+        const std::vector<QuantumGate> matrices;
+        double serial_time = 0;
+        uint64_t serial_hash = 0;
+
+        for (auto it = thread_counts.begin(); it != thread_counts.end(); it++)
+        {
+            const size_t thread_n = *it;
+            set_thread_count(thread_n);
+
+            Statevector state(qubit_n);
+            state[0] = 1;
+
+            auto start = std::chrono::steady_clock::now();
+            for (auto gate = gates.begin(); gate != gates.end(); gate++)
+                apply_gate(state, *gate, matrices);
+            auto stop = std::chrono::steady_clock::now();
+
+            double time = std::chrono::duration<double, std::milli>(stop - start).count() / gates.size();
+            uint64_t hash = hash_state(state);
+            if (thread_n == 1)
+            {
+                serial_time = time;
+                serial_hash = hash;
+            }
+
+            std::cout << std::setw(8) << qubit_n << std::setw(10) << thread_n
+                      << std::setw(16) << std::fixed << std::setprecision(3) << time
+                      << std::setw(10) << std::setprecision(2) << serial_time / time
+                      << std::setw(12) << (hash == serial_hash ? "yes" : "NO") << std::endl;
+        }
+    }
+
+    return 0;
+}
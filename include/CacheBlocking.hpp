@@ -0,0 +1,50 @@
+#ifndef CACHEBLOCKING_HPP
+#define CACHEBLOCKING_HPP
+
+#include "QuantumCircuit.hpp"
+
+/*
+Cache-blocked execution of a gate list.
+
+Applying the gates one by one streams the whole statevector through memory once per gate. Once the
+state is larger than the caches, the simulation is limited by the memory bandwidth.
+
+The blocked executor cuts the statevector into chunks of 2^b consecutive amplitudes (b = cache block
+qubits, 2^14 amplitudes = 256 KB by default, the size of a typical L2 cache). A chunk contains every
+combination of the b lowest bits of the index, the higher bits are fixed within the chunk:
+
+    index = [ high bits (fixed per chunk) | low bits (b bits, vary inside the chunk) ]
+
+A gate that only mixes amplitudes along low bits can therefore be applied chunk by chunk. Consecutive
+gates of this kind form a group, and the whole group is applied to a chunk while it stays in the cache,
+so the group costs a single pass over memory. Some gates on high bits can still join a group:
+    - diagonal gates (Phase, Pauli Z) on a high bit multiply the whole chunk by the same factor,
+    - a CNOT with a high control bit and a low target bit is an X on the target, or nothing,
+    - a controlled phase is diagonal too, on any two bits: with a high bit it is a phase on the other
+      bit, on the whole chunk, or nothing.
+
+Swap gates are never executed: the executor only exchanges the positions of the two qubits in its
+qubit-to-bit mapping. When a gate needs a qubit that currently sits on a high bit, and the qubit is used
+again soon, the executor swaps it with the low qubit whose next use is the furthest away (one pass over
+memory), so the following gates on it stay cheap. Otherwise the gate is applied directly with the
+normal kernels. At the end the mapping is restored with swaps, so the result is the same as evolve().
+*/
+
+// Number of low qubits b in a chunk. Statevectors with at most b qubits are not blocked.
+void set_cache_block_qubits(size_t block_qubits);
+size_t get_cache_block_qubits();
+
+struct BlockingStats
+{
+    size_t gates{0};       // gates in the gate list
+    size_t passes{0};      // passes over the whole statevector
+    size_t qubit_swaps{0}; // swaps executed to move qubits into (or back from) the low bits
+
+    void display() const;
+};
+
+// Apply the gates first .. last - 1 of a circuit (with its matrix table) to the state in place with the cache-blocked schedule.
+void apply_gates_cache_blocked(Statevector &state, const GateOp *first, const GateOp *last,
+                               const std::vector<QuantumGate> &matrices, BlockingStats *stats = nullptr);
+
+#endif // CACHEBLOCKING_HPP
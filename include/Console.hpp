@@ -46,6 +46,10 @@ public:
     size_t read_option();
     std::string process_option(size_t option);
     Statevector get_initial_state(size_t option);
+    std::string read_basis_state();
+    void simulate_clifford_circuit();
+    void simulate_reversible_circuit();
+    void simulate_mps_circuit();
 };
 
 class DisplayInfoConsole : public QuantumCircuitConsole
@@ -66,4 +70,7 @@ public:
 
 void start_program();
 
+// List the most frequent measurement outcomes of a sampling, with their counts
+void display_counts(const std::map<std::string, size_t> &counts);
+
 #endif
\ No newline at end of file
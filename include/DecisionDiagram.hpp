@@ -0,0 +1,91 @@
+#ifndef DECISIONDIAGRAM_HPP
+#define DECISIONDIAGRAM_HPP
+
+#include "Statevector.hpp"
+#include "QuantumGate.hpp"
+
+/*
+Decision diagram (QMDD) simulator.
+
+The statevector is stored as a directed acyclic graph with one level per qubit. A node of level q
+has two weighted edges, for qubit q = 0 and qubit q = 1, and the amplitude of a basis state is the
+product of the weights along its path from the root to the terminal node:
+
+    GHZ state (|000> + |111>) / sqrt(2), the zero edges are not drawn
+
+              │ 1/sqrt(2)
+            (q0)
+           0/  \1
+         (q1)  (q1)
+          0|    |1
+         (q2)  (q2)
+           0\  /1
+            [ 1 ]   terminal
+
+Equal sub-vectors are stored once: every node is normalised (its largest edge weight is 1, the factor
+moves to the incoming edge) and looked up in a unique table before it is created, so regular states
+such as GHZ, W or basis states take O(n) nodes instead of 2^n amplitudes.
+
+Gates are decision diagrams as well, with four edges per node (the four 2x2 blocks of the matrix at
+that level). Applying a gate is a recursive matrix-vector product; the results of the products and of
+the additions are memoised in compute tables, so shared sub-diagrams are only processed once.
+
+Edge weights are canonicalised in a complex table: values closer than 1e-13 share one entry, so the
+weights (and the node keys of the unique table) compare by pointer and rounding noise does not
+prevent sharing.
+
+Nodes are never freed, the package only grows while a circuit is simulated. Copies of a DecisionDiagram
+share the package, nodes are immutable.
+
+Example of usage:
+>>DecisionDiagram dd(3, "000");
+>>dd.apply_gate({0}, QuantumGate::Hadamard2x2);
+>>dd.apply_gate({0, 1}, QuantumGate::CNOT4x4);
+>>dd.apply_gate({1, 2}, QuantumGate::CNOT4x4);
+>>dd.amplitude("111");      // 0.707
+>>dd.node_count();          // 5
+*/
+
+struct DDNode;
+
+// A weighted edge. The weight points to a canonical entry of the complex table.
+struct DDEdge
+{
+    DDNode *node;
+    const std::complex<double> *weight;
+};
+
+// Unique table, compute tables and complex table shared by the diagrams of one simulation
+class DDPackage;
+
+class DecisionDiagram
+{
+private:
+    size_t qubit_n;
+    std::shared_ptr<DDPackage> package;
+    DDEdge root;
+
+public:
+    // A standard basis state given as a string of binary digits (qubit 0 first), e.g. "0110"
+    DecisionDiagram(size_t qubit_n_, const std::string &basis_state);
+    DecisionDiagram(size_t qubit_n_ = 1);
+
+    size_t qubit_num() const { return qubit_n; }
+
+    // Apply a 2^k x 2^k gate to the k target qubits (the first target is the most significant bit of the rows)
+    void apply_gate(const std::vector<size_t> &qubits, const QuantumGate &gate);
+
+    std::complex<double> amplitude(const std::string &basis_state) const;
+    // The dense statevector, only for small numbers of qubits
+    Statevector to_statevector() const;
+
+    // Sample measurements of all qubits without changing the state. Returns the count of each outcome (qubit 0 first).
+    std::map<std::string, size_t> sample(size_t shots, std::mt19937_64 &rng) const;
+
+    // Nodes reachable from the root, i.e. the size of this state
+    size_t node_count() const;
+    // Nodes created in the package so far, by all the states and gates
+    size_t package_node_count() const;
+};
+
+#endif // DECISIONDIAGRAM_HPP
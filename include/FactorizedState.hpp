@@ -0,0 +1,76 @@
+#ifndef FACTORIZEDSTATE_HPP
+#define FACTORIZEDSTATE_HPP
+
+#include "Statevector.hpp"
+#include "QuantumGate.hpp"
+
+/*
+Statevector kept as a tensor product of independent clusters of qubits.
+
+Qubits that have never interacted are not entangled, so the state is a product of small statevectors,
+one per cluster:
+
+    |psi> = |c0> (x) |c1> (x) ... (x) |ck>        memory: sum of 2^|ci| instead of 2^n
+
+A basis state starts with one cluster per qubit. A gate on the qubits of one cluster is applied to the
+cluster only, with the usual kernels. A gate on qubits of several clusters (CNOT, a fused block) first
+merges them into one cluster, the Kronecker product of their statevectors. A Swap never merges: it only
+exchanges the labels of the two qubits, in the same cluster or across two clusters.
+
+A 100 qubit circuit with a few CNOTs therefore costs a few small statevectors. The full statevector is
+only built on demand by to_statevector(); amplitudes and samples come from the clusters directly.
+
+Example of usage:
+>>FactorizedState state(100, std::string(100, '0'));
+>>state.apply_gate({0}, QuantumGate::Hadamard2x2);
+>>state.apply_gate({0, 1}, QuantumGate::CNOT4x4);
+>>state.cluster_num();        // 99: {0, 1} and 98 single qubits
+>>state.largest_cluster();    // 2
+*/
+
+class FactorizedState
+{
+private:
+    struct Cluster
+    {
+        std::vector<size_t> qubits; // qubits[j] is the local qubit j of the statevector
+        Statevector state;
+    };
+
+    size_t qubit_n;
+    std::vector<Cluster> clusters;
+    std::vector<size_t> cluster_of;  // cluster of each qubit
+    std::vector<size_t> position_of; // local qubit of each qubit in its cluster
+
+    void update_labels();
+    // Merge cluster b into cluster a (a < b), the qubits of b become the low qubits of the result
+    void merge(size_t a, size_t b);
+
+public:
+    // Clusters larger than this would not fit in memory
+    static const size_t MAX_CLUSTER_QUBITS = 30;
+
+    // A standard basis state given as a string of binary digits (qubit 0 first), e.g. "0110"
+    FactorizedState(size_t qubit_n_, const std::string &basis_state);
+    FactorizedState(size_t qubit_n_ = 1);
+
+    size_t qubit_num() const { return qubit_n; }
+    size_t cluster_num() const { return clusters.size(); }
+    size_t largest_cluster() const;
+    // The qubits of each cluster
+    std::vector<std::vector<size_t>> cluster_qubits() const;
+    // Number of amplitudes stored in all the clusters
+    size_t memory_size() const;
+
+    // Apply a 2^k x 2^k gate to the k target qubits (the first target is the most significant bit of the rows)
+    void apply_gate(const std::vector<size_t> &qubits, const QuantumGate &gate);
+    void apply_swap(size_t qubit1, size_t qubit2);
+
+    std::complex<double> amplitude(const std::string &basis_state) const;
+    // Sample measurements of all qubits without changing the state, each cluster is sampled independently
+    std::map<std::string, size_t> sample(size_t shots, std::mt19937_64 &rng) const;
+    // The dense statevector, only for small numbers of qubits
+    Statevector to_statevector() const;
+};
+
+#endif // FACTORIZEDSTATE_HPP
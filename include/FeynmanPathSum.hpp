@@ -0,0 +1,72 @@
+#ifndef FEYNMANPATHSUM_HPP
+#define FEYNMANPATHSUM_HPP
+
+#include "Statevector.hpp"
+#include "QuantumGate.hpp"
+
+/*
+Feynman path-sum simulator: an amplitude <x|C|b> is the sum, over all the sequences of basis states
+the circuit can go through, of the products of the matrix entries along the way.
+
+    |b> ──[X]──[H]──•──[H]── <x|          H has two nonzero entries per column: each Hadamard
+                    │                      doubles the number of paths, 2^h paths in total.
+    |0> ────────────⊕──[P]──               X, Pauli, Phase, CNOT and Swap have one entry per column:
+                                           they only flip bits and multiply the path weight.
+
+The paths are enumerated depth first, so the memory is linear in the size of the circuit and does not
+depend on the number of qubits, while the time is O(2^h gates). This fits deep circuits of many qubits
+with few Hadamard gates, whose statevector would not fit in memory.
+
+For the threads, the paths are split at the first branching gates into independent subtrees, which are
+shared out over the global pool of get_thread_count() threads; the partial sums are added in a fixed order.
+Gates with more than one nonzero entry per column (Hadamard, fused blocks) branch over their nonzero
+entries. The basis states are stored in 64 bit words, so at most 64 qubits are supported.
+
+Example of usage:
+>>FeynmanPathSum paths(3, "000");
+>>paths.add_gate({0}, QuantumGate::Hadamard2x2);
+>>paths.add_gate({0, 1}, QuantumGate::CNOT4x4);
+>>paths.path_count();           // 2
+>>paths.amplitude("110");       // 0.707
+*/
+
+class FeynmanPathSum
+{
+private:
+    // A gate as the list of nonzero entries (row, value) of each column, on the bits of its targets
+    struct PathGate
+    {
+        std::vector<size_t> bits; // bit positions of the targets in the basis state, the first target is the high bit of the rows
+        std::vector<std::vector<std::pair<size_t, std::complex<double>>>> columns;
+    };
+
+    size_t qubit_n;
+    uint64_t initial_bits;
+    std::vector<PathGate> gates;
+
+    // Move the path over the gates that do not branch for its basis state, false if its weight becomes zero
+    bool advance(size_t &gate, uint64_t &bits, std::complex<double> &weight) const;
+    // Sum of the paths from gate onwards that end in target
+    std::complex<double> sum_paths(size_t gate, uint64_t bits, std::complex<double> weight, uint64_t target) const;
+
+public:
+    static const size_t MAX_QUBITS = 64;
+
+    // The input state is the basis state given as a string of binary digits (qubit 0 first), e.g. "0110"
+    FeynmanPathSum(size_t qubit_n_, const std::string &basis_state);
+    FeynmanPathSum(size_t qubit_n_ = 1);
+
+    size_t qubit_num() const { return qubit_n; }
+    size_t gate_num() const { return gates.size(); }
+
+    // Append a 2^k x 2^k gate on the k target qubits (the first target is the most significant bit of the rows)
+    void add_gate(const std::vector<size_t> &qubits, const QuantumGate &gate);
+
+    // Upper bound of the number of paths (2^h for h Hadamard gates)
+    double path_count() const;
+
+    // The amplitude <x|C|b> of a bitstring (qubit 0 first)
+    std::complex<double> amplitude(const std::string &bitstring) const;
+};
+
+#endif // FEYNMANPATHSUM_HPP
@@ -0,0 +1,220 @@
+#ifndef FIXEDGATE_HPP
+#define FIXEDGATE_HPP
+
+#include "QuantumGate.hpp"
+#include "GateKernels.hpp"
+#include <array>
+
+/*
+Gates of a size known at compile time.
+
+A QuantumGate keeps its matrix on the heap, so every copy of QuantumGate::Hadamard2x2 or CNOT4x4 is an
+allocation and a round() pass. FixedGate<N> is the 2^N x 2^N matrix of an N qubit gate stored inline:
+
+    FixedGate<1>    4 entries     64 bytes
+    FixedGate<2>   16 entries    256 bytes      on the stack, no allocation, trivially copyable
+
+std::complex is not a literal type in C++14, so the entries are FixedComplex (two doubles) with
+constexpr arithmetic. Products and Kronecker products of fixed gates are constexpr, so the matrices of
+the named gates and their combinations are computed by the compiler:
+
+    constexpr FixedGate<2> HH = kronecker(FixedHadamard2x2, FixedHadamard2x2);
+    constexpr FixedGate<2> CZ = kronecker(FixedIdentity2x2, FixedHadamard2x2) * FixedCNOT4x4 * kronecker(FixedIdentity2x2, FixedHadamard2x2);
+
+apply_fixed_gate<N>() applies a fixed gate in place to N qubits of a statevector. The loops over the
+entries of the matrix have constant bounds and are unrolled; N = 1 and N = 2 have their own kernels,
+which read the 2 or 4 amplitudes of a group directly instead of gathering them through an offset table.
+The rows of the matrix follow the order of the qubits, as for apply_multi_qubit_gate().
+
+Example of usage:
+>>apply_fixed_gate<1>(state, {{2}}, FixedHadamard2x2);
+>>apply_fixed_gate<2>(state, {{0, 3}}, FixedCNOT4x4);
+>>FixedGate<2> g = to_fixed_gate<2>(fused_block);                 // a 4x4 QuantumGate, copied to the stack
+>>to_quantum_gate(kronecker(FixedPauliX, FixedPauliZ)).display_matrix();
+*/
+
+struct FixedComplex
+{
+    double re;
+    double im;
+
+    std::complex<double> value() const { return std::complex<double>(re, im); }
+};
+
+constexpr FixedComplex operator+(const FixedComplex &a, const FixedComplex &b)
+{
+    return FixedComplex{a.re + b.re, a.im + b.im};
+}
+
+constexpr FixedComplex operator*(const FixedComplex &a, const FixedComplex &b)
+{
+    return FixedComplex{a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re};
+}
+
+constexpr bool operator==(const FixedComplex &a, const FixedComplex &b)
+{
+    return a.re == b.re && a.im == b.im;
+}
+
+// m x, without the NaN handling of std::complex multiplication
+inline std::complex<double> fixed_multiply(const FixedComplex &m, const std::complex<double> &x)
+{
+    return std::complex<double>(m.re * x.real() - m.im * x.imag(), m.re * x.imag() + m.im * x.real());
+}
+
+template <size_t N>
+struct FixedGate
+{
+    static constexpr size_t DIM = static_cast<size_t>(1) << N;
+
+    FixedComplex entries[DIM * DIM]; // row-major
+
+    // 1-indexed, as QuantumGate::operator()
+    constexpr const FixedComplex &operator()(size_t row, size_t col) const { return entries[(row - 1) * DIM + col - 1]; }
+    constexpr FixedComplex &operator()(size_t row, size_t col) { return entries[(row - 1) * DIM + col - 1]; }
+};
+
+template <size_t N>
+constexpr size_t FixedGate<N>::DIM;
+
+template <size_t N>
+constexpr FixedGate<N> operator*(const FixedGate<N> &a, const FixedGate<N> &b)
+{
+    FixedGate<N> result{};
+    for (size_t i = 0; i < FixedGate<N>::DIM; i++)
+        for (size_t j = 0; j < FixedGate<N>::DIM; j++)
+        {
+            FixedComplex sum{0.0, 0.0};
+            for (size_t k = 0; k < FixedGate<N>::DIM; k++)
+                sum = sum + a.entries[i * FixedGate<N>::DIM + k] * b.entries[k * FixedGate<N>::DIM + j];
+            result.entries[i * FixedGate<N>::DIM + j] = sum;
+        }
+    return result;
+}
+
+// A ⊗ B, A acts on the first qubits
+template <size_t A, size_t B>
+constexpr FixedGate<A + B> kronecker(const FixedGate<A> &a, const FixedGate<B> &b)
+{
+    FixedGate<A + B> result{};
+    const size_t da = FixedGate<A>::DIM, db = FixedGate<B>::DIM;
+    for (size_t i = 0; i < da; i++)
+        for (size_t j = 0; j < da; j++)
+            for (size_t k = 0; k < db; k++)
+                for (size_t l = 0; l < db; l++)
+                    result.entries[(i * db + k) * (da * db) + j * db + l] = a.entries[i * da + j] * b.entries[k * db + l];
+    return result;
+}
+
+constexpr double FIXED_SQRT1_2 = 0.70710678118654752440;
+
+constexpr FixedGate<1> FixedIdentity2x2{{{1, 0}, {0, 0},
+                                         {0, 0}, {1, 0}}};
+constexpr FixedGate<1> FixedPauliX{{{0, 0}, {1, 0},
+                                    {1, 0}, {0, 0}}};
+constexpr FixedGate<1> FixedPauliY{{{0, 0}, {0, -1},
+                                    {0, 1}, {0, 0}}};
+constexpr FixedGate<1> FixedPauliZ{{{1, 0}, {0, 0},
+                                    {0, 0}, {-1, 0}}};
+constexpr FixedGate<1> FixedHadamard2x2{{{FIXED_SQRT1_2, 0}, {FIXED_SQRT1_2, 0},
+                                         {FIXED_SQRT1_2, 0}, {-FIXED_SQRT1_2, 0}}};
+constexpr FixedGate<2> FixedCNOT4x4{{{1, 0}, {0, 0}, {0, 0}, {0, 0},
+                                     {0, 0}, {1, 0}, {0, 0}, {0, 0},
+                                     {0, 0}, {0, 0}, {0, 0}, {1, 0},
+                                     {0, 0}, {0, 0}, {1, 0}, {0, 0}}};
+constexpr FixedGate<2> FixedSWAP4x4{{{1, 0}, {0, 0}, {0, 0}, {0, 0},
+                                     {0, 0}, {0, 0}, {1, 0}, {0, 0},
+                                     {0, 0}, {1, 0}, {0, 0}, {0, 0},
+                                     {0, 0}, {0, 0}, {0, 0}, {1, 0}}};
+
+// The phase gates need cos and sin, which are not constexpr
+FixedGate<1> fixed_phase(double phase);
+FixedGate<2> fixed_controlled_phase(double phase);
+
+// Copy a 2^N x 2^N QuantumGate (dense or sparse) to a fixed gate
+template <size_t N>
+FixedGate<N> to_fixed_gate(const QuantumGate &gate)
+{
+    if (gate.get_rows() != FixedGate<N>::DIM || gate.get_cols() != FixedGate<N>::DIM)
+        throw std::invalid_argument("The size of the gate does not match the fixed gate!");
+
+    FixedGate<N> result;
+    for (size_t i = 1; i <= FixedGate<N>::DIM; i++)
+        for (size_t j = 1; j <= FixedGate<N>::DIM; j++)
+            result(i, j) = FixedComplex{gate(i, j).real(), gate(i, j).imag()};
+    return result;
+}
+
+template <size_t N>
+QuantumGate to_quantum_gate(const FixedGate<N> &gate)
+{
+    QuantumGate result(FixedGate<N>::DIM);
+    for (size_t i = 1; i <= FixedGate<N>::DIM; i++)
+        for (size_t j = 1; j <= FixedGate<N>::DIM; j++)
+            result(i, j) = gate(i, j).value();
+    return result;
+}
+
+/*
+Apply a fixed gate to N distinct qubits in place. The general version gathers the 2^N amplitudes of each
+group through an offset table on the stack, the specialisations for N = 1 and 2 index them directly.
+All parameters are passed to parallel_for() through one reference, so the std::function holds the lambda
+without a heap allocation.
+*/
+template <size_t N>
+void apply_fixed_gate(Statevector &state, const std::array<size_t, N> &qubits, const FixedGate<N> &gate)
+{
+    const size_t dim = FixedGate<N>::DIM;
+    const size_t qubit_n = state.qubit_num();
+
+    struct Job
+    {
+        std::complex<double> *amp;
+        const FixedGate<N> &gate;
+        size_t sorted_bits[N];
+        size_t offsets[FixedGate<N>::DIM];
+    } job{state.data(), gate, {0}, {0}};
+
+    for (size_t l = 0; l < N; l++)
+    {
+        if (qubits[l] >= qubit_n)
+            throw std::invalid_argument("Target qubit is out of range!");
+        job.sorted_bits[l] = qubit_n - 1 - qubits[l];
+    }
+    std::sort(job.sorted_bits, job.sorted_bits + N);
+    if (std::adjacent_find(job.sorted_bits, job.sorted_bits + N) != job.sorted_bits + N)
+        throw std::invalid_argument("The target qubits must be distinct!");
+
+    for (size_t j = 0; j < dim; j++)
+        for (size_t l = 0; l < N; l++)
+            if (j & (static_cast<size_t>(1) << (N - 1 - l)))
+                job.offsets[j] |= static_cast<size_t>(1) << (qubit_n - 1 - qubits[l]);
+
+    parallel_for(0, state.size() >> N, [&job](size_t begin, size_t end)
+    {
+        std::complex<double> in[FixedGate<N>::DIM];
+        for (size_t g = begin; g < end; g++)
+        {
+            size_t base = g;
+            for (size_t l = 0; l < N; l++)
+                base = insert_zero_bit(base, job.sorted_bits[l]);
+
+            for (size_t j = 0; j < FixedGate<N>::DIM; j++)
+                in[j] = job.amp[base + job.offsets[j]];
+            for (size_t r = 0; r < FixedGate<N>::DIM; r++)
+            {
+                std::complex<double> sum{0.0, 0.0};
+                for (size_t c = 0; c < FixedGate<N>::DIM; c++)
+                    sum += fixed_multiply(job.gate.entries[r * FixedGate<N>::DIM + c], in[c]);
+                job.amp[base + job.offsets[r]] = sum;
+            }
+        }
+    });
+}
+
+template <>
+void apply_fixed_gate<1>(Statevector &state, const std::array<size_t, 1> &qubits, const FixedGate<1> &gate);
+template <>
+void apply_fixed_gate<2>(Statevector &state, const std::array<size_t, 2> &qubits, const FixedGate<2> &gate);
+
+#endif // FIXEDGATE_HPP
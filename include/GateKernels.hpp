@@ -0,0 +1,121 @@
+#ifndef GATEKERNELS_HPP
+#define GATEKERNELS_HPP
+
+#include "Statevector.hpp"
+#include "QuantumGate.hpp"
+#include "ThreadPool.hpp"
+
+/*
+Matrix-free gate kernels.
+Instead of building the 2^n x 2^n Kronecker product of a gate and multiplying it with the statevector,
+the kernels apply the small core matrix of the gate (e.g. the 2x2 Hadamard) directly to the amplitudes.
+
+Qubit q of an n-qubit statevector corresponds to bit (n - 1 - q) of the amplitude index, which is the same
+ordering used by the Kronecker products in the gate classes (qubit 0 is the leftmost factor).
+A single qubit gate on qubit q therefore mixes the amplitude pairs (i, i + stride) with stride = 2^(n-1-q):
+
+    index:  0 1 2 3 4 5 6 7          (3 qubits, gate on qubit 1, stride = 2)
+    pairs: (0,2) (1,3) (4,6) (5,7)
+
+Each pair is updated in place as
+    ┌ a0 ┐    ┌ m00 m01 ┐ ┌ a0 ┐
+    └ a1 ┘ <- └ m10 m11 ┘ └ a1 ┘
+so one gate costs O(2^n) time and no additional memory.
+
+Every kernel splits its loop over the amplitudes (or amplitude pairs) into contiguous chunks with
+parallel_for() from ThreadPool.hpp. States below the grain size are processed serially.
+*/
+
+// Return the distance between the two amplitudes of a pair mixed by a gate on the given qubit.
+inline size_t qubit_stride(size_t qubit_n, size_t qubit)
+{
+    return static_cast<size_t>(1) << (qubit_n - 1 - qubit);
+}
+
+/*
+Insert a 0 at the given bit position of k, shifting the higher bits up by one.
+Enumerating k = 0 .. 2^(n-1) - 1 and inserting a 0 at the bit of a qubit visits every index whose
+bit for that qubit is 0 exactly once, which is how the permutation kernels find the pairs to swap.
+*/
+inline size_t insert_zero_bit(size_t k, size_t bit)
+{
+    const size_t low_mask = (static_cast<size_t>(1) << bit) - 1;
+    return ((k & ~low_mask) << 1) | (k & low_mask);
+}
+
+// Apply a 2x2 gate core to a single qubit of the statevector in place.
+void apply_single_qubit_gate(Statevector &state, size_t qubit, const QuantumGate &core);
+
+/*
+Permutation kernels. X, CNOT and Swap only move amplitudes around, so they are applied as
+in-place swaps of amplitude pairs selected by bit masks, without any matrix:
+    X(q)         swaps i <-> i ^ mask(q)                       for every i with bit q = 0
+    CNOT(c, t)   swaps i <-> i ^ mask(t)                       for every i with bit c = 1, bit t = 0
+    Swap(q1, q2) swaps i <-> i ^ mask(q1) ^ mask(q2)           for every i with bit q1 = 1, bit q2 = 0
+*/
+void apply_pauli_x(Statevector &state, size_t qubit);
+void apply_cnot(Statevector &state, size_t control_qubit, size_t target_qubit);
+void apply_swap(Statevector &state, size_t qubit1, size_t qubit2);
+
+/*
+Diagonal gates. Phase, Pauli Z (and any other 2x2 core without off-diagonal entries) only multiply
+each amplitude by d0 or d1 depending on the bit of the target qubit. Diagonal gates commute with each
+other, so a run of them can be merged and applied in a single pass over the statevector.
+*/
+struct DiagonalFactor
+{
+    size_t qubit;
+    std::complex<double> d0; // factor for amplitudes with the qubit in |0>
+    std::complex<double> d1; // factor for amplitudes with the qubit in |1>
+};
+
+// Return true if the 2x2 core has no off-diagonal entries.
+bool is_diagonal(const QuantumGate &core);
+
+void apply_diagonal_gate(Statevector &state, size_t qubit, std::complex<double> d0, std::complex<double> d1);
+
+// Apply a run of diagonal factors in one pass. Factors on the same qubit are multiplied together first.
+void apply_diagonal_gates(Statevector &state, const std::vector<DiagonalFactor> &factors);
+
+// Multiply the amplitudes with both qubits in |1> by the factor (controlled phase, symmetric in the two qubits).
+void apply_controlled_phase(Statevector &state, size_t qubit1, size_t qubit2, std::complex<double> factor);
+
+/*
+Hadamard layers. H on k qubits is a partial Walsh-Hadamard transform: every target bit gets the butterfly
+    a0, a1  <-  a0 + a1, a0 - a1
+and the result is scaled by 2^(-k/2) once. The transform is applied in place without any matrix:
+    - the butterflies on low bits (below 2^12 amplitudes) are all done chunk by chunk in one pass,
+      while the chunk stays in the cache,
+    - the butterflies on high bits are done 4 bits per pass, on groups of 16 amplitudes gathered
+      from 16 sequential streams.
+A layer therefore costs O(k 2^n) operations in 1 + ceil(high targets / 4) passes over the statevector.
+A qubit listed twice cancels (H H = I). Returns the number of passes.
+*/
+size_t apply_hadamard_layer(Statevector &state, const std::vector<size_t> &qubits);
+
+/*
+Quantum Fourier transform of the qubits first_qubit .. first_qubit + m - 1 (first_qubit is the most
+significant bit of the register value x):
+    QFT |x> = 1/sqrt(M) sum_k e^{2 pi i x k / M} |k>,        M = 2^m
+so for every setting of the other qubits, the M amplitudes along the register are transformed by a
+discrete Fourier transform. It is computed in place as a radix-2 FFT in O(m 2^n) instead of the
+m (m + 1) / 2 gate passes of the H and controlled phase decomposition:
+
+    index = [ qubits before | x (m bits) | qubits after (low bits) ]
+    1. bit reversal of x, scaled by 1/sqrt(M)                                         1 pass
+    2. butterfly stages s = 0 .. m-1 on bit (low + s), twiddle e^{±i pi j / 2^s}
+       the stages on low bits (below 2^12 amplitudes) are done chunk by chunk         1 pass
+       the other stages 4 at a time, on groups of 16 gathered amplitudes             1 pass per 4 stages
+
+The inverse transform uses e^{-2 pi i x k / M}.
+*/
+void apply_fourier_transform(Statevector &state, size_t first_qubit, size_t qubit_count, bool inverse = false);
+
+/*
+Apply a dense 2^k x 2^k gate to k qubits in place. The rows and columns of the matrix follow the
+order of the qubits list, e.g. for qubits {3, 1} row 2 (binary 10) means qubit 3 in |1> and qubit 1 in |0>.
+Each group of 2^k amplitudes that only differ in the target bits is gathered, multiplied and written back.
+*/
+void apply_multi_qubit_gate(Statevector &state, const std::vector<size_t> &qubits, const QuantumGate &matrix);
+
+#endif // GATEKERNELS_HPP
@@ -0,0 +1,72 @@
+#ifndef GATEOP_HPP
+#define GATEOP_HPP
+
+#include "QuantumGate.hpp"
+#include <cstdint>
+
+/*
+Compact instruction of a quantum circuit.
+
+A circuit stores its gates as fixed-size records in one contiguous vector, not as QuantumGate objects
+with their own heap-allocated matrices:
+
+    ┌─────────┬────────┬─────────────────────┬──────┬─────────────┬───────┐
+    │  param  │ matrix │ qubits[0] .. [5]    │ code │ qubit_count │ flags │      40 bytes, no pointers
+    └─────────┴────────┴─────────────────────┴──────┴─────────────┴───────┘
+
+The kernels dispatch on code directly (H, X, CNOT, ...), with the angle of a Phase or controlled phase
+gate in param. A gate without a name, e.g. a block produced by gate fusion, has code Matrix and the
+index of its 2^k x 2^k matrix in the matrix table of the circuit. Adding a gate is one push_back of a
+record, and the matrices of the named gates are only built by gate_core() when they are needed (to display
+the circuit, or for a backend that works with matrices).
+
+Example of usage:
+>>std::vector<QuantumGate> matrices;
+>>GateOp h = make_gate_op(GateCode::Hadamard, {0});
+>>GateOp cp = make_gate_op(GateCode::ControlledPhase, {0, 1}, M_PI / 2);
+>>GateOp custom = make_gate_op({2}, QuantumGate::Hadamard2x2 * QuantumGate::PauliX, matrices);
+>>gate_core(cp, matrices).display_matrix();
+*/
+
+enum class GateCode : uint8_t
+{
+    Hadamard,
+    PauliX,
+    PauliY,
+    PauliZ,
+    Identity,
+    Phase,
+    ControlledPhase,
+    CNOT,
+    Swap,
+    Matrix
+};
+
+struct GateOp
+{
+    // Qubits stored inline, the largest gate (or fused block) of a circuit
+    static const size_t MAX_QUBITS = 6;
+    // flags: the gate was added in the same layer as the previous one, e.g. by add_Hadamard({0, 1, 2})
+    static const uint8_t SAME_LAYER = 1;
+
+    double param;     // angle of Phase and ControlledPhase
+    uint32_t matrix;  // index in the matrix table of the circuit, for code Matrix
+    uint32_t qubits[MAX_QUBITS];
+    GateCode code;
+    uint8_t qubit_count;
+    uint8_t flags;
+};
+
+// The record of a named gate
+GateOp make_gate_op(GateCode code, std::initializer_list<size_t> qubits, double param = 0.0);
+// The record of a 2^k x 2^k gate on k qubits. Gates of a known type get their code, the others are appended to matrices.
+GateOp make_gate_op(const std::vector<size_t> &qubits, const QuantumGate &gate, std::vector<QuantumGate> &matrices);
+
+std::vector<size_t> gate_qubits(const GateOp &op);
+QuantumGate::Type gate_type(const GateOp &op);
+// The matrix of the gate on its own qubits (2x2 for a single qubit gate), built on demand
+QuantumGate gate_core(const GateOp &op, const std::vector<QuantumGate> &matrices);
+// True for a single qubit gate without off-diagonal entries (Z, Phase, ...), its diagonal is returned in d0 and d1
+bool diagonal_factors(const GateOp &op, const std::vector<QuantumGate> &matrices, std::complex<double> &d0, std::complex<double> &d1);
+
+#endif // GATEOP_HPP
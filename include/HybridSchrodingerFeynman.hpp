@@ -0,0 +1,97 @@
+#ifndef HYBRIDSCHRODINGERFEYNMAN_HPP
+#define HYBRIDSCHRODINGERFEYNMAN_HPP
+
+#include "Statevector.hpp"
+#include "QuantumGate.hpp"
+#include "GateKernels.hpp"
+
+/*
+Hybrid Schrödinger-Feynman simulator: the register is cut into an upper part (qubits 0 .. cut-1) and a
+lower part (qubits cut .. n-1), each one simulated as a statevector of its own, so a 2 x 2^(n/2)
+memory instead of 2^n.
+
+                    upper: 2^cut amplitudes
+    0 ──[H]──•──────────────
+    1 ───────┼──[H]──•──────
+    ─ ─ ─ ─ ─│─ ─ ─ ─│─ ─ ─   cut
+    2 ───────⊕───────x──────
+    3 ───────────────x──────
+                    lower: 2^(n-cut) amplitudes
+
+A gate across the cut is split into a sum of products of an upper and a lower operator (its operator
+Schmidt decomposition), and the state is the sum, over the choices of one term per crossing gate
+(the paths), of the tensor products of the two halves:
+    CNOT  = |0><0| (x) I  +  |1><1| (x) X                          2 terms
+    Swap  = ( I (x) I  +  X (x) X  +  Y (x) Y  +  Z (x) Z ) / 2     4 terms
+    other gates: singular value decomposition of the reshuffled matrix, at most 4^k terms
+
+The number of paths is the product of the numbers of terms, it is known before the run (path_count())
+and grows exponentially with the number of crossing gates, so the cut should cross few gates. The
+paths are independent jobs, shared out over get_thread_count() threads; each running job holds its own
+pair of half statevectors. The gates before the first crossing gate are simulated once for all paths.
+
+Example of usage:
+>>HybridSchrodingerFeynman hybrid(4, "0000", 2);
+>>hybrid.add_gate({0}, QuantumGate::Hadamard2x2);
+>>hybrid.add_gate({0, 2}, QuantumGate::CNOT4x4);
+>>hybrid.display_plan();                  // 1 crossing gate, 2 paths
+>>hybrid.amplitudes({"0000", "1010"});    // 0.707 0.707
+*/
+
+class HybridSchrodingerFeynman
+{
+private:
+    // A gate on one half, the qubits are numbered within the half
+    struct HalfGate
+    {
+        std::vector<size_t> qubits;
+        QuantumGate gate;
+    };
+
+    /*
+    A gate of the circuit: the sum over the terms k of upper[k] (x) lower[k]. A gate inside one half has
+    a single term and no gate on the other half.
+    */
+    struct HybridGate
+    {
+        std::vector<HalfGate> upper;
+        std::vector<HalfGate> lower;
+        bool crossing;
+    };
+
+    size_t qubit_n;
+    size_t cut;
+    std::string initial_state;
+    std::vector<HybridGate> gates;
+
+    // Run the paths [begin, end), calling collect with the two halves at the end of each path
+    void run_paths(size_t begin, size_t end, const Statevector &upper_start, const Statevector &lower_start,
+                   size_t first_crossing, const std::function<void(const Statevector &, const Statevector &)> &collect) const;
+    // Sum a function of the halves over all the paths, result_n values per path
+    std::vector<std::complex<double>> sum_over_paths(size_t result_n,
+        const std::function<void(const Statevector &, const Statevector &, std::vector<std::complex<double>> &)> &accumulate) const;
+
+public:
+    // The input state is the basis state given as a string of binary digits (qubit 0 first), cut = 0 cuts in the middle
+    HybridSchrodingerFeynman(size_t qubit_n_, const std::string &basis_state, size_t cut_ = 0);
+    HybridSchrodingerFeynman(size_t qubit_n_ = 2);
+
+    size_t qubit_num() const { return qubit_n; }
+    size_t get_cut() const { return cut; }
+
+    // Append a 2^k x 2^k gate on the k target qubits (the first target is the most significant bit of the rows)
+    void add_gate(const std::vector<size_t> &qubits, const QuantumGate &gate);
+
+    size_t crossing_gate_num() const;
+    // Number of paths (product of the numbers of terms of the crossing gates)
+    double path_count() const;
+    // Print the cut, the crossing gates, the paths and the memory of one job
+    void display_plan() const;
+
+    // The amplitudes of the given bitstrings (qubit 0 first)
+    std::vector<std::complex<double>> amplitudes(const std::vector<std::string> &bitstrings) const;
+    // The dense statevector, only for small numbers of qubits
+    Statevector to_statevector() const;
+};
+
+#endif // HYBRIDSCHRODINGERFEYNMAN_HPP
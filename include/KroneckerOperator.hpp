@@ -0,0 +1,64 @@
+#ifndef KRONECKEROPERATOR_HPP
+#define KRONECKEROPERATOR_HPP
+
+#include "QuantumGate.hpp"
+#include "GateKernels.hpp"
+
+/*
+Lazy Kronecker product F0 ⊗ F1 ⊗ .. ⊗ Fm-1 of square 2^k x 2^k gates, kept as its list of factors.
+
+QuantumGate::kronecker() builds the 2^n x 2^n product right away. A KroneckerOperator only stores the
+factors; factor j acts on its own group of qubits, qubit 0 being the leftmost factor as everywhere else:
+
+    qubits   0   1 | 2 | 3   4   5
+           [  F0   | F1|    F2     ]          F0: 4x4, F1: 2x2, F2: 8x8
+
+apply() updates a statevector in place one factor at a time along its tensor axis, with the kernels of
+GateKernels.hpp (a sparse factor is applied slice by slice), in O(2^n sum 2^k_j) time and no matrix of
+size 2^n. Identity factors are skipped.
+
+The product of two operators is computed factor by factor, (A0 ⊗ A1)(B0 ⊗ B1) = A0 B0 ⊗ A1 B1. If the
+two operators split the qubits differently, the factors between the common boundaries are merged first.
+The 2^n x 2^n matrix is only built by to_matrix().
+
+Example of usage:
+>>KroneckerOperator op{QuantumGate::Hadamard2x2, QuantumGate::Identity2x2, QuantumGate::CNOT4x4};
+>>op.apply(state);                                        // H on qubit 0, CNOT on qubits 2 and 3
+>>KroneckerOperator twice = op * op;                      // factors H H, I I, CNOT CNOT
+>>twice.to_matrix().display_matrix();
+*/
+
+class KroneckerOperator
+{
+private:
+    std::vector<QuantumGate> factors;
+    std::vector<size_t> factor_qubits; // number of qubits of each factor
+    size_t qubit_n{0};
+
+public:
+    // The operator on 0 qubits, the neutral element of the Kronecker product
+    KroneckerOperator() {}
+    KroneckerOperator(std::initializer_list<QuantumGate> factors_);
+    KroneckerOperator(const std::vector<QuantumGate> &factors_);
+
+    size_t qubit_num() const { return qubit_n; }
+    size_t get_rows() const { return static_cast<size_t>(1) << qubit_n; }
+    const std::vector<QuantumGate> &get_factors() const { return factors; }
+    // The first qubit of factor j
+    size_t factor_offset(size_t j) const;
+
+    // Append factors on the right, without building anything
+    KroneckerOperator kronecker(const QuantumGate &q) const;
+    KroneckerOperator kronecker(const KroneckerOperator &op) const;
+
+    // Composition (this applied after op), factor by factor
+    KroneckerOperator operator*(const KroneckerOperator &op) const;
+
+    // state <- (F0 ⊗ F1 ⊗ ..) state, in place
+    void apply(Statevector &state) const;
+
+    // The full 2^n x 2^n matrix, sparse if a factor is sparse
+    QuantumGate to_matrix() const;
+};
+
+#endif // KRONECKEROPERATOR_HPP
@@ -0,0 +1,35 @@
+#ifndef MATRIXKERNELS_HPP
+#define MATRIXKERNELS_HPP
+
+#include <complex>
+#include <cstddef>
+
+/*
+Dense complex matrix product C = A B of n x n row-major matrices, used by QuantumGate::operator*.
+
+The naive triple loop reads B column by column and reloads every entry of C n times. Here the product
+is tiled so that every piece of data is reused while it sits in the cache or in a register:
+
+            NC columns                       B is copied panel by panel (KC rows x NC columns) into
+          ┌─────────────┐                    two planar buffers (real and imaginary parts). A panel
+       KC │  panel of B │                    is reused by every row of A, from the L2 cache.
+          └─────────────┘
+     KC   ┌─────────────┐                    The micro-kernel keeps an MR x NR block of C in SIMD
+  ┌─────┐ │ ▓▓          │ MR                 registers for the whole depth KC of the panel: per step
+  │ A   │ │             │                    it loads NR entries of the panel row, broadcasts MR
+  └─────┘ └─────────────┘                    entries of A and does 4 MR NR / width fused multiply-adds.
+              C
+
+    Scalar   MR = 2, NR = 4,  plain C++
+    AVX2     MR = 2, NR = 8,  4 doubles per register, with FMA
+    AVX512   MR = 2, NR = 16, 8 doubles per register
+
+The level is the one of SimdKernels.hpp (get_simd_level()). The rows of C are split between the threads
+of the pool with parallel_for(), every thread packs its own panels, so the result does not depend on the
+number of threads. Matrices smaller than 16 x 16 use a plain loop.
+*/
+
+// C = A B, all three n x n and row-major. C must not overlap A or B.
+void multiply_matrices(const std::complex<double> *a, const std::complex<double> *b, std::complex<double> *c, size_t n);
+
+#endif // MATRIXKERNELS_HPP
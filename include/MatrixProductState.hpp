@@ -0,0 +1,104 @@
+#ifndef MATRIXPRODUCTSTATE_HPP
+#define MATRIXPRODUCTSTATE_HPP
+
+#include "Statevector.hpp"
+#include "QuantumGate.hpp"
+
+/*
+Matrix product state (MPS) simulator for wide circuits with little entanglement.
+
+The amplitude of a basis state is a product of one matrix per qubit:
+
+    <s0 s1 ... s(n-1)|psi> = A0[s0] A1[s1] ... A(n-1)[s(n-1)]
+
+    bond:      1     chi(0)    chi(1)           chi(n-2)    1
+             ──── A0 ────── A1 ────── ... ────── A(n-1) ────
+                  |         |                    |
+                  s0        s1                   s(n-1)
+
+Site q holds a tensor of shape (chi_left, 2, chi_right). The bond dimensions chi grow with the
+entanglement between the left and the right part of the chain, so the memory is O(n chi^2) instead of
+O(2^n). A product state has chi = 1 everywhere.
+
+Single qubit gates only change one tensor. A two qubit gate on neighbouring qubits q, q+1 contracts the
+two tensors, applies the 4x4 matrix and splits the result again with a singular value decomposition
+(SVD). Only the max_bond largest singular values are kept; the discarded weight (the sum of the
+discarded squared singular values) is added to truncation_error(), an estimate of 1 - fidelity.
+Gates on qubits that are not neighbours are applied through a network of adjacent Swap gates that
+brings the qubits next to each other and back.
+
+The state is kept in mixed canonical form around a centre site (the tensors on its left are left
+orthonormal, the ones on its right are right orthonormal), so that truncating the SVD of the two sites
+at the centre is the optimal truncation for the whole state.
+
+Example of usage:
+>>MatrixProductState mps(100, std::string(100, '0'), 32);
+>>mps.apply_single_qubit_gate(0, QuantumGate::Hadamard2x2);
+>>for (size_t q = 1; q < 100; q++) mps.apply_two_qubit_gate(q - 1, q, QuantumGate::CNOT4x4);
+>>std::cout << mps.max_bond_dimension() << " " << mps.truncation_error() << std::endl; // 2 0
+*/
+
+class MatrixProductState
+{
+private:
+    size_t qubit_n;
+    size_t max_bond;
+    std::vector<std::vector<std::complex<double>>> tensors; // tensors[q][(l * 2 + s) * chi_right + r]
+    std::vector<size_t> bonds;                               // bonds[q] is the bond between q and q+1, 1 at both ends
+    size_t centre{0};
+    double discarded_weight{0.0};
+
+    size_t left_bond(size_t q) const { return q == 0 ? 1 : bonds[q - 1]; }
+    size_t right_bond(size_t q) const { return q + 1 == qubit_n ? 1 : bonds[q]; }
+
+    void check_qubit(size_t q) const;
+
+    // Move the orthogonality centre to site q
+    void move_centre(size_t q);
+    // Apply a 4x4 matrix to the neighbouring qubits (q, q+1), q being the high bit of the matrix rows
+    void apply_adjacent_gate(size_t q, const std::vector<std::complex<double>> &matrix);
+
+public:
+    // The basis state given as a string of binary digits (qubit 0 first), e.g. "0110"
+    MatrixProductState(size_t qubit_n_, const std::string &basis_state, size_t max_bond_ = 64);
+    MatrixProductState(size_t qubit_n_ = 1, size_t max_bond_ = 64);
+
+    size_t qubit_num() const { return qubit_n; }
+    size_t get_max_bond() const { return max_bond; }
+    void set_max_bond(size_t max_bond_);
+
+    void apply_single_qubit_gate(size_t q, const QuantumGate &core);
+    // A 4x4 gate whose rows are ordered as |q1 q2>, e.g. CNOT4x4 with control q1 and target q2
+    void apply_two_qubit_gate(size_t q1, size_t q2, const QuantumGate &gate);
+    void apply_swap(size_t q1, size_t q2);
+
+    // Amplitude of a basis state given as a string of binary digits (qubit 0 first)
+    std::complex<double> amplitude(const std::string &basis_state) const;
+    // The dense statevector, only for small numbers of qubits
+    Statevector to_statevector() const;
+
+    /*
+    Sample measurements of all qubits without changing the state. The qubits are drawn one after the
+    other from the conditional probabilities, which the canonical form gives in O(chi^2) per qubit.
+    Returns the number of times each outcome (qubit 0 first) occurred.
+    */
+    std::map<std::string, size_t> sample(size_t shots, std::mt19937_64 &rng);
+
+    // Sum of the squared singular values discarded by the truncations so far
+    double truncation_error() const { return discarded_weight; }
+    size_t max_bond_dimension() const;
+    std::vector<size_t> bond_dimensions() const { return bonds; }
+    // Number of complex numbers stored in the tensors
+    size_t memory_size() const;
+};
+
+/*
+Singular value decomposition M = U diag(S) V^dagger of a rows x cols matrix (row major), by one-sided
+Jacobi rotations. U is rows x k, V is cols x k with k = min(rows, cols), and the singular values are
+sorted in decreasing order.
+*/
+void singular_value_decomposition(const std::vector<std::complex<double>> &matrix, size_t rows, size_t cols,
+                                  std::vector<std::complex<double>> &u, std::vector<double> &s,
+                                  std::vector<std::complex<double>> &v);
+
+#endif // MATRIXPRODUCTSTATE_HPP
@@ -8,6 +8,19 @@
 #include "QuantumGates/CNOT.hpp"
 #include "QuantumGates/Pauli.hpp"
 #include "QuantumGates/Phase.hpp"
+#include "QuantumGates/ControlledPhase.hpp"
+#include "GateOp.hpp"
+#include "GateKernels.hpp"
+#include "SimdKernels.hpp"
+#include "StabilizerTableau.hpp"
+#include "MatrixProductState.hpp"
+#include "SparseStatevector.hpp"
+#include "DecisionDiagram.hpp"
+#include "TensorNetwork.hpp"
+#include "FeynmanPathSum.hpp"
+#include "HybridSchrodingerFeynman.hpp"
+#include "FactorizedState.hpp"
+#include "ReversibleCircuit.hpp"
 #include <utility>
 #include <algorithm>
 
@@ -67,19 +80,70 @@ void add_wire(circuitLine &line, size_t length);
 void add_wire(std::vector<circuitLine> &lines, size_t length);
 
 /*
-The first element of the pair is a vector of size_t that contains the qubits that the gate acts on.
-The second element is the gate. 
-For example, if the Hadamard gate H acts on qubit 0, the pair will be {0, H}.
-If the CNOT gate acts on qubit 0 and 1, the pair will be {{0, 1}, CNOT}.
-If many Hadamard gates act on several qubits parallelly, the pair can be {{0, 1, 2, 3}, H}.
-*/ 
-using GatesWithTarget = std::pair<std::vector<size_t>, QuantumGate>;
+The gates of a circuit are stored as GateOp records (GateOp.hpp): the code of the gate, its qubits and
+its angle, 40 bytes per gate. Only the gates without a code (the fused blocks) keep a matrix, in the
+matrix table of the circuit. For example, a Hadamard gate on qubit 0 is {Hadamard, {0}}, a CNOT gate on
+qubits 0 and 1 is {CNOT, {0, 1}}, and add_Hadamard({0, 1, 2}) stores three Hadamard records.
+*/
+
+// Apply a single gate to the statevector in place, using the kernels in GateKernels.hpp. No matrix is built.
+void apply_gate(Statevector &state, const GateOp &op, const std::vector<QuantumGate> &matrices);
+// Same for the split layout, using the kernels in SimdKernels.hpp.
+void apply_gate(SplitStatevector &state, const GateOp &op, const std::vector<QuantumGate> &matrices);
+// Same for the sparse layout, using the kernels in SparseStatevector.hpp.
+void apply_gate(SparseStatevector &state, const GateOp &op, const std::vector<QuantumGate> &matrices);
+// Apply a 2^k x 2^k gate given as a matrix to k qubits of the statevector, with the kernel of its type
+void apply_gate(Statevector &state, const std::vector<size_t> &qubits, const QuantumGate &gate);
+
+/*
+Statistics of QuantumCircuit::fuse_gates().
+gates_in is the number of gates before the fusion, blocks_out the number of gates (fused blocks)
+that evolve() has to apply afterwards. Every gate costs one pass over the statevector.
+*/
+struct FusionStats
+{
+    size_t gates_in{0};
+    size_t blocks_out{0};
+
+    void display() const;
+};
+
+/*
+Statistics of QuantumCircuit::optimize_gates().
+cancelled_pairs counts the pairs of gates that cancelled (H H, X X, CNOT CNOT, Swap Swap, ...),
+merged_phases the phase gates folded into an earlier one. passes is the number of sweeps over the
+circuit until nothing changed.
+*/
+struct OptimizationStats
+{
+    size_t gates_in{0};
+    size_t gates_out{0};
+    size_t cancelled_pairs{0};
+    size_t merged_phases{0};
+    size_t passes{0};
+
+    void display() const;
+};
+
+/*
+A quantum Fourier transform added with add_QFT() or add_inverse_QFT(). Its decomposition into H,
+controlled phase and Swap gates is stored in the gate list like any other gates, so every backend can
+apply it; the statevector backend recognises the block and runs apply_fourier_transform() instead.
+*/
+struct FourierBlock
+{
+    size_t first_gate;  // index of the first gate of the decomposition in the gate list
+    size_t gate_count;
+    size_t first_qubit;
+    size_t qubit_count;
+    bool inverse;
+};
 
 /*
 The QuantumCircuit class is used to store the gates and the targets.
 The QuantumCircuit object is initialized with the number of qubits, and the gates and targets are added later.
 The friend function evolve() is used to return the statevector after the circuit is applied to it.
-The Hadamard gates are allowed to be added parallely to save spaces.
+A layer of Hadamard gates can be added at once, it is drawn in one column.
 
 Example of usage:
 >>QuantumGate qc(3);
@@ -88,15 +152,92 @@ Example of usage:
 >>qc.display_circuit();
 >>Statevector initial_state{0, 1, 0};
 >>Statevector final_state = evolve(state, qc);
+
+For the SIMD kernels, evolve a SplitStatevector instead:
+>>SplitStatevector split_state{initial_state};
+>>Statevector final_state = evolve(split_state, qc).to_statevector();
+
+If the circuit only contains Clifford gates (is_clifford()), it can be applied to a stabilizer tableau,
+which scales to thousands of qubits:
+>>StabilizerTableau tableau(qc.qubit_num(), "000");
+>>StabilizerTableau final_tableau = evolve(tableau, qc);
+
+Wide circuits with little entanglement can be applied to a matrix product state with a bond dimension cap:
+>>MatrixProductState mps(qc.qubit_num(), "000", 64);
+>>MatrixProductState final_mps = evolve(mps, qc);
+
+A standard basis state that stays sparse (X, CNOT, Swap and Phase gates) is best evolved as a SparseStatevector:
+>>SparseStatevector sparse_state(qc.qubit_num(), "010");
+>>Statevector final_state = evolve(sparse_state, qc).to_statevector();
+
+Structured circuits (GHZ, arithmetic, QFT of basis states) keep a compact decision diagram:
+>>DecisionDiagram dd(qc.qubit_num(), "000");
+>>DecisionDiagram final_dd = evolve(dd, qc);
+>>final_dd.amplitude("111");
+
+When only a few amplitudes are needed, evolve a TensorNetwork and contract it for each bitstring:
+>>TensorNetwork network(qc.qubit_num(), "000");
+>>TensorNetwork final_network = evolve(network, qc);
+>>final_network.plan_contraction().display();
+>>final_network.amplitudes({"000", "111"});
+
+Deep circuits with few Hadamard gates can be summed path by path with a memory linear in the circuit size:
+>>FeynmanPathSum paths(qc.qubit_num(), "000");
+>>FeynmanPathSum final_paths = evolve(paths, qc);
+>>final_paths.amplitude("111");
+
+Registers too large for one statevector can be cut in two halves, the gates across the cut are summed as paths:
+>>HybridSchrodingerFeynman hybrid(qc.qubit_num(), "000", 1);
+>>HybridSchrodingerFeynman final_hybrid = evolve(hybrid, qc);
+>>final_hybrid.display_plan();
+>>final_hybrid.amplitudes({"000", "111"});
+
+Wide circuits with few entangling gates keep the unentangled qubits in separate clusters:
+>>FactorizedState product_state(qc.qubit_num(), "000");
+>>FactorizedState final_product = evolve(product_state, qc);
+>>final_product.cluster_qubits();
+
+A quantum Fourier transform of a contiguous range of qubits is one operation. The statevector backend
+runs it as an FFT over the amplitudes, the other backends apply its H and controlled phase decomposition:
+>>QuantumCircuit qpe(5);
+>>qpe.add_Hadamard({0, 1, 2});
+>>qpe.add_CPhase(2, 4, M_PI / 4);
+>>qpe.add_inverse_QFT(0, 3);
+
+Gates that cancel or merge (H H, CNOT CNOT, Phase Phase, ...) can be removed before the simulation:
+>>OptimizationStats optimization_stats;
+>>QuantumCircuit optimized = qc.optimize_gates(&optimization_stats);
+>>optimization_stats.display();
+
+Circuits of X, Y, CNOT, Swap and diagonal gates (is_reversible()) map basis states to basis states, they are
+compiled to bit operations and run on one or many inputs at once:
+>>ReversibleCircuit reversible(qc.qubit_num());
+>>ReversibleCircuit compiled = evolve(reversible, qc);
+>>compiled.run("010");                          // (output basis state, phase)
+>>compiled.run_batch({"000", "010", "110"});
 */
 
 class QuantumCircuit
 {
 friend Statevector evolve(Statevector &state, QuantumCircuit &circuit, std::string show_step);
+friend SplitStatevector evolve(SplitStatevector &state, QuantumCircuit &circuit);
+friend StabilizerTableau evolve(StabilizerTableau &state, QuantumCircuit &circuit);
+friend MatrixProductState evolve(MatrixProductState &state, QuantumCircuit &circuit);
+friend SparseStatevector evolve(SparseStatevector &state, QuantumCircuit &circuit);
+friend DecisionDiagram evolve(DecisionDiagram &state, QuantumCircuit &circuit);
+friend TensorNetwork evolve(TensorNetwork &state, QuantumCircuit &circuit);
+friend FeynmanPathSum evolve(FeynmanPathSum &state, QuantumCircuit &circuit);
+friend HybridSchrodingerFeynman evolve(HybridSchrodingerFeynman &state, QuantumCircuit &circuit);
+friend FactorizedState evolve(FactorizedState &state, QuantumCircuit &circuit);
+friend ReversibleCircuit evolve(ReversibleCircuit &state, QuantumCircuit &circuit);
 private:
     size_t qubit_n;
-    std::vector<GatesWithTarget> gates_targets;
+    std::vector<GateOp> gates;
+    std::vector<QuantumGate> matrices; // matrices of the gates with code Matrix
+    std::vector<FourierBlock> fourier_blocks;
     std::string info{""};
+
+    void add_Fourier_block(size_t first_qubit, size_t qubit_count, bool inverse);
 public:
     QuantumCircuit();
     QuantumCircuit(size_t qubit_n_);
@@ -108,6 +249,41 @@ public:
     void add_CNOT(size_t q1, size_t q2);
     void add_Pauli(size_t q, std::string pauli_type);
     void add_Phase(size_t q, double phase);
+    // Multiply the amplitudes with both qubits in |1> by e^{i*phase}
+    void add_CPhase(size_t q1, size_t q2, double phase);
+    // Quantum Fourier transform (and its inverse) of the qubits first_qubit .. first_qubit + qubit_count - 1
+    void add_QFT(size_t first_qubit, size_t qubit_count);
+    void add_inverse_QFT(size_t first_qubit, size_t qubit_count);
+    // Any 2^k x 2^k gate on k qubits, gates of a known type are stored by code, the others with their matrix
+    void add_gate(const std::vector<size_t> &qubits, const QuantumGate &gate);
+
+    /*
+    Optional pass before the simulation. Returns an equivalent circuit in which
+    1. consecutive single qubit gates on the same qubit are multiplied into one 2x2 gate, and
+    2. if max_block_qubits > 1, neighbouring gates acting on at most max_block_qubits qubits together
+       are merged into one dense block (a Matrix gate), up to GateOp::MAX_QUBITS qubits.
+    The fused circuit is meant for evolve(), its Matrix blocks are not drawn by display_circuit().
+    */
+    QuantumCircuit fuse_gates(size_t max_block_qubits = 1, FusionStats *stats = nullptr) const;
+
+    /*
+    Peephole optimisation. Returns an equivalent circuit in which pairs of gates that cancel (H H, X X,
+    Y Y, Z Z, CNOT CNOT, Swap Swap) are removed and phase gates on the same qubits are merged,
+    Phase(a) Phase(b) = Phase(a + b). Gates are moved past the gates they commute with, e.g. a Phase
+    through the control of a CNOT, to find their partner. The gates of the Fourier blocks are kept.
+    */
+    QuantumCircuit optimize_gates(OptimizationStats *stats = nullptr) const;
+
+    // True if every gate is H, Pauli X/Y/Z, CNOT, Swap or a Phase of a multiple of 90 degrees
+    bool is_clifford() const;
+    // True if every gate maps basis states to basis states times a phase (X, Y, CNOT, Swap, diagonal gates)
+    bool is_reversible() const;
+
+    size_t qubit_num() const { return qubit_n; }
+    size_t gate_num() const { return gates.size(); }
+    const std::vector<GateOp> &gate_ops() const { return gates; }
+    // The matrix of a gate of the circuit, built on demand
+    QuantumGate gate_matrix(size_t index) const { return gate_core(gates[index], matrices); }
     
     void show_gate_list() const;
     void display_circuit();
@@ -10,6 +10,7 @@
 #include <sstream>
 #include <iomanip>
 #include "Statevector.hpp"
+#include "SparseMatrix.hpp"
 
 /*
 The quantum gate class is a base class for all quantum gates. It contains a 2D array of complex numbers
@@ -21,6 +22,21 @@ gate(2, 3) = array[(2 - 1) * cols + (3 - 1)].
 1 |  x    x   (2, 3)   x |  ==> array [ x  x  x  x  x  x  (2, 3) x ....  ]
 2 |  x    x     x      x |              0  1  2  3  4  5    6
 3 └  x    x     x      x ┘4x4
+
+A gate can instead be stored sparse (CSR, see SparseMatrix.hpp), then array is empty. The gates embedded
+in an n qubit register (Hadamard, Pauli, Phase, CNOT and Swap built for qubit_n qubits) are created sparse,
+with O(2^n) memory instead of O(4^n). Reading an entry through the const operator() works in both modes;
+the non-const operator() converts a sparse gate to a dense one first, as the entry must exist to be written.
+A product with a statevector, a Kronecker product of sparse gates and a product of two sparse gates stay
+sparse, the other operations work on the dense matrix.
+
+Example of usage:
+>>Hadamard h{20, 3};                        // 2^20 x 2^20, two nonzeros per row
+>>std::cout << h.is_sparse() << " " << h.nonzeros() << std::endl;
+>>Statevector s = h * state;
+>>QuantumGate small = CNOT{3, 0, 2};
+>>small.make_dense();
+>>small.display_matrix();
 */
 
 class QuantumGate
@@ -36,6 +52,7 @@ public:
         PauliY,
         PauliZ,
         Phase,
+        ControlledPhase,
         Identity,
         Custom
     };
@@ -50,6 +67,7 @@ protected:
     size_t cols;
     Type type;
     std::unique_ptr<std::complex<double>[]> array;
+    std::unique_ptr<SparseMatrix> sparse; // set instead of array for a sparse gate
     
 public:
     QuantumGate();      // Default constructor. 
@@ -57,6 +75,8 @@ public:
     QuantumGate(size_t size);
     // Constructor that takes the type of the gate, the number of rows and columns, and a list of complex numbers.
     QuantumGate(Type, const size_t, std::initializer_list<std::complex<double>>);
+    // Constructor of a sparse gate from its CSR matrix.
+    QuantumGate(Type, SparseMatrix);
     // The smart pointer will handle the memory so the destructor can be empty.
     ~QuantumGate() {}
 
@@ -97,6 +117,14 @@ public:
     inline size_t get_cols() const { return cols; }
     inline size_t size() const { return rows * cols; }
 
+    // Sparse storage
+    inline bool is_sparse() const { return sparse != nullptr; }
+    inline const SparseMatrix *get_sparse() const { return sparse.get(); }
+    // Number of stored entries, rows * cols for a dense gate
+    size_t nonzeros() const;
+    void make_sparse();
+    void make_dense();
+
     // Format the 2D array as a matrix and return a vector of strings.
     // Requires "Formap.hpp"
     std::vector<std::string> to_string();
@@ -128,6 +156,12 @@ QuantumGate dyad(Statevector &v1, Statevector &v2);
 // Rerturn the product of a quantum gate and a statevector.
 Statevector operator*(QuantumGate &q, Statevector &v);
 
+/*
+Return the gate for qubit_n qubits that applies the 2x2 core to each of the given qubits and the identity
+to the others, core ⊗ I ⊗ .. ⊗ core ⊗ .., built sparse. The type of the result is the type of the core.
+*/
+QuantumGate embed_gate(size_t qubit_n, const std::vector<size_t> &qubits, const QuantumGate &core);
+
 // Return an identity matrix of given size n.
 QuantumGate Identity(size_t n);
 
@@ -2,6 +2,7 @@
 #define CNOT_HPP
 
 #include "../QuantumGate.hpp"
+#include "../GateKernels.hpp"
 
 class CNOT : public QuantumGate
 {
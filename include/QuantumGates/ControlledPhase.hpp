@@ -0,0 +1,24 @@
+#ifndef CONTROLLEDPHASE_HPP
+#define CONTROLLEDPHASE_HPP
+
+#include "../QuantumGate.hpp"
+
+/*
+The controlled phase gate class, derived class of QuantumGate
+The 4x4 core diag(1, 1, 1, e^{i*phase}) multiplies the amplitudes with both qubits in |1> by e^{i*phase}.
+The gate is symmetric in its two qubits, so it does not matter which one is the control.
+*/
+
+class ControlledPhase : public QuantumGate
+{
+private:
+    double phase;
+public:
+    ControlledPhase();
+    ControlledPhase(double phase_);
+    ~ControlledPhase() {}
+
+    double get_phase() const { return phase; }
+};
+
+#endif // CONTROLLEDPHASE_HPP
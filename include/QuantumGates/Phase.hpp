@@ -14,6 +14,8 @@ private:
     double phase;
 public:
     Phase();
+    // Creates the 2x2 core [1, 0, 0, e^{i*phase}] used by the matrix-free kernels.
+    Phase(double phase_);
     Phase(size_t qubit_n_, size_t qubit_eff_, double phase_);
     ~Phase() {}
 
@@ -2,6 +2,7 @@
 #define SWAP_HPP
 
 #include "../QuantumGate.hpp"
+#include "../GateKernels.hpp"
 
 /*
 The Swap class, derived class of QuantumGate
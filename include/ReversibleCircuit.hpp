@@ -0,0 +1,87 @@
+#ifndef REVERSIBLECIRCUIT_HPP
+#define REVERSIBLECIRCUIT_HPP
+
+#include "Statevector.hpp"
+#include "QuantumGate.hpp"
+
+/*
+Fast path for classical reversible circuits with phases.
+
+X, Y, CNOT and Swap map a basis state to another basis state, Z, Phase, controlled phases (and every other diagonal gate)
+multiply it by a phase. A circuit made only of these gates maps a basis state to a single basis state
+times a global phase, which is a classical computation on n bits and one angle:
+
+    X(q)                 bit q ^= 1
+    Y(q)                 angle += (bit q ? -pi/2 : pi/2), bit q ^= 1
+    CNOT(c, t)           bit t ^= bit c
+    Swap(a, b)           exchange bit a and bit b
+    diag(d0, d1) on q    angle += arg(bit q ? d1 : d0)
+    CPhase(a, b, phi)    angle += (bit a & bit b ? phi : 0)
+    [[0, b], [c, 0]]     angle += arg(bit q ? b : c), bit q ^= 1     (fused X and phase gates)
+
+run() keeps the bits in a register of 1, 2 or 4 machine words (64, 128 or 256 qubits), so a gate is
+one or two bit operations.
+
+run_batch() evaluates many inputs at once with bit slicing: the value of qubit q for 256 inputs is
+stored in one slice of four 64 bit words, bit j of the slice belonging to input j. A gate is then a few
+word operations for all 256 inputs (X is a complement, CNOT an XOR, Swap an exchange of slices). The
+angles are accumulated per input with bit-sliced binary counters, one per distinct phase of the circuit,
+and a sign slice for the phases of pi.
+
+Example of usage:
+>>ReversibleCircuit adder(3);
+>>adder.add_gate({0, 2}, QuantumGate::CNOT4x4);
+>>adder.add_gate({1, 2}, QuantumGate::CNOT4x4);
+>>adder.run("110");                                // ("110", 1)
+>>adder.run_batch({"000", "010", "100", "110"});   // 000, 011, 101, 110
+*/
+
+class ReversibleCircuit
+{
+private:
+    struct ReversibleOp
+    {
+        enum class Kind
+        {
+            Flip,  // angle += (bit a ? angle1 : angle0), then bit a ^= 1
+            Phase, // angle += (bit a ? angle1 : angle0)
+            ControlledPhase, // angle += (bit a & bit b ? angle1 : angle0)
+            CNOT,  // bit b ^= bit a
+            Swap   // exchange bits a and b
+        };
+        Kind kind;
+        size_t a;
+        size_t b;
+        double angle0;
+        double angle1;
+        size_t counter; // bit-sliced counter of angle1 - angle0, NO_COUNTER for a difference of 0 or pi
+    };
+
+    size_t qubit_n;
+    std::vector<ReversibleOp> ops;
+    std::vector<double> counter_angles; // the distinct phase differences that need a counter
+
+    template <size_t Words>
+    std::pair<std::string, std::complex<double>> run_register(const std::string &input) const;
+
+public:
+    static const size_t MAX_QUBITS = 256;
+    static const size_t NO_COUNTER = static_cast<size_t>(-1);
+
+    ReversibleCircuit(size_t qubit_n_ = 1);
+
+    size_t qubit_num() const { return qubit_n; }
+    size_t gate_num() const { return ops.size(); }
+
+    // True if the gate maps basis states to basis states times a phase (X, Y, CNOT, Swap, controlled phase, 2x2 diagonal and anti-diagonal gates)
+    static bool is_reversible(const QuantumGate &gate);
+    // Append a gate on the given qubits, throws if the gate is not reversible
+    void add_gate(const std::vector<size_t> &qubits, const QuantumGate &gate);
+
+    // The output basis state (qubit 0 first) and the phase of an input basis state
+    std::pair<std::string, std::complex<double>> run(const std::string &input) const;
+    // The outputs of many inputs, 256 at a time with bit slicing
+    std::vector<std::pair<std::string, std::complex<double>>> run_batch(const std::vector<std::string> &inputs) const;
+};
+
+#endif // REVERSIBLECIRCUIT_HPP
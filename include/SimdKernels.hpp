@@ -0,0 +1,45 @@
+#ifndef SIMDKERNELS_HPP
+#define SIMDKERNELS_HPP
+
+#include "SplitStatevector.hpp"
+#include "QuantumGate.hpp"
+#include "GateKernels.hpp"
+
+/*
+Gate kernels for the structure-of-arrays layout of SplitStatevector.
+They have the same names and the same semantics as the kernels in GateKernels.hpp.
+
+The hot loops (general 2x2 gates and diagonal gates) exist in three versions:
+    Scalar   plain C++, works everywhere
+    AVX2     4 doubles per register, with FMA
+    AVX512   8 doubles per register
+The version is chosen at runtime from the CPUID flags of the machine, so the same executable runs on
+any x86-64 CPU (and on other architectures with the scalar version). The SIMD loops need a qubit stride
+of at least one register width; gates on the last 2 or 3 qubits (stride 1, 2 or 4) use the scalar loop.
+*/
+
+enum class SimdLevel
+{
+    Scalar,
+    AVX2,
+    AVX512
+};
+
+std::ostream &operator<<(std::ostream &os, const SimdLevel &level);
+
+// The best level supported by the CPU (and the compiler)
+SimdLevel detect_simd_level();
+
+// The level used by the kernels. It defaults to detect_simd_level() and can be lowered, e.g. for comparisons.
+SimdLevel get_simd_level();
+void set_simd_level(SimdLevel level);
+
+void apply_single_qubit_gate(SplitStatevector &state, size_t qubit, const QuantumGate &core);
+void apply_diagonal_gate(SplitStatevector &state, size_t qubit, std::complex<double> d0, std::complex<double> d1);
+void apply_pauli_x(SplitStatevector &state, size_t qubit);
+void apply_cnot(SplitStatevector &state, size_t control_qubit, size_t target_qubit);
+void apply_swap(SplitStatevector &state, size_t qubit1, size_t qubit2);
+void apply_controlled_phase(SplitStatevector &state, size_t qubit1, size_t qubit2, std::complex<double> factor);
+void apply_multi_qubit_gate(SplitStatevector &state, const std::vector<size_t> &qubits, const QuantumGate &matrix);
+
+#endif // SIMDKERNELS_HPP
@@ -0,0 +1,52 @@
+#ifndef SPARSEMATRIX_HPP
+#define SPARSEMATRIX_HPP
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+/*
+Complex matrix in compressed sparse row (CSR) format, the sparse storage of QuantumGate.
+
+The gates embedded in an n qubit register (I ⊗ .. ⊗ H ⊗ .. ⊗ I, CNOT, Swap, ...) have one or two
+nonzeros per row, so a dense 2^n x 2^n array is almost all zeros. CSR keeps only the nonzeros, row by
+row, with their column indices sorted:
+
+    ┌ a  0  b  0 ┐          row_start = [ 0     2     3     5   6 ]
+    | 0  c  0  0 |          col_index = [ 0  2  1  0  3  2 ]
+    | d  0  0  e |   ==>    values    = [ a  b  c  d  e  f ]
+    └ 0  0  f  0 ┘          the nonzeros of row i are at [row_start[i], row_start[i + 1])
+
+A gate with k nonzeros per row costs O(k 2^n) memory, and its product with a statevector O(k 2^n) time.
+The Kronecker product of two CSR matrices is again CSR with sorted columns, so an embedded gate is built
+factor by factor without ever allocating the 4^n array. Indices are 0-based, unlike QuantumGate::operator().
+*/
+
+struct SparseMatrix
+{
+    size_t rows{0};
+    size_t cols{0};
+    std::vector<size_t> row_start{0}; // rows + 1 entries
+    std::vector<size_t> col_index;
+    std::vector<std::complex<double>> values;
+
+    size_t nonzeros() const { return values.size(); }
+    // The stored entry (row, col), or nullptr if it is a structural zero
+    const std::complex<double> *find(size_t row, size_t col) const;
+};
+
+// The n x n identity
+SparseMatrix sparse_identity(size_t n);
+// The nonzeros of a dense row-major matrix
+SparseMatrix dense_to_sparse(const std::complex<double> *a, size_t rows, size_t cols);
+// Writes the matrix to a dense row-major array of rows x cols entries
+void sparse_to_dense(const SparseMatrix &m, std::complex<double> *a);
+
+// A ⊗ B
+SparseMatrix sparse_kronecker(const SparseMatrix &a, const SparseMatrix &b);
+// A B, entries that cancel exactly are dropped
+SparseMatrix sparse_product(const SparseMatrix &a, const SparseMatrix &b);
+// y = A x, x has cols entries and y rows entries. y must not overlap x.
+void sparse_multiply(const SparseMatrix &m, const std::complex<double> *x, std::complex<double> *y);
+
+#endif // SPARSEMATRIX_HPP
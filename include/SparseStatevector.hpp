@@ -0,0 +1,100 @@
+#ifndef SPARSESTATEVECTOR_HPP
+#define SPARSESTATEVECTOR_HPP
+
+#include "Statevector.hpp"
+#include "QuantumGate.hpp"
+#include "GateKernels.hpp"
+
+/*
+Sparse statevector: only the nonzero amplitudes are stored, in an open addressing hash table from the
+index to the amplitude (linear probing, capacity a power of two, at most half full).
+
+    slots:  [ 5 | - | 0 | - | - | 3 | - | - ]      index (- is a free slot)
+            [a5 |   |a0 |   |   |a3 |   |   ]      amplitude
+
+A standard basis state has a single amplitude, and the permutation gates (Pauli X, CNOT, Swap) and the
+diagonal gates (Phase, Pauli Z) never increase the number of nonzero amplitudes, so such circuits cost
+O(1) memory and time per gate instead of O(2^n). A Hadamard or another general gate can double the
+number of amplitudes; when the fill ratio (stored amplitudes / 2^n) passes the dense threshold, the
+state switches to a normal Statevector for good and the gates use the dense kernels.
+
+Amplitudes smaller than 1e-15 (rounding residues of cancellations, e.g. H H) are always removed. With
+dropping enabled, every amplitude below ROUND_MINIMUM (1e-10) is removed after each gate, which gives
+an approximate simulation with bounded memory; the probability removed is reported by dropped_weight().
+
+The kernels have the same names and semantics as the ones in GateKernels.hpp.
+*/
+
+class SparseStatevector
+{
+private:
+    size_t qubit_n;
+    std::vector<size_t> keys; // EMPTY_KEY for a free slot
+    std::vector<std::complex<double>> values;
+    size_t entry_n{0};
+    std::unique_ptr<Statevector> dense; // only set once the state is dense
+
+    double dense_threshold{0.1};
+    bool dropping{false};
+    double removed_weight{0.0};
+
+    size_t find_slot(size_t index) const;
+    void rehash(size_t capacity);
+
+public:
+    static const size_t EMPTY_KEY = static_cast<size_t>(-1);
+
+    // The state |00...0>
+    SparseStatevector(size_t qubit_n_ = 1);
+    // A standard basis state given as a string of binary digits (qubit 0 first), e.g. "0110"
+    SparseStatevector(size_t qubit_n_, const std::string &basis_state);
+    // The nonzero amplitudes of a dense statevector
+    SparseStatevector(const Statevector &s);
+
+    SparseStatevector(const SparseStatevector &s);
+    SparseStatevector &operator=(const SparseStatevector &s);
+    SparseStatevector(SparseStatevector &&s) = default;
+    SparseStatevector &operator=(SparseStatevector &&s) = default;
+
+    size_t qubit_num() const { return qubit_n; }
+    // Number of stored amplitudes (2^n once dense)
+    size_t nonzero_num() const;
+    double fill_ratio() const;
+    bool is_dense() const { return dense != nullptr; }
+    Statevector &dense_state() { return *dense; }
+
+    std::complex<double> get(size_t index) const;
+    // Add a to the amplitude of index (sparse mode only)
+    void add(size_t index, std::complex<double> a);
+    // The stored (index, amplitude) pairs, in no particular order (sparse mode only)
+    std::vector<std::pair<size_t, std::complex<double>>> entries() const;
+    // An empty state with the same number of qubits and settings, to build the result of a gate
+    SparseStatevector empty_copy() const;
+    // Multiply the stored amplitudes whose index has every bit of mask set, in place (sparse mode only)
+    void multiply_masked(size_t mask, std::complex<double> factor);
+
+    /*
+    Called by the kernels after each gate: removes the negligible amplitudes (all the ones below
+    ROUND_MINIMUM if dropping is enabled) and switches to the dense layout above the fill threshold.
+    */
+    void finish_gate();
+
+    void set_dense_threshold(double fill_ratio_);
+    double get_dense_threshold() const { return dense_threshold; }
+    void set_dropping(bool dropping_) { dropping = dropping_; }
+    bool get_dropping() const { return dropping; }
+    // Total probability of the amplitudes removed so far
+    double dropped_weight() const { return removed_weight; }
+
+    Statevector to_statevector() const;
+};
+
+void apply_single_qubit_gate(SparseStatevector &state, size_t qubit, const QuantumGate &core);
+void apply_diagonal_gate(SparseStatevector &state, size_t qubit, std::complex<double> d0, std::complex<double> d1);
+void apply_pauli_x(SparseStatevector &state, size_t qubit);
+void apply_cnot(SparseStatevector &state, size_t control_qubit, size_t target_qubit);
+void apply_swap(SparseStatevector &state, size_t qubit1, size_t qubit2);
+void apply_controlled_phase(SparseStatevector &state, size_t qubit1, size_t qubit2, std::complex<double> factor);
+void apply_multi_qubit_gate(SparseStatevector &state, const std::vector<size_t> &qubits, const QuantumGate &matrix);
+
+#endif // SPARSESTATEVECTOR_HPP
@@ -0,0 +1,61 @@
+#ifndef SPLITSTATEVECTOR_HPP
+#define SPLITSTATEVECTOR_HPP
+
+#include "Statevector.hpp"
+#include <cstdint>
+
+/*
+SplitStatevector stores the same amplitudes as Statevector, but in a structure-of-arrays layout:
+the real parts and the imaginary parts are kept in two separate buffers.
+
+    Statevector:       [ re0 im0 re1 im1 re2 im2 ... ]
+    SplitStatevector:  real [ re0 re1 re2 ... ]
+                       imag [ im0 im1 im2 ... ]
+
+With this layout a SIMD register holds 4 (AVX2) or 8 (AVX-512) consecutive real (or imaginary) parts,
+so the kernels in SimdKernels.hpp can process several amplitude pairs per instruction without shuffles.
+Both buffers start at a 64-byte boundary (one cache line, one AVX-512 register).
+
+The layout is optional: convert a Statevector with SplitStatevector(s), evolve it, and convert back
+with to_statevector().
+*/
+
+class SplitStatevector
+{
+private:
+    size_t qubit_n;
+    // The buffers are over-allocated by ALIGNMENT bytes, real_part and imag_part point to the aligned start.
+    std::unique_ptr<double[]> real_buffer;
+    std::unique_ptr<double[]> imag_buffer;
+    double *real_part;
+    double *imag_part;
+
+    void allocate();
+
+public:
+    static const size_t ALIGNMENT = 64;
+
+    SplitStatevector();
+    SplitStatevector(size_t qubit_n_);
+    SplitStatevector(const Statevector &s);
+
+    SplitStatevector(const SplitStatevector &s);            // copy constructor
+    SplitStatevector &operator=(const SplitStatevector &s); // copy assignment operator
+    SplitStatevector(SplitStatevector &&s);                 // move constructor
+    SplitStatevector &operator=(SplitStatevector &&s);      // move assignment operator
+
+    size_t qubit_num() const { return qubit_n; }
+    size_t size() const { return static_cast<size_t>(1) << qubit_n; }
+
+    double *real() { return real_part; }
+    double *imag() { return imag_part; }
+    const double *real() const { return real_part; }
+    const double *imag() const { return imag_part; }
+
+    std::complex<double> amplitude(size_t i) const;
+
+    // Convert back to the interleaved layout
+    Statevector to_statevector() const;
+};
+
+#endif // SPLITSTATEVECTOR_HPP
@@ -0,0 +1,99 @@
+#ifndef STABILIZERTABLEAU_HPP
+#define STABILIZERTABLEAU_HPP
+
+#include "Format.hpp"
+#include <cstdint>
+#include <map>
+#include <random>
+
+/*
+Stabilizer tableau simulator for Clifford circuits (Aaronson and Gottesman, "Improved simulation of
+stabilizer circuits", 2004).
+
+A stabilizer state of n qubits is described by n Pauli strings (the stabilizers) that leave the state
+unchanged, plus n destabilizers that complete them to a basis of the Pauli group. Each Pauli string
+is stored as a row of x and z bits and a sign:
+
+            x bits      z bits    sign
+    row 0   1 0 0 ...   0 0 0 ... +       destabilizers (rows 0 .. n-1)
+    ...
+    row n   0 0 0 ...   1 0 0 ... +       stabilizers   (rows n .. 2n-1)
+    ...
+    row 2n                                scratch row for deterministic measurements
+
+(x, z) = (1, 0) is X, (0, 1) is Z, (1, 1) is Y. The bits of a row are packed into 64-bit words, so
+multiplying two rows costs n/64 XORs and popcounts. The memory is O(n^2) bits and a gate costs O(n),
+so circuits with thousands of qubits are simulated in polynomial time, where the statevector would
+need 2^n amplitudes.
+
+Only Clifford gates can be applied: H, S (Phase of a multiple of 90 degrees), Pauli X, Y, Z, CNOT and
+Swap, which are exactly the gates of the console. Qubit 0 is the leftmost qubit, as in Statevector.
+
+Example of usage:
+>>StabilizerTableau tableau(1000);
+>>tableau.hadamard(0);
+>>for (size_t q = 1; q < 1000; q++) tableau.cnot(q - 1, q);
+>>std::mt19937_64 rng(1);
+>>std::map<std::string, size_t> counts = tableau.sample(100, rng);    // 000...0 and 111...1
+*/
+
+class StabilizerTableau
+{
+private:
+    size_t qubit_n;
+    size_t word_n; // 64-bit words per row
+    std::vector<uint64_t> x_bits;
+    std::vector<uint64_t> z_bits;
+    std::vector<uint8_t> signs; // 1 for a minus sign
+
+    uint64_t *x_row(size_t row) { return x_bits.data() + row * word_n; }
+    uint64_t *z_row(size_t row) { return z_bits.data() + row * word_n; }
+    const uint64_t *x_row(size_t row) const { return x_bits.data() + row * word_n; }
+    const uint64_t *z_row(size_t row) const { return z_bits.data() + row * word_n; }
+
+    bool get_x(size_t row, size_t q) const { return (x_row(row)[q / 64] >> (q % 64)) & 1; }
+    bool get_z(size_t row, size_t q) const { return (z_row(row)[q / 64] >> (q % 64)) & 1; }
+
+    void check_qubit(size_t q) const;
+
+    // Row h becomes the product of row i and row h, with the sign of the product
+    void rowsum(size_t h, size_t i);
+    void copy_row(size_t destination, size_t source);
+    void clear_row(size_t row);
+
+    // Measure qubit q in the Z basis. A random outcome takes the value random_outcome.
+    bool measure_qubit(size_t q, bool random_outcome);
+
+public:
+    // The state |00...0>
+    StabilizerTableau(size_t qubit_n_ = 1);
+    // A standard basis state, e.g. "0110" (qubit 0 first)
+    StabilizerTableau(size_t qubit_n_, const std::string &basis_state);
+
+    size_t qubit_num() const { return qubit_n; }
+
+    void hadamard(size_t q);
+    void phase_s(size_t q); // diag(1, i)
+    void pauli_x(size_t q);
+    void pauli_y(size_t q);
+    void pauli_z(size_t q);
+    void cnot(size_t control_qubit, size_t target_qubit);
+    void swap(size_t q1, size_t q2);
+
+    // Measure qubit q in the Z basis, the state collapses to the outcome
+    bool measure(size_t q, std::mt19937_64 &rng);
+
+    /*
+    Sample measurements of all qubits without changing the state. The outcomes of a stabilizer state are
+    uniformly distributed over x0 + span(x parts of the stabilizers), so x0 is found once by measuring a
+    copy, and each shot only XORs a random subset of the independent x parts into it.
+    Returns the number of times each outcome (qubit 0 first) occurred.
+    */
+    std::map<std::string, size_t> sample(size_t shots, std::mt19937_64 &rng) const;
+
+    // The stabilizers as signed Pauli strings, e.g. "+XX", "-ZZ"
+    std::vector<std::string> stabilizers() const;
+    void display_stabilizers() const;
+};
+
+#endif // STABILIZERTABLEAU_HPP
@@ -0,0 +1,135 @@
+#ifndef STATEEXPRESSION_HPP
+#define STATEEXPRESSION_HPP
+
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+
+/*
+Expression templates for the linear algebra of statevectors.
+
+a + b, a - b, c * a and a / c do not compute anything, they return a small node that refers to its
+operands. A compound expression is a tree of such nodes, and its amplitudes are only computed when it is
+assigned to a Statevector, all in one loop:
+
+    s = (a + b) / sqrt(2);
+
+        StateScale<Divide>                    for i in 0 .. 2^n - 1:
+          └─ StateSum<Add>          ==>           s[i] = (a[i] + b[i]) / sqrt(2)
+               ├─ a
+               └─ b
+
+so the expression makes no temporary statevector and a single pass over the amplitudes, and assigning it
+allocates at most once (not at all if s already has the right size).
+
+Statevectors are held by reference in the nodes and the nodes by value, so an expression must be assigned
+within the statement that builds it: auto e = f() + g(); keeps references to two destroyed temporaries.
+*/
+
+class Statevector;
+
+// Base class of every expression, E is the derived node (CRTP)
+template <typename E>
+struct StateExpression
+{
+    const E &self() const { return static_cast<const E &>(*this); }
+};
+
+// How a node stores an operand: statevectors by reference, other nodes by value
+template <typename E>
+struct StateOperand
+{
+    typedef const E type;
+};
+
+template <>
+struct StateOperand<Statevector>
+{
+    typedef const Statevector &type;
+};
+
+struct StateAdd
+{
+    static std::complex<double> apply(const std::complex<double> &x, const std::complex<double> &y) { return x + y; }
+};
+
+struct StateSubtract
+{
+    static std::complex<double> apply(const std::complex<double> &x, const std::complex<double> &y) { return x - y; }
+};
+
+struct StateMultiply
+{
+    static std::complex<double> apply(const std::complex<double> &x, const std::complex<double> &c) { return x * c; }
+};
+
+struct StateDivide
+{
+    static std::complex<double> apply(const std::complex<double> &x, const std::complex<double> &c) { return x / c; }
+};
+
+// Element-wise sum or difference of two expressions of the same size
+template <typename L, typename R, typename Op>
+class StateSum : public StateExpression<StateSum<L, R, Op>>
+{
+private:
+    typename StateOperand<L>::type left;
+    typename StateOperand<R>::type right;
+
+public:
+    StateSum(const L &left_, const R &right_) : left(left_), right(right_)
+    {
+        if (left.qubit_num() != right.qubit_num())
+            throw std::invalid_argument("Statevectors must have the same number of qubits!");
+    }
+
+    size_t qubit_num() const { return left.qubit_num(); }
+    std::complex<double> eval(size_t i) const { return Op::apply(left.eval(i), right.eval(i)); }
+};
+
+// An expression multiplied or divided by a scalar
+template <typename E, typename Op>
+class StateScale : public StateExpression<StateScale<E, Op>>
+{
+private:
+    typename StateOperand<E>::type expr;
+    std::complex<double> c;
+
+public:
+    StateScale(const E &expr_, const std::complex<double> &c_) : expr(expr_), c(c_) {}
+
+    size_t qubit_num() const { return expr.qubit_num(); }
+    std::complex<double> eval(size_t i) const { return Op::apply(expr.eval(i), c); }
+};
+
+template <typename L, typename R>
+StateSum<L, R, StateAdd> operator+(const StateExpression<L> &left, const StateExpression<R> &right)
+{
+    return StateSum<L, R, StateAdd>(left.self(), right.self());
+}
+
+template <typename L, typename R>
+StateSum<L, R, StateSubtract> operator-(const StateExpression<L> &left, const StateExpression<R> &right)
+{
+    return StateSum<L, R, StateSubtract>(left.self(), right.self());
+}
+
+template <typename E>
+StateScale<E, StateMultiply> operator*(const std::complex<double> &c, const StateExpression<E> &expr)
+{
+    return StateScale<E, StateMultiply>(expr.self(), c);
+}
+
+template <typename E>
+StateScale<E, StateMultiply> operator*(const StateExpression<E> &expr, const std::complex<double> &c)
+{
+    return StateScale<E, StateMultiply>(expr.self(), c);
+}
+
+template <typename E>
+StateScale<E, StateDivide> operator/(const StateExpression<E> &expr, const std::complex<double> &c)
+{
+    return StateScale<E, StateDivide>(expr.self(), c);
+}
+
+#endif // STATEEXPRESSION_HPP
@@ -2,6 +2,7 @@
 #define Statevector_HPP
 
 #include "Format.hpp"
+#include "StateExpression.hpp"
 #include <map>
 #include <memory>
 #include <random>
@@ -26,9 +27,14 @@
  * The file also includes a function to generate a standard basis for a given number of qubits, 
  * a function to generate a specific state for a given number of qubits, and a function to display 
  * the standard basis for a given number of qubits.
+ *
+ * The operators +, - (two statevectors), * and / (a statevector and a scalar) build expression templates
+ * (StateExpression.hpp) that are computed in one loop when assigned, e.g.
+ *     s = (a + b) / sqrt(2);      one pass, no temporary statevector
+ *     s += 0.5 * (a - b);         in place
  */
 
-class Statevector
+class Statevector : public StateExpression<Statevector>
 {
 private:
     size_t qubit_n;
@@ -45,14 +51,33 @@ public:
     Statevector(Statevector &&s);                 // move constructor
     Statevector &operator=(Statevector &&s);      // move assignment operator
 
-    Statevector operator+(const Statevector &s);
-    Statevector operator-(const Statevector &s);
-    Statevector operator/(const std::complex<double> &c);
+    // Evaluate an expression of statevectors, rounded like a copy, with one allocation
+    template <typename E>
+    Statevector(const StateExpression<E> &e);
+    // The buffer is reused if the size matches. The expression may contain *this.
+    template <typename E>
+    Statevector &operator=(const StateExpression<E> &e);
+
+    // In place, without rounding (like the gate kernels)
+    template <typename E>
+    Statevector &operator+=(const StateExpression<E> &e);
+    template <typename E>
+    Statevector &operator-=(const StateExpression<E> &e);
+    Statevector &operator*=(const std::complex<double> &c);
+    Statevector &operator/=(const std::complex<double> &c);
+
     std::complex<double> &operator[](size_t i);
     const std::complex<double> &operator[](size_t i) const;
 
     size_t qubit_num() const { return qubit_n; }
-    size_t size() { return pow(2, qubit_n); }
+    size_t size() const { return static_cast<size_t>(1) << qubit_n; }
+
+    // Raw access to the amplitudes for the gate kernels, which would otherwise pay for the
+    // bounds check of operator[] on every element.
+    std::complex<double> *data() { return array.get(); }
+    const std::complex<double> *data() const { return array.get(); }
+    // Unchecked amplitude, the leaf of an expression
+    std::complex<double> eval(size_t i) const { return array[i]; }
 
     size_t get_max_width() const;
     void display_row();
@@ -61,6 +86,62 @@ public:
     void round();
 };
 
+// Amplitude parts smaller than 1e-10 are set to 0, as by Statevector::round()
+inline std::complex<double> round_amplitude(const std::complex<double> &a)
+{
+    return std::complex<double>(std::abs(a.real()) < 1e-10 ? 0.0 : a.real(), std::abs(a.imag()) < 1e-10 ? 0.0 : a.imag());
+}
+
+template <typename E>
+Statevector::Statevector(const StateExpression<E> &e) :
+qubit_n(e.self().qubit_num())
+{
+    const E &expr = e.self();
+    array = std::make_unique<std::complex<double>[]>(size());
+    for (size_t i = 0; i < size(); i++)
+        array[i] = round_amplitude(expr.eval(i));
+}
+
+template <typename E>
+Statevector &Statevector::operator=(const StateExpression<E> &e)
+{
+    const E &expr = e.self();
+    if (expr.qubit_num() != qubit_n)
+    {
+        // The expression cannot refer to this statevector, it has another size
+        Statevector result(e);
+        qubit_n = result.qubit_n;
+        array = std::move(result.array);
+        return *this;
+    }
+    // Amplitude i only depends on amplitude i of the operands, so writing in place is safe
+    for (size_t i = 0; i < size(); i++)
+        array[i] = round_amplitude(expr.eval(i));
+    return *this;
+}
+
+template <typename E>
+Statevector &Statevector::operator+=(const StateExpression<E> &e)
+{
+    const E &expr = e.self();
+    if (expr.qubit_num() != qubit_n)
+        throw std::invalid_argument("Statevectors must have the same number of qubits!");
+    for (size_t i = 0; i < size(); i++)
+        array[i] += expr.eval(i);
+    return *this;
+}
+
+template <typename E>
+Statevector &Statevector::operator-=(const StateExpression<E> &e)
+{
+    const E &expr = e.self();
+    if (expr.qubit_num() != qubit_n)
+        throw std::invalid_argument("Statevectors must have the same number of qubits!");
+    for (size_t i = 0; i < size(); i++)
+        array[i] -= expr.eval(i);
+    return *this;
+}
+
 // Generate a map of standard basis states for a given number of qubits
 std::map<std::string, Statevector> generate_std_basis(size_t qubit_n);
 
@@ -0,0 +1,94 @@
+#ifndef TENSORNETWORK_HPP
+#define TENSORNETWORK_HPP
+
+#include "Statevector.hpp"
+#include "QuantumGate.hpp"
+
+/*
+Tensor network simulator for single amplitudes <x|C|psi>.
+
+Every gate is a tensor with one index per input and per output wire, the input basis state is a vector
+per qubit and the queried bitstring <x| closes the output wires with one more vector per qubit. The
+amplitude is the contraction of the whole network, i.e. the sum over all the wire values:
+
+    |0>──[H]──•──<x0|          tensors:  |0> |0> H CNOT <x0| <x1|
+              │                indices:  wires between the tensors, dimension 2 each
+    |0>───────⊕──<x1|
+
+The network is contracted pairwise. The cost of a contraction depends on the order a lot (the size of
+an intermediate tensor is 2^(number of open wires)), so the order is planned first:
+1. a greedy pass contracts the pair that shrinks the total size the most (or grows it the least),
+2. simulated annealing then permutes the order in which the wires are summed, starting from the greedy
+   order, and keeps the order with the fewest floating point operations.
+The plan does not depend on x, so it is made once for a batch of amplitudes. The intermediate tensors
+that do not depend on x are contracted once per batch as well. Large pairwise contractions are split
+over the threads of the gate kernels (see ThreadPool.hpp).
+
+Memory is the size of the largest intermediate tensors instead of 2^n: circuits of low depth or with
+local gates give amplitudes of many more qubits than a statevector.
+
+Example of usage:
+>>TensorNetwork network(3, "000");
+>>network.add_gate({0}, QuantumGate::Hadamard2x2);
+>>network.add_gate({0, 1}, QuantumGate::CNOT4x4);
+>>network.plan_contraction().display();
+>>network.amplitude("110");       // 0.707
+*/
+
+// Predicted cost of a contraction path
+struct ContractionCost
+{
+    double flops{0.0};          // real floating point operations (8 per complex multiply-add)
+    double largest_tensor{0.0}; // elements of the largest intermediate tensor
+    double peak_memory{0.0};    // bytes of the tensors alive at the same time, at most
+
+    void display() const;
+};
+
+class TensorNetwork
+{
+private:
+    struct Tensor
+    {
+        std::vector<size_t> indices;            // the first index is the most significant bit of the data
+        std::vector<std::complex<double>> data; // 2^(number of indices) elements
+    };
+
+    size_t qubit_n;
+    size_t index_n{0};
+    std::vector<Tensor> tensors; // the input vectors and the gates
+    std::vector<size_t> wires;   // the current index of each qubit, closed by the output vectors
+
+    /*
+    The planned contraction tree: the tensors, then the n output vectors, are numbered from 0, and the
+    k-th pair of the path contracts two of them into the tensor numbered tensors + n + k.
+    */
+    std::vector<std::pair<size_t, size_t>> path;
+    ContractionCost cost;
+    bool planned{false};
+
+    // Sum over the indices shared by a and b, the result keeps the other indices of a, then the ones of b
+    static Tensor contract(const Tensor &a, const Tensor &b);
+    Tensor output_vector(size_t q, char bit) const;
+
+public:
+    // The input state is the basis state given as a string of binary digits (qubit 0 first), e.g. "0110"
+    TensorNetwork(size_t qubit_n_, const std::string &basis_state);
+    TensorNetwork(size_t qubit_n_ = 1);
+
+    size_t qubit_num() const { return qubit_n; }
+    size_t tensor_num() const { return tensors.size(); }
+
+    // Append a 2^k x 2^k gate on the k target qubits (the first target is the most significant bit of the rows)
+    void add_gate(const std::vector<size_t> &qubits, const QuantumGate &gate);
+
+    // Plan the contraction order, annealing_steps = 0 keeps the greedy order
+    const ContractionCost &plan_contraction(size_t annealing_steps = 2000, unsigned seed = 1);
+    const ContractionCost &contraction_cost() const { return cost; }
+
+    // The amplitude <x|C|psi> of a bitstring (qubit 0 first), planned with the default settings if needed
+    std::complex<double> amplitude(const std::string &bitstring);
+    std::vector<std::complex<double>> amplitudes(const std::vector<std::string> &bitstrings);
+};
+
+#endif // TENSORNETWORK_HPP
@@ -0,0 +1,74 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+
+/*
+A fixed size pool of worker threads used by the gate kernels.
+
+parallel_for() splits an index range into one contiguous chunk per thread and blocks until all chunks
+are done. The chunks are a pure function of the range, the alignment and the number of threads, and
+every index is processed by exactly one thread with the same arithmetic as in a serial loop, so the
+results of the kernels are bit-identical to a serial run.
+If a chunk throws, the other chunks still run to their end and parallel_for() rethrows the first
+exception on the calling thread.
+
+Example of usage:
+>>ThreadPool pool(4);
+>>pool.parallel_for(0, n, 1, [&](size_t begin, size_t end) { for (size_t i = begin; i < end; i++) a[i] *= 2; });
+*/
+
+class ThreadPool
+{
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable task_available;
+    std::condition_variable task_finished;
+    size_t unfinished_tasks{0};
+    bool stopping{false};
+
+    void worker_loop();
+
+public:
+    // thread_n is the total number of threads including the caller, so thread_n - 1 workers are started.
+    ThreadPool(size_t thread_n);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t size() const { return workers.size() + 1; }
+
+    // Chunk boundaries are multiples of alignment (apart from end), e.g. the SIMD width.
+    void parallel_for(size_t begin, size_t end, size_t alignment, const std::function<void(size_t, size_t)> &body);
+};
+
+/*
+Global settings of the gate kernels.
+thread_count is the number of threads used by the kernels (default: all hardware threads).
+parallel_grain is the minimum number of loop iterations (amplitudes or amplitude pairs) for a kernel to
+run in parallel. Smaller states stay serial, where the synchronisation would cost more than it saves.
+*/
+void set_thread_count(size_t thread_n);
+size_t get_thread_count();
+void set_parallel_grain(size_t grain);
+size_t get_parallel_grain();
+
+/*
+Run body over [begin, end) on the global pool, or serially if the range is smaller than the grain size.
+The grain defaults to get_parallel_grain(); loops over a few large jobs (e.g. the path sums of the
+Feynman simulators) pass grain = 1 so that every job can get its own thread.
+Calls made from a chunk of another parallel_for() run serially, so jobs that are already parallel never
+wait for the global pool.
+*/
+void parallel_for(size_t begin, size_t end, const std::function<void(size_t, size_t)> &body, size_t alignment = 1,
+                  size_t grain = get_parallel_grain());
+
+#endif // THREADPOOL_HPP
@@ -1,26 +1,70 @@
 mkdir -p obj
 
-g++ -std=c++14 -c -o obj/main.o main.cpp
-g++ -std=c++14 -c -o obj/Format.o src/Format.cpp
-g++ -std=c++14 -c -o obj/Console.o src/Console.cpp
-g++ -std=c++14 -c -o obj/QuantumCircuit.o src/QuantumCircuit.cpp
-g++ -std=c++14 -c -o obj/QuantumGate.o src/QuantumGate.cpp
-g++ -std=c++14 -c -o obj/Statevector.o src/Statevector.cpp
-g++ -std=c++14 -c -o obj/CNOT.o src/QuantumGates/CNOT.cpp
-g++ -std=c++14 -c -o obj/Hadamard.o src/QuantumGates/Hadamard.cpp
-g++ -std=c++14 -c -o obj/Pauli.o src/QuantumGates/Pauli.cpp
-g++ -std=c++14 -c -o obj/Phase.o src/QuantumGates/Phase.cpp
-g++ -std=c++14 -c -o obj/Swap.o src/QuantumGates/Swap.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/main.o main.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/Format.o src/Format.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/Console.o src/Console.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/QuantumCircuit.o src/QuantumCircuit.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/GateOp.o src/GateOp.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/GateFusion.o src/GateFusion.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/GateOptimization.o src/GateOptimization.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/QuantumGate.o src/QuantumGate.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/MatrixKernels.o src/MatrixKernels.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/SparseMatrix.o src/SparseMatrix.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/KroneckerOperator.o src/KroneckerOperator.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/Statevector.o src/Statevector.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/ThreadPool.o src/ThreadPool.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/GateKernels.o src/GateKernels.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/FixedGate.o src/FixedGate.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/SplitStatevector.o src/SplitStatevector.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/SimdKernels.o src/SimdKernels.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/CacheBlocking.o src/CacheBlocking.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/StabilizerTableau.o src/StabilizerTableau.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/MatrixProductState.o src/MatrixProductState.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/SparseStatevector.o src/SparseStatevector.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/DecisionDiagram.o src/DecisionDiagram.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/TensorNetwork.o src/TensorNetwork.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/FeynmanPathSum.o src/FeynmanPathSum.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/HybridSchrodingerFeynman.o src/HybridSchrodingerFeynman.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/FactorizedState.o src/FactorizedState.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/ReversibleCircuit.o src/ReversibleCircuit.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/CNOT.o src/QuantumGates/CNOT.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/Hadamard.o src/QuantumGates/Hadamard.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/Pauli.o src/QuantumGates/Pauli.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/Phase.o src/QuantumGates/Phase.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/ControlledPhase.o src/QuantumGates/ControlledPhase.cpp
+g++ -std=c++14 -O2 -pthread -c -o obj/Swap.o src/QuantumGates/Swap.cpp
 
-g++ -o bin/main \
+g++ -pthread -o bin/main \
 obj/main.o \
 obj/Format.o \
 obj/Console.o \
 obj/QuantumCircuit.o \
+obj/GateOp.o \
+obj/GateFusion.o \
+obj/GateOptimization.o \
 obj/QuantumGate.o \
+obj/MatrixKernels.o \
+obj/SparseMatrix.o \
+obj/KroneckerOperator.o \
 obj/Statevector.o \
+obj/ThreadPool.o \
+obj/GateKernels.o \
+obj/FixedGate.o \
+obj/SplitStatevector.o \
+obj/SimdKernels.o \
+obj/CacheBlocking.o \
+obj/StabilizerTableau.o \
+obj/MatrixProductState.o \
+obj/SparseStatevector.o \
+obj/DecisionDiagram.o \
+obj/TensorNetwork.o \
+obj/FeynmanPathSum.o \
+obj/HybridSchrodingerFeynman.o \
+obj/FactorizedState.o \
+obj/ReversibleCircuit.o \
 obj/CNOT.o \
 obj/Hadamard.o \
 obj/Pauli.o \
 obj/Phase.o \
+obj/ControlledPhase.o \
 obj/Swap.o
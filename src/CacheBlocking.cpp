@@ -0,0 +1,596 @@
+#include "../include/CacheBlocking.hpp"
+#include <algorithm>
+#include <functional>
+
+static size_t cache_block_qubits = 14;
+
+// Number of following gates inspected to decide whether a qubit is worth moving into the low bits
+static const size_t LOOKAHEAD_GATES = 64;
+
+void set_cache_block_qubits(size_t block_qubits)
+{
+    cache_block_qubits = std::max<size_t>(block_qubits, 2);
+}
+
+size_t get_cache_block_qubits()
+{
+    return cache_block_qubits;
+}
+
+void BlockingStats::display() const
+{
+    std::cout << "Cache blocking: " << gates << " gates in " << passes << " passes over the statevector ("
+              << qubit_swaps << " qubit swaps)" << std::endl;
+}
+
+/*
+A gate of a group, with physical bit positions (bit 0 is the lowest bit of the amplitude index).
+    General   2x2 matrix m on bits[0]
+    Diagonal  consecutive diagonal gates, diag(factors[2l], factors[2l+1]) on bits[l]
+    PauliX    X on bits[0]
+    CNOT      control bits[0], target bits[1]
+    CPhase    multiply the amplitudes with bits[0] and bits[1] both 1 by m[0]
+    Swap      exchange bits[0] and bits[1]
+    Dense     2^k x 2^k matrix on bits (rows ordered like the gate's targets)
+*/
+struct BlockedOp
+{
+    enum class Kind
+    {
+        General,
+        Diagonal,
+        PauliX,
+        CNOT,
+        CPhase,
+        Swap,
+        Dense
+    };
+
+    Kind kind;
+    std::vector<size_t> bits;
+    std::complex<double> m[4];
+    std::vector<std::complex<double>> dense;
+    std::vector<std::complex<double>> factors;
+    // Diagonal: product of the factors on low bits for each index of a chunk (empty if there is none)
+    std::vector<std::complex<double>> table;
+
+    BlockedOp(Kind kind_, const std::vector<size_t> &bits_) : kind(kind_), bits(bits_) {}
+
+    // Copy the 2x2 core of a General op into m
+    void set_core(const QuantumGate &core)
+    {
+        m[0] = core(1, 1);
+        m[1] = core(1, 2);
+        m[2] = core(2, 1);
+        m[3] = core(2, 2);
+    }
+};
+
+static BlockedOp::Kind op_kind(const GateOp &op, const std::vector<QuantumGate> &matrices)
+{
+    std::complex<double> d0, d1;
+    if (op.code == GateCode::CNOT)
+        return BlockedOp::Kind::CNOT;
+    if (op.code == GateCode::ControlledPhase)
+        return BlockedOp::Kind::CPhase;
+    if (op.code == GateCode::Swap)
+        return BlockedOp::Kind::Swap;
+    if (op.code == GateCode::PauliX)
+        return BlockedOp::Kind::PauliX;
+    if (diagonal_factors(op, matrices, d0, d1))
+        return BlockedOp::Kind::Diagonal;
+    if (op.qubit_count == 1)
+        return BlockedOp::Kind::General;
+    return BlockedOp::Kind::Dense;
+}
+
+// The 2x2 matrix of a General op (H, Y or a fused single qubit gate), without building a new matrix
+static const QuantumGate &general_core(const GateOp &op, const std::vector<QuantumGate> &matrices)
+{
+    if (op.code == GateCode::Hadamard)
+        return QuantumGate::Hadamard2x2;
+    if (op.code == GateCode::PauliY)
+        return QuantumGate::PauliY;
+    return matrices[op.matrix];
+}
+
+// The qubits of a gate that have to sit on low bits for the gate to be applied chunk by chunk, stored inline
+struct LowQubits
+{
+    size_t qubits[GateOp::MAX_QUBITS];
+    size_t count{0};
+
+    const size_t *begin() const { return qubits; }
+    const size_t *end() const { return qubits + count; }
+    bool contains(size_t q) const { return std::find(begin(), end(), q) != end(); }
+};
+
+static LowQubits required_low_qubits(const GateOp &op, const std::vector<QuantumGate> &matrices)
+{
+    LowQubits required;
+    switch (op_kind(op, matrices))
+    {
+    case BlockedOp::Kind::Diagonal:
+    case BlockedOp::Kind::CPhase:
+    case BlockedOp::Kind::Swap:
+        break;
+    case BlockedOp::Kind::CNOT:
+        required.qubits[required.count++] = op.qubits[1];
+        break;
+    default:
+        for (size_t j = 0; j < op.qubit_count; j++)
+            required.qubits[required.count++] = op.qubits[j];
+        break;
+    }
+    return required;
+}
+
+// Apply one op to the chunk of 2^block_bits amplitudes starting at global index chunk_base (serial).
+static void apply_op_to_chunk(std::complex<double> *amp, size_t chunk_base, size_t block_bits, const BlockedOp &op)
+{
+    const size_t chunk = static_cast<size_t>(1) << block_bits;
+
+    switch (op.kind)
+    {
+    case BlockedOp::Kind::General:
+    {
+        const size_t bit = op.bits[0];
+        const size_t stride = static_cast<size_t>(1) << bit;
+        for (size_t k = 0; k < chunk / 2; k++)
+        {
+            const size_t i = insert_zero_bit(k, bit);
+            const std::complex<double> a0 = amp[i];
+            const std::complex<double> a1 = amp[i + stride];
+            amp[i] = op.m[0] * a0 + op.m[1] * a1;
+            amp[i + stride] = op.m[2] * a0 + op.m[3] * a1;
+        }
+        break;
+    }
+    case BlockedOp::Kind::Diagonal:
+    {
+        // The factors on high bits are constant within the chunk
+        std::complex<double> high_factor{1.0, 0.0};
+        for (size_t l = 0; l < op.bits.size(); l++)
+        {
+            if (op.bits[l] >= block_bits)
+                high_factor *= ((chunk_base >> op.bits[l]) & 1) ? op.factors[2 * l + 1] : op.factors[2 * l];
+        }
+
+        if (!op.table.empty())
+        {
+            if (high_factor == std::complex<double>(1, 0))
+            {
+                for (size_t i = 0; i < chunk; i++)
+                    amp[i] *= op.table[i];
+            }
+            else
+            {
+                for (size_t i = 0; i < chunk; i++)
+                    amp[i] *= high_factor * op.table[i];
+            }
+        }
+        else if (high_factor != std::complex<double>(1, 0))
+        {
+            for (size_t i = 0; i < chunk; i++)
+                amp[i] *= high_factor;
+        }
+        break;
+    }
+    case BlockedOp::Kind::PauliX:
+    {
+        const size_t bit = op.bits[0];
+        const size_t stride = static_cast<size_t>(1) << bit;
+        for (size_t k = 0; k < chunk / 2; k++)
+        {
+            const size_t i = insert_zero_bit(k, bit);
+            std::swap(amp[i], amp[i + stride]);
+        }
+        break;
+    }
+    case BlockedOp::Kind::CNOT:
+    {
+        const size_t control_bit = op.bits[0];
+        const size_t target_bit = op.bits[1];
+        const size_t target_mask = static_cast<size_t>(1) << target_bit;
+
+        if (control_bit >= block_bits)
+        {
+            // The control bit is fixed within the chunk: either an X on the target or nothing
+            if (chunk_base & (static_cast<size_t>(1) << control_bit))
+            {
+                for (size_t k = 0; k < chunk / 2; k++)
+                {
+                    const size_t i = insert_zero_bit(k, target_bit);
+                    std::swap(amp[i], amp[i + target_mask]);
+                }
+            }
+        }
+        else
+        {
+            const size_t control_mask = static_cast<size_t>(1) << control_bit;
+            const size_t low_bit = std::min(control_bit, target_bit);
+            const size_t high_bit = std::max(control_bit, target_bit);
+            for (size_t k = 0; k < chunk / 4; k++)
+            {
+                const size_t i = insert_zero_bit(insert_zero_bit(k, low_bit), high_bit) | control_mask;
+                std::swap(amp[i], amp[i | target_mask]);
+            }
+        }
+        break;
+    }
+    case BlockedOp::Kind::CPhase:
+    {
+        // Only the amplitudes with both bits 1 change; a high bit is fixed within the chunk
+        const size_t low_bit = std::min(op.bits[0], op.bits[1]);
+        const size_t high_bit = std::max(op.bits[0], op.bits[1]);
+        if (high_bit >= block_bits && !((chunk_base >> high_bit) & 1))
+            break;
+
+        if (low_bit >= block_bits)
+        {
+            if ((chunk_base >> low_bit) & 1)
+            {
+                for (size_t i = 0; i < chunk; i++)
+                    amp[i] *= op.m[0];
+            }
+        }
+        else if (high_bit >= block_bits)
+        {
+            const size_t low_mask = static_cast<size_t>(1) << low_bit;
+            for (size_t k = 0; k < chunk / 2; k++)
+                amp[insert_zero_bit(k, low_bit) | low_mask] *= op.m[0];
+        }
+        else
+        {
+            const size_t both_mask = (static_cast<size_t>(1) << low_bit) | (static_cast<size_t>(1) << high_bit);
+            for (size_t k = 0; k < chunk / 4; k++)
+                amp[insert_zero_bit(insert_zero_bit(k, low_bit), high_bit) | both_mask] *= op.m[0];
+        }
+        break;
+    }
+    case BlockedOp::Kind::Swap:
+    {
+        const size_t mask1 = static_cast<size_t>(1) << op.bits[0];
+        const size_t mask2 = static_cast<size_t>(1) << op.bits[1];
+        const size_t low_bit = std::min(op.bits[0], op.bits[1]);
+        const size_t high_bit = std::max(op.bits[0], op.bits[1]);
+        for (size_t k = 0; k < chunk / 4; k++)
+        {
+            const size_t i = insert_zero_bit(insert_zero_bit(k, low_bit), high_bit);
+            std::swap(amp[i | mask1], amp[i | mask2]);
+        }
+        break;
+    }
+    case BlockedOp::Kind::Dense:
+    {
+        const size_t k = op.bits.size();
+        const size_t block = static_cast<size_t>(1) << k;
+
+        std::vector<size_t> sorted_bits = op.bits;
+        std::sort(sorted_bits.begin(), sorted_bits.end());
+        std::vector<size_t> offsets(block, 0);
+        for (size_t j = 0; j < block; j++)
+        {
+            for (size_t l = 0; l < k; l++)
+            {
+                if (j & (static_cast<size_t>(1) << (k - 1 - l)))
+                    offsets[j] |= static_cast<size_t>(1) << op.bits[l];
+            }
+        }
+
+        std::vector<std::complex<double>> in(block);
+        for (size_t g = 0; g < (chunk >> k); g++)
+        {
+            size_t base = g;
+            for (size_t l = 0; l < k; l++)
+                base = insert_zero_bit(base, sorted_bits[l]);
+
+            for (size_t j = 0; j < block; j++)
+                in[j] = amp[base + offsets[j]];
+
+            for (size_t r = 0; r < block; r++)
+            {
+                std::complex<double> sum{0.0, 0.0};
+                for (size_t c = 0; c < block; c++)
+                    sum += op.dense[r * block + c] * in[c];
+                amp[base + offsets[r]] = sum;
+            }
+        }
+        break;
+    }
+    }
+}
+
+void apply_gates_cache_blocked(Statevector &state, const GateOp *first, const GateOp *last,
+                               const std::vector<QuantumGate> &matrices, BlockingStats *stats)
+{
+    const size_t qubit_n = state.qubit_num();
+    const size_t block_bits = std::min(cache_block_qubits, qubit_n);
+    const size_t gate_n = last - first;
+    std::complex<double> *amp = state.data();
+
+    BlockingStats local_stats;
+    local_stats.gates = gate_n;
+
+    // pos[q] is the bit currently holding qubit q, qubit_at[p] the qubit currently on bit p
+    std::vector<size_t> pos(qubit_n), qubit_at(qubit_n);
+    for (size_t q = 0; q < qubit_n; q++)
+    {
+        pos[q] = qubit_n - 1 - q;
+        qubit_at[qubit_n - 1 - q] = q;
+    }
+
+    std::vector<BlockedOp> group;
+
+    auto flush_group = [&]()
+    {
+        if (group.empty())
+            return;
+        const size_t chunk = static_cast<size_t>(1) << block_bits;
+
+        for (auto op = group.begin(); op != group.end(); op++)
+        {
+            if (op->kind != BlockedOp::Kind::Diagonal)
+                continue;
+            for (size_t l = 0; l < op->bits.size(); l++)
+            {
+                if (op->bits[l] >= block_bits)
+                    continue;
+                if (op->table.empty())
+                    op->table.assign(chunk, std::complex<double>(1.0, 0.0));
+                for (size_t i = 0; i < chunk; i++)
+                    op->table[i] *= ((i >> op->bits[l]) & 1) ? op->factors[2 * l + 1] : op->factors[2 * l];
+            }
+        }
+
+        parallel_for(0, state.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t chunk_base = begin; chunk_base < end; chunk_base += chunk)
+            {
+                for (auto op = group.begin(); op != group.end(); op++)
+                    apply_op_to_chunk(amp + chunk_base, chunk_base, block_bits, *op);
+            }
+        }, chunk);
+        group.clear();
+        local_stats.passes++;
+    };
+
+    // Exchange the contents of disjoint pairs of bits: in the group if all bits are low, else with global passes
+    auto swap_bits = [&](const std::vector<std::pair<size_t, size_t>> &pairs)
+    {
+        if (pairs.empty())
+            return;
+
+        bool all_low = true;
+        for (auto it = pairs.begin(); it != pairs.end(); it++)
+        {
+            if (it->first >= block_bits || it->second >= block_bits)
+                all_low = false;
+        }
+
+        if (all_low)
+        {
+            for (auto it = pairs.begin(); it != pairs.end(); it++)
+                group.push_back(BlockedOp(BlockedOp::Kind::Swap, {it->first, it->second}));
+        }
+        else
+        {
+            /*
+            Exchanging several pairs at once moves every amplitude to a far away page, which is much
+            slower than one streaming Swap pass per pair.
+            */
+            flush_group();
+            for (auto it = pairs.begin(); it != pairs.end(); it++)
+            {
+                apply_swap(state, qubit_n - 1 - it->first, qubit_n - 1 - it->second);
+                local_stats.passes++;
+            }
+        }
+
+        for (auto it = pairs.begin(); it != pairs.end(); it++)
+        {
+            size_t q1 = qubit_at[it->first], q2 = qubit_at[it->second];
+            std::swap(pos[q1], pos[q2]);
+            qubit_at[it->first] = q2;
+            qubit_at[it->second] = q1;
+            local_stats.qubit_swaps++;
+        }
+    };
+
+    // Index of the next gate after `from` that needs qubit q on a low bit (gate_n if none in the window)
+    auto next_use = [&](size_t from, size_t q)
+    {
+        size_t window_end = std::min(gate_n, from + 1 + LOOKAHEAD_GATES);
+        for (size_t j = from + 1; j < window_end; j++)
+        {
+            if (required_low_qubits(first[j], matrices).contains(q))
+                return j;
+        }
+        return gate_n;
+    };
+
+    // End of the last run of Hadamard gates that was split into single gates
+    size_t split_layer_end = 0;
+
+    for (size_t g = 0; g < gate_n; g++)
+    {
+        const GateOp &gate = first[g];
+        const std::vector<size_t> qubit_eff = gate_qubits(gate);
+        const BlockedOp::Kind kind = op_kind(gate, matrices);
+
+        if (gate.code == GateCode::Hadamard && g >= split_layer_end)
+        {
+            // A run of Hadamard gates is a layer, its targets on high bits are transformed together
+            size_t run_end = g;
+            std::vector<size_t> high_targets;
+            for (; run_end < gate_n && first[run_end].code == GateCode::Hadamard; run_end++)
+            {
+                if (pos[first[run_end].qubits[0]] >= block_bits)
+                    high_targets.push_back(qubit_n - 1 - pos[first[run_end].qubits[0]]);
+            }
+
+            if (high_targets.size() > 1)
+            {
+                // Several high bits at once with the Walsh-Hadamard kernel, the low targets join the group
+                flush_group();
+                local_stats.passes += apply_hadamard_layer(state, high_targets);
+                for (size_t j = g; j < run_end; j++)
+                {
+                    const size_t q = first[j].qubits[0];
+                    if (pos[q] < block_bits)
+                    {
+                        group.push_back(BlockedOp(BlockedOp::Kind::General, {pos[q]}));
+                        group.back().set_core(QuantumGate::Hadamard2x2);
+                    }
+                }
+                g = run_end - 1;
+                continue;
+            }
+            // At most one high target, the gates of the layer are scheduled one by one as usual
+            split_layer_end = run_end;
+        }
+
+        if (kind == BlockedOp::Kind::Swap)
+        {
+            // Only the mapping changes, no amplitude moves
+            size_t bit1 = pos[qubit_eff[0]], bit2 = pos[qubit_eff[1]];
+            std::swap(pos[qubit_eff[0]], pos[qubit_eff[1]]);
+            qubit_at[bit1] = qubit_eff[1];
+            qubit_at[bit2] = qubit_eff[0];
+            continue;
+        }
+
+        const LowQubits required = required_low_qubits(gate, matrices);
+        std::vector<size_t> high_qubits;
+        for (auto q = required.begin(); q != required.end(); q++)
+        {
+            if (pos[*q] >= block_bits)
+                high_qubits.push_back(*q);
+        }
+
+        if (!high_qubits.empty())
+        {
+            /*
+            A swap costs a pass over the state, like applying the gate directly, so a qubit is only moved
+            into the low bits when at least one more gate of the window needs it there.
+            */
+            bool worth_moving = required.count <= block_bits;
+            for (auto q = high_qubits.begin(); q != high_qubits.end(); q++)
+            {
+                if (next_use(g, *q) == gate_n)
+                    worth_moving = false;
+            }
+
+            /*
+            The other high qubits used at least twice in the window are moved in the same time, in order of
+            first use, so the group is not flushed again for each of them. They are swapped with the low
+            qubits whose next use is the furthest away, as long as the incoming qubit is needed first.
+            */
+            std::vector<size_t> incoming = high_qubits;
+            std::vector<size_t> incoming_use(high_qubits.size(), g);
+            size_t window_end = std::min(gate_n, g + 1 + LOOKAHEAD_GATES);
+            for (size_t j = g + 1; j < window_end && worth_moving; j++)
+            {
+                const LowQubits later = required_low_qubits(first[j], matrices);
+                for (auto q = later.begin(); q != later.end(); q++)
+                {
+                    if (pos[*q] >= block_bits && next_use(j, *q) < gate_n &&
+                        std::find(incoming.begin(), incoming.end(), *q) == incoming.end())
+                    {
+                        incoming.push_back(*q);
+                        incoming_use.push_back(j);
+                    }
+                }
+            }
+
+            if (!worth_moving)
+            {
+                // Apply the gate directly to the whole state, with the targets translated to the current bits
+                flush_group();
+                GateOp translated = gate;
+                for (size_t j = 0; j < gate.qubit_count; j++)
+                    translated.qubits[j] = static_cast<uint32_t>(qubit_n - 1 - pos[gate.qubits[j]]);
+                apply_gate(state, translated, matrices);
+                local_stats.passes++;
+                continue;
+            }
+
+            // (next use, bit) of the low qubits that this gate does not need, furthest use first
+            std::vector<std::pair<size_t, size_t>> outgoing;
+            for (size_t bit = 0; bit < block_bits; bit++)
+            {
+                if (!required.contains(qubit_at[bit]))
+                    outgoing.push_back({next_use(g, qubit_at[bit]), bit});
+            }
+            std::sort(outgoing.begin(), outgoing.end(), std::greater<std::pair<size_t, size_t>>());
+
+            std::vector<std::pair<size_t, size_t>> pairs;
+            for (size_t i = 0; i < incoming.size() && i < outgoing.size(); i++)
+            {
+                if (i >= high_qubits.size() && outgoing[i].first <= incoming_use[i])
+                    break;
+                pairs.push_back({pos[incoming[i]], outgoing[i].second});
+            }
+            swap_bits(pairs);
+        }
+
+        BlockedOp op(kind, {});
+        for (auto q = qubit_eff.begin(); q != qubit_eff.end(); q++)
+            op.bits.push_back(pos[*q]);
+
+        if (kind == BlockedOp::Kind::General)
+        {
+            op.set_core(general_core(gate, matrices));
+        }
+        else if (kind == BlockedOp::Kind::CPhase)
+        {
+            op.m[0] = std::polar(1.0, gate.param);
+        }
+        else if (kind == BlockedOp::Kind::Diagonal)
+        {
+            std::complex<double> d0, d1;
+            diagonal_factors(gate, matrices, d0, d1);
+            // Consecutive diagonal gates share one op, so they cost a single multiplication per amplitude
+            if (!group.empty() && group.back().kind == BlockedOp::Kind::Diagonal)
+            {
+                group.back().bits.push_back(op.bits[0]);
+                group.back().factors.push_back(d0);
+                group.back().factors.push_back(d1);
+                continue;
+            }
+            op.factors = {d0, d1};
+        }
+        else if (kind == BlockedOp::Kind::Dense)
+        {
+            const QuantumGate core = gate_core(gate, matrices);
+            for (size_t r = 1; r <= core.get_rows(); r++)
+                for (size_t c = 1; c <= core.get_cols(); c++)
+                    op.dense.push_back(core(r, c));
+        }
+        group.push_back(op);
+    }
+
+    // Move every qubit back to its original bit, with as many disjoint exchanges per pass as possible
+    while (true)
+    {
+        std::vector<std::pair<size_t, size_t>> pairs;
+        std::vector<bool> busy(qubit_n, false);
+        for (size_t q = 0; q < qubit_n; q++)
+        {
+            size_t home = qubit_n - 1 - q;
+            if (pos[q] != home && !busy[pos[q]] && !busy[home])
+            {
+                pairs.push_back({pos[q], home});
+                busy[pos[q]] = true;
+                busy[home] = true;
+            }
+        }
+        if (pairs.empty())
+            break;
+        swap_bits(pairs);
+    }
+    flush_group();
+
+    if (stats != nullptr)
+        *stats = local_stats;
+}
@@ -4,6 +4,16 @@
 
 size_t QuantumCircuitConsole::menu_level = 0;
 
+// Circuits with non-Clifford gates are simulated with a statevector of 2^n amplitudes up to STATEVECTOR_MAX_QUBITS,
+// and with a matrix product state above. Clifford circuits use the stabilizer tableau, reversible circuits
+// (X, Y, CNOT, Swap and phase gates) on a basis state are computed on bits.
+const size_t STATEVECTOR_MAX_QUBITS = 20;
+const size_t MAX_QUBITS = 10000;
+// Largest bond dimension cap of the matrix product state offered by the console
+const size_t MAX_BOND_DIMENSION = 1024;
+// Number of measurement outcomes listed after sampling
+const size_t SHOWN_OUTCOMES = 16;
+
 // This map is for convenience in the return value of process_option()
 std::map<size_t, std::string> menu_titles =
     {
@@ -191,7 +201,7 @@ size_t CircuitOperationConsole::read_option()
     {
         // For creating a new circuit.
         std::cout << "Please enter the number of qubits: ";
-        size_t option = validate_option(1, 100);
+        size_t option = validate_option(1, MAX_QUBITS);
         std::cin.clear();
         std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
         return option;
@@ -384,15 +394,66 @@ std::string CircuitOperationConsole::process_option(size_t option)
     if (QuantumCircuitConsole::menu_level == 2)
     {
         size_t state_option = option;
+
+        // Reversible circuits map a basis state to one basis state, it is computed on bits
+        if (state_option == 1 && circuit.is_reversible())
+        {
+            simulate_reversible_circuit();
+
+            QuantumCircuitConsole::menu_level = 1;
+            pause_and_continue();
+            return menu_titles[1];
+        }
+
+        // Circuits made of Clifford gates only are simulated with the stabilizer tableau, in polynomial time
+        if (state_option == 1 && circuit.is_clifford())
+        {
+            simulate_clifford_circuit();
+
+            QuantumCircuitConsole::menu_level = 1;
+            pause_and_continue();
+            return menu_titles[1];
+        }
+
+        // Wide circuits that do not fit in a statevector are simulated with a matrix product state
+        if (qubit_n > STATEVECTOR_MAX_QUBITS)
+        {
+            if (state_option == 1)
+                simulate_mps_circuit();
+            else
+                std::cout << "Only a standard basis state can be simulated with more than " << STATEVECTOR_MAX_QUBITS << " qubits.\n";
+
+            QuantumCircuitConsole::menu_level = 1;
+            pause_and_continue();
+            return menu_titles[1];
+        }
+
         Statevector initial_state;
         Statevector final_state;
         initial_state = get_initial_state(state_option);
-        final_state = evolve(initial_state, circuit, "");
+
+        // Remove the gates that cancel and fuse consecutive single qubit gates first, the final state is the same with fewer passes.
+        OptimizationStats optimization_stats;
+        FusionStats fusion_stats;
+        QuantumCircuit fused_circuit = circuit.optimize_gates(&optimization_stats).fuse_gates(1, &fusion_stats);
+
+        // A standard basis state has a single amplitude, the sparse layout keeps it small as long as possible
+        if (state_option == 1)
+        {
+            SparseStatevector sparse_state(initial_state);
+            final_state = evolve(sparse_state, fused_circuit).to_statevector();
+        }
+        else
+        {
+            final_state = evolve(initial_state, fused_circuit, "");
+        }
 
         std::cout << "The initial state is: \n";
         initial_state.display_column();
         std::cout << "The final state is: \n";
         final_state.display_column();
+        optimization_stats.display();
+        fusion_stats.display();
 
         QuantumCircuitConsole::menu_level = 1;
         pause_and_continue();
@@ -408,32 +469,7 @@ Statevector CircuitOperationConsole::get_initial_state(size_t option)
 
     if (option == 1)
     {
-        std::cout << "\nPlease enter the state (eg: 01, 110): ";
-        std::string state_str;
-        std::cin >> state_str;
-
-        if (state_str.length() != qubit_n)
-        {
-            std::cout << "The length of the state must be equal to the number of qubits.\n";
-            std::cin.clear();
-            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-            return get_initial_state(option);
-        }
-        else
-        {
-            // Check if the string only contains '0' or '1'
-            for (char &c : state_str)
-            {
-                if (c != '0' && c != '1')
-                {
-                    std::cout << "The state can only contain binary digits (0 or 1).\n";
-                    std::cin.clear();
-                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-                    return get_initial_state(option);
-                }
-            }
-            initial_state = generate_state(qubit_n, "std", state_str);
-        }
+        initial_state = generate_state(qubit_n, "std", read_basis_state());
     }
     else if (option == 2)
     {
@@ -489,6 +525,121 @@ Statevector CircuitOperationConsole::get_initial_state(size_t option)
     return initial_state;
 }
 
+// Read a standard basis state such as 0110 (one binary digit per qubit) for option 1.
+std::string CircuitOperationConsole::read_basis_state()
+{
+    std::cout << "\nPlease enter the state (eg: 01, 110): ";
+    std::string state_str;
+    std::cin >> state_str;
+
+    if (state_str.length() != qubit_n)
+    {
+        std::cout << "The length of the state must be equal to the number of qubits.\n";
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        return read_basis_state();
+    }
+
+    // Check if the string only contains '0' or '1'
+    for (char &c : state_str)
+    {
+        if (c != '0' && c != '1')
+        {
+            std::cout << "The state can only contain binary digits (0 or 1).\n";
+            std::cin.clear();
+            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            return read_basis_state();
+        }
+    }
+    return state_str;
+}
+
+// Simulate a Clifford circuit with the stabilizer tableau: show the final stabilizers and sample measurements.
+void CircuitOperationConsole::simulate_clifford_circuit()
+{
+    std::string basis_state = read_basis_state();
+    StabilizerTableau initial_state(qubit_n, basis_state);
+    StabilizerTableau final_state = evolve(initial_state, circuit);
+
+    std::cout << "\nThe circuit only contains Clifford gates, it is simulated with a stabilizer tableau.\n";
+    if (qubit_n <= 64)
+    {
+        std::cout << "The final state is stabilized by: \n";
+        final_state.display_stabilizers();
+    }
+    else
+    {
+        std::cout << "The final state is stabilized by " << qubit_n << " Pauli strings (not displayed for more than 64 qubits).\n";
+    }
+
+    std::cout << "How many measurement shots would you like to sample? (1 - 100000) Enter: ";
+    size_t shots = validate_option(1, 100000);
+    std::cin.clear();
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+
+    std::mt19937_64 rng(std::random_device{}());
+    display_counts(final_state.sample(shots, rng));
+}
+
+// Simulate a reversible circuit on bits: show the output basis state and its phase.
+void CircuitOperationConsole::simulate_reversible_circuit()
+{
+    std::string basis_state = read_basis_state();
+    ReversibleCircuit empty(qubit_n);
+    ReversibleCircuit reversible = evolve(empty, circuit);
+    std::pair<std::string, std::complex<double>> output = reversible.run(basis_state);
+
+    std::cout << "\nThe circuit only contains X, Y, CNOT, Swap and phase gates, it maps the basis state to a basis state.\n";
+    std::cout << "The final state is: " << output.second << " |" << output.first << ">" << std::endl;
+}
+
+// Simulate a wide circuit with a matrix product state: show the bond dimensions and sample measurements.
+void CircuitOperationConsole::simulate_mps_circuit()
+{
+    std::string basis_state = read_basis_state();
+    std::cout << "The circuit is simulated with a matrix product state.\n";
+    std::cout << "Please enter the maximum bond dimension (1 - " << MAX_BOND_DIMENSION << "): ";
+    size_t max_bond = validate_option(1, MAX_BOND_DIMENSION);
+    std::cin.clear();
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+
+    MatrixProductState initial_state(qubit_n, basis_state, max_bond);
+    MatrixProductState final_state = evolve(initial_state, circuit);
+
+    std::cout << "Largest bond dimension: " << final_state.max_bond_dimension() << std::endl;
+    std::cout << "Truncation error (discarded weight): " << final_state.truncation_error() << std::endl;
+    std::cout << "Memory of the tensors: " << final_state.memory_size() * sizeof(std::complex<double>) << " bytes" << std::endl;
+
+    std::cout << "How many measurement shots would you like to sample? (1 - 100000) Enter: ";
+    size_t shots = validate_option(1, 100000);
+    std::cin.clear();
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+
+    std::mt19937_64 rng(std::random_device{}());
+    display_counts(final_state.sample(shots, rng));
+}
+
+void display_counts(const std::map<std::string, size_t> &counts)
+{
+    std::vector<std::pair<size_t, std::string>> sorted_counts;
+    for (auto it = counts.begin(); it != counts.end(); it++)
+    {
+        sorted_counts.push_back({it->second, it->first});
+    }
+    std::stable_sort(sorted_counts.begin(), sorted_counts.end(),
+                     [](const std::pair<size_t, std::string> &a, const std::pair<size_t, std::string> &b) { return a.first > b.first; });
+
+    std::cout << "Measurement outcomes (qubit 0 first): \n";
+    for (size_t i = 0; i < sorted_counts.size() && i < SHOWN_OUTCOMES; i++)
+    {
+        std::cout << "  |" << sorted_counts[i].second << ">  " << sorted_counts[i].first << std::endl;
+    }
+    if (sorted_counts.size() > SHOWN_OUTCOMES)
+    {
+        std::cout << "  ... and " << sorted_counts.size() - SHOWN_OUTCOMES << " other outcomes.\n";
+    }
+}
+
 void DisplayInfoConsole::display_menu()
 {
     std::cout << std::endl;
@@ -0,0 +1,457 @@
+#include "../include/DecisionDiagram.hpp"
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+
+// Complex numbers closer than this share one entry of the complex table
+static const double COMPLEX_TOLERANCE = 1e-13;
+// The compute tables are cleared when one of them grows past this number of entries
+static const size_t COMPUTE_TABLE_LIMIT = 1 << 20;
+
+struct DDNode
+{
+    size_t level;    // the qubit of the node, qubit_n for the terminal node
+    DDEdge edges[4]; // two edges for a vector node, four (the 2x2 blocks, row major) for a matrix node
+};
+
+// Key of the unique table (the level and the edges of a node) and of the compute tables (the operands)
+struct TableKey
+{
+    size_t tag;
+    const void *pointers[8];
+
+    bool operator==(const TableKey &key) const
+    {
+        if (tag != key.tag)
+            return false;
+        for (size_t i = 0; i < 8; i++)
+            if (pointers[i] != key.pointers[i])
+                return false;
+        return true;
+    }
+};
+
+struct TableKeyHash
+{
+    size_t operator()(const TableKey &key) const
+    {
+        size_t hash = key.tag;
+        for (size_t i = 0; i < 8; i++)
+        {
+            hash = (hash ^ reinterpret_cast<size_t>(key.pointers[i])) * 0x9E3779B97F4A7C15ULL;
+            hash ^= hash >> 29;
+        }
+        return hash;
+    }
+};
+
+struct BucketHash
+{
+    size_t operator()(const std::pair<long long, long long> &bucket) const
+    {
+        return static_cast<size_t>(bucket.first) * 0x9E3779B97F4A7C15ULL ^ static_cast<size_t>(bucket.second);
+    }
+};
+
+class DDPackage
+{
+private:
+    // Stable addresses: the edges point into these containers
+    std::deque<std::complex<double>> complex_values;
+    std::deque<DDNode> nodes;
+
+    // The complex table is a grid of COMPLEX_TOLERANCE cells, a value is compared with the entries of its neighbouring cells
+    std::unordered_map<std::pair<long long, long long>, std::vector<const std::complex<double> *>, BucketHash> complex_table;
+    std::unordered_map<TableKey, DDNode *, TableKeyHash> unique_table;
+    std::unordered_map<TableKey, DDEdge, TableKeyHash> add_table;
+    std::unordered_map<TableKey, DDEdge, TableKeyHash> multiply_table;
+
+    // identities[level] is the identity on the qubits level, ..., qubit_n - 1
+    std::vector<DDNode *> identities;
+
+public:
+    DDNode *terminal;
+    const std::complex<double> *zero;
+    const std::complex<double> *one;
+
+    DDPackage(size_t qubit_n);
+
+    // The canonical entry of a complex number
+    const std::complex<double> *lookup(std::complex<double> value);
+
+    DDEdge zero_edge() const { return {terminal, zero}; }
+    DDEdge scale(DDEdge edge, std::complex<double> factor);
+
+    // A normalised node with edge_n = 2 (vector) or 4 (matrix) edges, the common factor is the weight of the returned edge
+    DDEdge make_node(size_t level, const DDEdge *edges, size_t edge_n);
+
+    DDEdge add(DDEdge a, DDEdge b, size_t edge_n);
+    DDEdge multiply(DDEdge matrix, DDEdge vector);
+
+    // The matrix diagram of a gate on the given qubits of a qubit_n register
+    DDEdge gate_matrix(size_t qubit_n, const std::vector<size_t> &qubits, const QuantumGate &gate);
+
+    void limit_compute_tables();
+    size_t node_count() const { return nodes.size() - 1; }
+};
+
+DDPackage::DDPackage(size_t qubit_n)
+{
+    nodes.push_back(DDNode());
+    terminal = &nodes.back();
+    terminal->level = qubit_n;
+
+    complex_values.push_back(0.0);
+    zero = &complex_values.back();
+    one = lookup(1.0);
+    for (size_t i = 0; i < 4; i++)
+        terminal->edges[i] = zero_edge();
+
+    identities.assign(qubit_n + 1, terminal);
+    for (size_t level = qubit_n; level-- > 0;)
+    {
+        const DDEdge below{identities[level + 1], one};
+        const DDEdge edges[4] = {below, zero_edge(), zero_edge(), below};
+        identities[level] = make_node(level, edges, 4).node;
+    }
+}
+
+const std::complex<double> *DDPackage::lookup(std::complex<double> value)
+{
+    if (std::abs(value.real()) < COMPLEX_TOLERANCE && std::abs(value.imag()) < COMPLEX_TOLERANCE)
+        return zero;
+
+    const long long re = std::llround(value.real() / COMPLEX_TOLERANCE);
+    const long long im = std::llround(value.imag() / COMPLEX_TOLERANCE);
+    for (long long i = re - 1; i <= re + 1; i++)
+        for (long long j = im - 1; j <= im + 1; j++)
+        {
+            auto bucket = complex_table.find(std::make_pair(i, j));
+            if (bucket == complex_table.end())
+                continue;
+            for (auto it = bucket->second.begin(); it != bucket->second.end(); it++)
+                if (std::abs((*it)->real() - value.real()) < COMPLEX_TOLERANCE &&
+                    std::abs((*it)->imag() - value.imag()) < COMPLEX_TOLERANCE)
+                    return *it;
+        }
+
+    complex_values.push_back(value);
+    complex_table[std::make_pair(re, im)].push_back(&complex_values.back());
+    return &complex_values.back();
+}
+
+DDEdge DDPackage::scale(DDEdge edge, std::complex<double> factor)
+{
+    const std::complex<double> *weight = lookup(*edge.weight * factor);
+    return weight == zero ? zero_edge() : DDEdge{edge.node, weight};
+}
+
+DDEdge DDPackage::make_node(size_t level, const DDEdge *edges, size_t edge_n)
+{
+    // The edge of largest magnitude (the first one in case of a tie) becomes 1
+    size_t pivot = edge_n;
+    double largest = 0.0;
+    for (size_t i = 0; i < edge_n; i++)
+    {
+        const double magnitude = std::abs(*edges[i].weight);
+        if (edges[i].weight != zero && magnitude > largest + COMPLEX_TOLERANCE)
+        {
+            pivot = i;
+            largest = magnitude;
+        }
+    }
+    if (pivot == edge_n)
+        return zero_edge();
+
+    const std::complex<double> factor = *edges[pivot].weight;
+    DDNode node;
+    node.level = level;
+    TableKey key{level * 2 + (edge_n == 4 ? 1 : 0), {}};
+    for (size_t i = 0; i < 4; i++)
+    {
+        if (i >= edge_n || edges[i].weight == zero)
+            node.edges[i] = zero_edge();
+        else if (i == pivot)
+            node.edges[i] = DDEdge{edges[i].node, one};
+        else
+            node.edges[i] = scale(edges[i], 1.0 / factor);
+        key.pointers[2 * i] = node.edges[i].node;
+        key.pointers[2 * i + 1] = node.edges[i].weight;
+    }
+
+    auto it = unique_table.find(key);
+    if (it == unique_table.end())
+    {
+        nodes.push_back(node);
+        it = unique_table.emplace(key, &nodes.back()).first;
+    }
+    return DDEdge{it->second, lookup(factor)};
+}
+
+DDEdge DDPackage::add(DDEdge a, DDEdge b, size_t edge_n)
+{
+    if (a.weight == zero)
+        return b;
+    if (b.weight == zero)
+        return a;
+    if (a.node == b.node)
+    {
+        const std::complex<double> *weight = lookup(*a.weight + *b.weight);
+        return weight == zero ? zero_edge() : DDEdge{a.node, weight};
+    }
+
+    const TableKey key{0, {a.node, a.weight, b.node, b.weight, nullptr, nullptr, nullptr, nullptr}};
+    auto cached = add_table.find(key);
+    if (cached != add_table.end())
+        return cached->second;
+
+    // Both nodes are on the same level, the nonzero edges never skip a level
+    DDEdge children[4];
+    for (size_t i = 0; i < edge_n; i++)
+        children[i] = add(scale(a.node->edges[i], *a.weight), scale(b.node->edges[i], *b.weight), edge_n);
+    const DDEdge result = make_node(a.node->level, children, edge_n);
+
+    add_table.emplace(key, result);
+    return result;
+}
+
+DDEdge DDPackage::multiply(DDEdge matrix, DDEdge vector)
+{
+    if (matrix.weight == zero || vector.weight == zero)
+        return zero_edge();
+    const std::complex<double> factor = *matrix.weight * *vector.weight;
+    if (vector.node == terminal)
+        return DDEdge{terminal, lookup(factor)};
+    // The levels below the targets of a gate are the identity
+    if (matrix.node == identities[vector.node->level])
+        return scale(vector, *matrix.weight);
+
+    // The product of the nodes is memoised, the weights of the operands only scale it
+    const TableKey key{1, {matrix.node, vector.node, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr}};
+    auto cached = multiply_table.find(key);
+    if (cached != multiply_table.end())
+        return scale(cached->second, factor);
+
+    DDEdge children[2];
+    for (size_t i = 0; i < 2; i++)
+    {
+        children[i] = add(multiply(matrix.node->edges[2 * i], vector.node->edges[0]),
+                          multiply(matrix.node->edges[2 * i + 1], vector.node->edges[1]), 2);
+    }
+    const DDEdge result = make_node(vector.node->level, children, 2);
+
+    multiply_table.emplace(key, result);
+    return scale(result, factor);
+}
+
+DDEdge DDPackage::gate_matrix(size_t qubit_n, const std::vector<size_t> &qubits, const QuantumGate &gate)
+{
+    const size_t k = qubits.size();
+    if (gate.get_rows() != (size_t(1) << k))
+        throw std::invalid_argument("The size of the gate does not match the number of target qubits!");
+
+    std::vector<size_t> position(qubit_n, k);
+    for (size_t i = 0; i < k; i++)
+    {
+        if (qubits[i] >= qubit_n)
+            throw std::invalid_argument("The target qubit is out of range!");
+        if (position[qubits[i]] != k)
+            throw std::invalid_argument("The target qubits must be different!");
+        position[qubits[i]] = i;
+    }
+
+    /*
+    The gate is the sum of its nonzero entries m |r><c|, each one a product of one 2x2 matrix unit per
+    target qubit and the identity on the other qubits, i.e. a chain of one node per level. The chains
+    are summed from the first target down, the identity levels above it are added once at the end.
+    */
+    const size_t top = *std::min_element(qubits.begin(), qubits.end());
+    DDEdge result = zero_edge();
+    for (size_t r = 0; r < gate.get_rows(); r++)
+    {
+        for (size_t c = 0; c < gate.get_cols(); c++)
+        {
+            const std::complex<double> entry = gate(r + 1, c + 1);
+            if (lookup(entry) == zero)
+                continue;
+
+            DDEdge chain{terminal, one};
+            for (size_t level = qubit_n; level-- > top;)
+            {
+                DDEdge edges[4] = {zero_edge(), zero_edge(), zero_edge(), zero_edge()};
+                if (position[level] == k)
+                {
+                    edges[0] = chain;
+                    edges[3] = chain;
+                }
+                else
+                {
+                    const size_t shift = k - 1 - position[level];
+                    edges[2 * ((r >> shift) & 1) + ((c >> shift) & 1)] = chain;
+                }
+                chain = make_node(level, edges, 4);
+            }
+            result = add(result, scale(chain, entry), 4);
+        }
+    }
+
+    for (size_t level = top; level-- > 0;)
+    {
+        const DDEdge below{result.node, one};
+        const DDEdge edges[4] = {below, zero_edge(), zero_edge(), below};
+        result = scale(make_node(level, edges, 4), *result.weight);
+    }
+    return result;
+}
+
+void DDPackage::limit_compute_tables()
+{
+    if (add_table.size() > COMPUTE_TABLE_LIMIT)
+        add_table.clear();
+    if (multiply_table.size() > COMPUTE_TABLE_LIMIT)
+        multiply_table.clear();
+}
+
+DecisionDiagram::DecisionDiagram(size_t qubit_n_) :
+DecisionDiagram(qubit_n_, std::string(qubit_n_, '0'))
+{
+}
+
+DecisionDiagram::DecisionDiagram(size_t qubit_n_, const std::string &basis_state) :
+qubit_n(qubit_n_), package(std::make_shared<DDPackage>(qubit_n_))
+{
+    if (qubit_n == 0)
+        throw std::invalid_argument("A decision diagram needs at least one qubit!");
+    if (basis_state.length() != qubit_n)
+        throw std::invalid_argument("The length of the state must be equal to the number of qubits!");
+
+    // A basis state is a single path, built from the last qubit up
+    root = DDEdge{package->terminal, package->one};
+    for (size_t level = qubit_n; level-- > 0;)
+    {
+        if (basis_state[level] != '0' && basis_state[level] != '1')
+            throw std::invalid_argument("The state can only contain binary digits!");
+        DDEdge edges[2] = {package->zero_edge(), package->zero_edge()};
+        edges[basis_state[level] - '0'] = root;
+        root = package->make_node(level, edges, 2);
+    }
+}
+
+void DecisionDiagram::apply_gate(const std::vector<size_t> &qubits, const QuantumGate &gate)
+{
+    package->limit_compute_tables();
+    root = package->multiply(package->gate_matrix(qubit_n, qubits, gate), root);
+}
+
+std::complex<double> DecisionDiagram::amplitude(const std::string &basis_state) const
+{
+    if (basis_state.length() != qubit_n)
+        throw std::invalid_argument("The length of the state must be equal to the number of qubits!");
+
+    std::complex<double> result = *root.weight;
+    const DDNode *node = root.node;
+    for (size_t q = 0; q < qubit_n && result != 0.0; q++)
+    {
+        const DDEdge &edge = node->edges[basis_state[q] == '1' ? 1 : 0];
+        result *= *edge.weight;
+        node = edge.node;
+    }
+    return result;
+}
+
+// Add the amplitudes below an edge of the given level to the statevector, index holds the bits of the levels above
+static void collect_amplitudes(const DDEdge &edge, size_t level, size_t qubit_n, size_t index,
+                               std::complex<double> weight, Statevector &state)
+{
+    weight *= *edge.weight;
+    if (weight == 0.0)
+        return;
+    if (level == qubit_n)
+    {
+        state[index] = weight;
+        return;
+    }
+    for (size_t bit = 0; bit < 2; bit++)
+        collect_amplitudes(edge.node->edges[bit], level + 1, qubit_n, (index << 1) | bit, weight, state);
+}
+
+Statevector DecisionDiagram::to_statevector() const
+{
+    if (qubit_n > 24)
+        throw std::invalid_argument("The statevector of more than 24 qubits is too large!");
+
+    Statevector state(qubit_n);
+    for (size_t i = 0; i < state.size(); i++)
+        state[i] = 0.0;
+    collect_amplitudes(root, 0, qubit_n, 0, 1.0, state);
+    return state;
+}
+
+// Squared norm of the sub-vector of a node, each shared node is computed once
+static double squared_norm(const DDNode *node, const DDNode *terminal, std::unordered_map<const DDNode *, double> &norms)
+{
+    if (node == terminal)
+        return 1.0;
+    auto it = norms.find(node);
+    if (it != norms.end())
+        return it->second;
+
+    double result = 0.0;
+    for (size_t bit = 0; bit < 2; bit++)
+        if (*node->edges[bit].weight != 0.0)
+            result += std::norm(*node->edges[bit].weight) * squared_norm(node->edges[bit].node, terminal, norms);
+    norms[node] = result;
+    return result;
+}
+
+std::map<std::string, size_t> DecisionDiagram::sample(size_t shots, std::mt19937_64 &rng) const
+{
+    std::unordered_map<const DDNode *, double> norms;
+    squared_norm(root.node, package->terminal, norms);
+
+    // Each shot walks down from the root, choosing the branches with their conditional probabilities
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::map<std::string, size_t> counts;
+    for (size_t shot = 0; shot < shots; shot++)
+    {
+        std::string bits(qubit_n, '0');
+        const DDNode *node = root.node;
+        for (size_t q = 0; q < qubit_n; q++)
+        {
+            double probability[2] = {0.0, 0.0};
+            for (size_t bit = 0; bit < 2; bit++)
+                if (*node->edges[bit].weight != 0.0)
+                    probability[bit] = std::norm(*node->edges[bit].weight) *
+                                       squared_norm(node->edges[bit].node, package->terminal, norms);
+
+            const size_t outcome = uniform(rng) * (probability[0] + probability[1]) < probability[0] ? 0 : 1;
+            bits[q] = outcome ? '1' : '0';
+            node = node->edges[outcome].node;
+        }
+        counts[bits]++;
+    }
+    return counts;
+}
+
+size_t DecisionDiagram::node_count() const
+{
+    std::unordered_set<const DDNode *> visited;
+    std::vector<const DDNode *> stack{root.node};
+    while (!stack.empty())
+    {
+        const DDNode *node = stack.back();
+        stack.pop_back();
+        if (node == package->terminal || !visited.insert(node).second)
+            continue;
+        for (size_t bit = 0; bit < 2; bit++)
+            if (*node->edges[bit].weight != 0.0)
+                stack.push_back(node->edges[bit].node);
+    }
+    return visited.size();
+}
+
+size_t DecisionDiagram::package_node_count() const
+{
+    return package->node_count();
+}
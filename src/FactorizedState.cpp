@@ -0,0 +1,198 @@
+#include "../include/FactorizedState.hpp"
+#include "../include/QuantumCircuit.hpp"
+#include <algorithm>
+
+FactorizedState::FactorizedState(size_t qubit_n_) :
+FactorizedState(qubit_n_, std::string(qubit_n_, '0'))
+{
+}
+
+FactorizedState::FactorizedState(size_t qubit_n_, const std::string &basis_state) :
+qubit_n(qubit_n_)
+{
+    if (qubit_n == 0)
+        throw std::invalid_argument("A factorized state needs at least one qubit!");
+    if (basis_state.length() != qubit_n)
+        throw std::invalid_argument("The length of the state must be equal to the number of qubits!");
+
+    // A basis state is a product state, one single qubit cluster per qubit
+    for (size_t q = 0; q < qubit_n; q++)
+    {
+        if (basis_state[q] != '0' && basis_state[q] != '1')
+            throw std::invalid_argument("The state can only contain binary digits!");
+        Statevector single(1);
+        single[basis_state[q] - '0'] = 1.0;
+        clusters.push_back(Cluster{{q}, single});
+    }
+    update_labels();
+}
+
+void FactorizedState::update_labels()
+{
+    cluster_of.assign(qubit_n, 0);
+    position_of.assign(qubit_n, 0);
+    for (size_t c = 0; c < clusters.size(); c++)
+        for (size_t j = 0; j < clusters[c].qubits.size(); j++)
+        {
+            cluster_of[clusters[c].qubits[j]] = c;
+            position_of[clusters[c].qubits[j]] = j;
+        }
+}
+
+void FactorizedState::merge(size_t a, size_t b)
+{
+    const Statevector &high = clusters[a].state, &low = clusters[b].state;
+    const size_t qubits = high.qubit_num() + low.qubit_num();
+    if (qubits > MAX_CLUSTER_QUBITS)
+        throw std::invalid_argument("The entangled cluster is too large for a statevector!");
+
+    // Kronecker product, the index of the merged cluster is (high index, low index)
+    Statevector merged(qubits);
+    for (size_t i = 0; i < high.size(); i++)
+    {
+        if (high[i] == 0.0)
+            continue;
+        for (size_t j = 0; j < low.size(); j++)
+            merged[i * low.size() + j] = high[i] * low[j];
+    }
+
+    clusters[a].qubits.insert(clusters[a].qubits.end(), clusters[b].qubits.begin(), clusters[b].qubits.end());
+    clusters[a].state = std::move(merged);
+    clusters.erase(clusters.begin() + b);
+    update_labels();
+}
+
+size_t FactorizedState::largest_cluster() const
+{
+    size_t largest = 0;
+    for (auto it = clusters.begin(); it != clusters.end(); it++)
+        largest = std::max(largest, it->qubits.size());
+    return largest;
+}
+
+std::vector<std::vector<size_t>> FactorizedState::cluster_qubits() const
+{
+    std::vector<std::vector<size_t>> result;
+    for (auto it = clusters.begin(); it != clusters.end(); it++)
+        result.push_back(it->qubits);
+    return result;
+}
+
+size_t FactorizedState::memory_size() const
+{
+    size_t amplitudes = 0;
+    for (auto it = clusters.begin(); it != clusters.end(); it++)
+        amplitudes += it->state.size();
+    return amplitudes;
+}
+
+void FactorizedState::apply_swap(size_t qubit1, size_t qubit2)
+{
+    if (qubit1 >= qubit_n || qubit2 >= qubit_n)
+        throw std::invalid_argument("The target qubit is out of range!");
+
+    // The two qubits exchange their places, no amplitude moves
+    std::swap(clusters[cluster_of[qubit1]].qubits[position_of[qubit1]],
+              clusters[cluster_of[qubit2]].qubits[position_of[qubit2]]);
+    std::swap(cluster_of[qubit1], cluster_of[qubit2]);
+    std::swap(position_of[qubit1], position_of[qubit2]);
+}
+
+void FactorizedState::apply_gate(const std::vector<size_t> &qubits, const QuantumGate &gate)
+{
+    if (gate.get_rows() != (size_t(1) << qubits.size()))
+        throw std::invalid_argument("The size of the gate does not match the number of target qubits!");
+    for (auto q = qubits.begin(); q != qubits.end(); q++)
+        if (*q >= qubit_n)
+            throw std::invalid_argument("The target qubit is out of range!");
+
+    if (gate.get_type() == QuantumGate::Type::Swap)
+    {
+        apply_swap(qubits[0], qubits[1]);
+        return;
+    }
+
+    // Merge every cluster touched by the gate into the first one, from the last so that the indices stay valid
+    std::vector<size_t> touched;
+    for (auto q = qubits.begin(); q != qubits.end(); q++)
+        touched.push_back(cluster_of[*q]);
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    for (size_t i = touched.size(); i-- > 1;)
+        merge(touched[0], touched[i]);
+
+    std::vector<size_t> local;
+    for (auto q = qubits.begin(); q != qubits.end(); q++)
+        local.push_back(position_of[*q]);
+    ::apply_gate(clusters[touched[0]].state, local, gate);
+}
+
+std::complex<double> FactorizedState::amplitude(const std::string &basis_state) const
+{
+    if (basis_state.length() != qubit_n)
+        throw std::invalid_argument("The length of the state must be equal to the number of qubits!");
+
+    std::complex<double> result = 1.0;
+    for (auto it = clusters.begin(); it != clusters.end(); it++)
+    {
+        size_t index = 0;
+        for (auto q = it->qubits.begin(); q != it->qubits.end(); q++)
+            index = (index << 1) | (basis_state[*q] == '1' ? 1 : 0);
+        result *= it->state[index];
+    }
+    return result;
+}
+
+std::map<std::string, size_t> FactorizedState::sample(size_t shots, std::mt19937_64 &rng) const
+{
+    // Cumulative distribution of each cluster
+    std::vector<std::vector<double>> cumulative;
+    for (auto it = clusters.begin(); it != clusters.end(); it++)
+    {
+        std::vector<double> sums(it->state.size());
+        double sum = 0.0;
+        for (size_t i = 0; i < it->state.size(); i++)
+            sums[i] = sum += std::norm(it->state[i]);
+        cumulative.push_back(sums);
+    }
+
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::map<std::string, size_t> counts;
+    for (size_t shot = 0; shot < shots; shot++)
+    {
+        std::string bits(qubit_n, '0');
+        for (size_t c = 0; c < clusters.size(); c++)
+        {
+            const std::vector<double> &sums = cumulative[c];
+            const size_t index = std::min<size_t>(
+                std::upper_bound(sums.begin(), sums.end(), uniform(rng) * sums.back()) - sums.begin(), sums.size() - 1);
+            const std::vector<size_t> &cluster_qubits = clusters[c].qubits;
+            for (size_t j = 0; j < cluster_qubits.size(); j++)
+                bits[cluster_qubits[j]] = (index >> (cluster_qubits.size() - 1 - j)) & 1 ? '1' : '0';
+        }
+        counts[bits]++;
+    }
+    return counts;
+}
+
+Statevector FactorizedState::to_statevector() const
+{
+    if (qubit_n > 24)
+        throw std::invalid_argument("The statevector of more than 24 qubits is too large!");
+
+    // Each amplitude is the product of one amplitude per cluster, picked by the bits of its qubits
+    Statevector state(qubit_n);
+    for (size_t i = 0; i < state.size(); i++)
+    {
+        std::complex<double> amplitude = 1.0;
+        for (auto it = clusters.begin(); it != clusters.end() && amplitude != 0.0; it++)
+        {
+            size_t index = 0;
+            for (auto q = it->qubits.begin(); q != it->qubits.end(); q++)
+                index = (index << 1) | ((i >> (qubit_n - 1 - *q)) & 1);
+            amplitude *= it->state[index];
+        }
+        state[i] = amplitude;
+    }
+    return state;
+}
@@ -0,0 +1,188 @@
+#include "../include/FeynmanPathSum.hpp"
+#include "../include/ThreadPool.hpp"
+#include <algorithm>
+
+// Subtrees per thread, several so that every thread keeps a share when some of the paths die early
+static const size_t SUBTREES_PER_THREAD = 8;
+
+FeynmanPathSum::FeynmanPathSum(size_t qubit_n_) :
+FeynmanPathSum(qubit_n_, std::string(qubit_n_, '0'))
+{
+}
+
+FeynmanPathSum::FeynmanPathSum(size_t qubit_n_, const std::string &basis_state) :
+qubit_n(qubit_n_), initial_bits(0)
+{
+    if (qubit_n == 0 || qubit_n > MAX_QUBITS)
+        throw std::invalid_argument("The path sum supports 1 to 64 qubits!");
+    if (basis_state.length() != qubit_n)
+        throw std::invalid_argument("The length of the state must be equal to the number of qubits!");
+
+    // Qubit 0 is the most significant bit, as in the statevector index
+    for (size_t q = 0; q < qubit_n; q++)
+    {
+        if (basis_state[q] != '0' && basis_state[q] != '1')
+            throw std::invalid_argument("The state can only contain binary digits!");
+        initial_bits = (initial_bits << 1) | uint64_t(basis_state[q] - '0');
+    }
+}
+
+void FeynmanPathSum::add_gate(const std::vector<size_t> &qubits, const QuantumGate &gate)
+{
+    const size_t k = qubits.size();
+    if (gate.get_rows() != (size_t(1) << k))
+        throw std::invalid_argument("The size of the gate does not match the number of target qubits!");
+
+    PathGate path_gate;
+    for (size_t i = 0; i < k; i++)
+    {
+        if (qubits[i] >= qubit_n)
+            throw std::invalid_argument("The target qubit is out of range!");
+        if (std::find(qubits.begin(), qubits.begin() + i, qubits[i]) != qubits.begin() + i)
+            throw std::invalid_argument("The target qubits must be different!");
+        path_gate.bits.push_back(qubit_n - 1 - qubits[i]);
+    }
+
+    for (size_t c = 0; c < gate.get_cols(); c++)
+    {
+        std::vector<std::pair<size_t, std::complex<double>>> column;
+        for (size_t r = 0; r < gate.get_rows(); r++)
+        {
+            const std::complex<double> entry = gate(r + 1, c + 1);
+            if (std::abs(entry) > gate.ROUND_MINIMUM)
+                column.push_back(std::make_pair(r, entry));
+        }
+        path_gate.columns.push_back(column);
+    }
+    gates.push_back(path_gate);
+}
+
+double FeynmanPathSum::path_count() const
+{
+    double count = 1.0;
+    for (auto it = gates.begin(); it != gates.end(); it++)
+    {
+        size_t widest = 0;
+        for (auto column = it->columns.begin(); column != it->columns.end(); column++)
+            widest = std::max(widest, column->size());
+        count *= widest;
+    }
+    return count;
+}
+
+// The column of the gate selected by the basis state, i.e. the bits of the targets
+static size_t column_of(const std::vector<size_t> &bits, uint64_t state)
+{
+    size_t column = 0;
+    for (auto it = bits.begin(); it != bits.end(); it++)
+        column = (column << 1) | ((state >> *it) & 1);
+    return column;
+}
+
+// The basis state with the bits of the targets replaced by row
+static uint64_t set_row(const std::vector<size_t> &bits, uint64_t state, size_t row)
+{
+    const size_t k = bits.size();
+    for (size_t i = 0; i < k; i++)
+    {
+        const uint64_t bit = uint64_t((row >> (k - 1 - i)) & 1);
+        state = (state & ~(uint64_t(1) << bits[i])) | (bit << bits[i]);
+    }
+    return state;
+}
+
+bool FeynmanPathSum::advance(size_t &gate, uint64_t &bits, std::complex<double> &weight) const
+{
+    for (; gate < gates.size(); gate++)
+    {
+        const auto &column = gates[gate].columns[column_of(gates[gate].bits, bits)];
+        if (column.empty())
+            return false;
+        if (column.size() > 1)
+            break;
+        bits = set_row(gates[gate].bits, bits, column[0].first);
+        weight *= column[0].second;
+    }
+    return true;
+}
+
+std::complex<double> FeynmanPathSum::sum_paths(size_t gate, uint64_t bits, std::complex<double> weight, uint64_t target) const
+{
+    if (!advance(gate, bits, weight))
+        return 0.0;
+    if (gate == gates.size())
+        return bits == target ? weight : 0.0;
+
+    std::complex<double> sum = 0.0;
+    const auto &column = gates[gate].columns[column_of(gates[gate].bits, bits)];
+    for (auto it = column.begin(); it != column.end(); it++)
+        sum += sum_paths(gate + 1, set_row(gates[gate].bits, bits, it->first), weight * it->second, target);
+    return sum;
+}
+
+std::complex<double> FeynmanPathSum::amplitude(const std::string &bitstring) const
+{
+    if (bitstring.length() != qubit_n)
+        throw std::invalid_argument("The length of the state must be equal to the number of qubits!");
+    uint64_t target = 0;
+    for (size_t q = 0; q < qubit_n; q++)
+    {
+        if (bitstring[q] != '0' && bitstring[q] != '1')
+            throw std::invalid_argument("The state can only contain binary digits!");
+        target = (target << 1) | uint64_t(bitstring[q] - '0');
+    }
+
+    const size_t thread_n = get_thread_count();
+    if (thread_n == 1)
+        return sum_paths(0, initial_bits, 1.0, target);
+
+    /*
+    Split the tree of paths at its first branches until there are enough subtrees for the threads.
+    A subtree is the gate where it starts, the basis state and the weight of the path up to there.
+    */
+    struct Subtree
+    {
+        size_t gate;
+        uint64_t bits;
+        std::complex<double> weight;
+    };
+    std::vector<Subtree> subtrees{Subtree{0, initial_bits, 1.0}};
+    bool split = true;
+    while (split && subtrees.size() < SUBTREES_PER_THREAD * thread_n)
+    {
+        split = false;
+        std::vector<Subtree> next;
+        for (auto it = subtrees.begin(); it != subtrees.end(); it++)
+        {
+            Subtree subtree = *it;
+            if (!advance(subtree.gate, subtree.bits, subtree.weight))
+                continue;
+            if (subtree.gate == gates.size())
+            {
+                next.push_back(subtree);
+                continue;
+            }
+
+            const PathGate &gate = gates[subtree.gate];
+            const auto &column = gate.columns[column_of(gate.bits, subtree.bits)];
+            for (auto entry = column.begin(); entry != column.end(); entry++)
+                next.push_back(Subtree{subtree.gate + 1, set_row(gate.bits, subtree.bits, entry->first),
+                                       subtree.weight * entry->second});
+            split = true;
+        }
+        subtrees.swap(next);
+    }
+
+    std::vector<std::complex<double>> partial(subtrees.size(), 0.0);
+    // Every subtree is a large job, so the loop runs on the global pool whatever the grain size
+    parallel_for(0, subtrees.size(), [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+            partial[i] = sum_paths(subtrees[i].gate, subtrees[i].bits, subtrees[i].weight, target);
+    }, 1, 1);
+
+    std::complex<double> sum = 0.0;
+    for (auto it = partial.begin(); it != partial.end(); it++)
+        sum += *it;
+    return sum;
+}
@@ -0,0 +1,94 @@
+#include "../include/FixedGate.hpp"
+
+// Checked by the compiler: the products of the constexpr gates are evaluated at compile time
+static_assert((FixedPauliX * FixedPauliX)(1, 1) == FixedComplex{1, 0} && (FixedPauliX * FixedPauliX)(1, 2) == FixedComplex{0, 0},
+              "X X must be the identity");
+static_assert(kronecker(FixedPauliX, FixedIdentity2x2)(1, 3) == FixedComplex{1, 0} && kronecker(FixedPauliX, FixedIdentity2x2)(1, 1) == FixedComplex{0, 0},
+              "X ⊗ I must flip qubit 0");
+
+FixedGate<1> fixed_phase(double phase)
+{
+    FixedGate<1> gate = FixedIdentity2x2;
+    gate(2, 2) = FixedComplex{std::cos(phase), std::sin(phase)};
+    return gate;
+}
+
+FixedGate<2> fixed_controlled_phase(double phase)
+{
+    FixedGate<2> gate = kronecker(FixedIdentity2x2, FixedIdentity2x2);
+    gate(4, 4) = FixedComplex{std::cos(phase), std::sin(phase)};
+    return gate;
+}
+
+template <>
+void apply_fixed_gate<1>(Statevector &state, const std::array<size_t, 1> &qubits, const FixedGate<1> &gate)
+{
+    if (qubits[0] >= state.qubit_num())
+        throw std::invalid_argument("Target qubit is out of range!");
+
+    struct Job
+    {
+        std::complex<double> *amp;
+        const FixedGate<1> &gate;
+        size_t bit;
+        size_t stride;
+    } job{state.data(), gate, state.qubit_num() - 1 - qubits[0], qubit_stride(state.qubit_num(), qubits[0])};
+
+    parallel_for(0, state.size() / 2, [&job](size_t begin, size_t end)
+    {
+        const FixedComplex m00 = job.gate.entries[0], m01 = job.gate.entries[1];
+        const FixedComplex m10 = job.gate.entries[2], m11 = job.gate.entries[3];
+        std::complex<double> *amp = job.amp;
+
+        for (size_t k = begin; k < end; k++)
+        {
+            const size_t i = insert_zero_bit(k, job.bit);
+            const std::complex<double> a0 = amp[i];
+            const std::complex<double> a1 = amp[i + job.stride];
+            amp[i] = fixed_multiply(m00, a0) + fixed_multiply(m01, a1);
+            amp[i + job.stride] = fixed_multiply(m10, a0) + fixed_multiply(m11, a1);
+        }
+    });
+}
+
+/*
+The group of index i (both target bits 0) is i, i + s1, i + s0, i + s0 + s1, which are the local basis
+states 00, 01, 10, 11 with qubits[0] as the high bit.
+*/
+template <>
+void apply_fixed_gate<2>(Statevector &state, const std::array<size_t, 2> &qubits, const FixedGate<2> &gate)
+{
+    const size_t qubit_n = state.qubit_num();
+    if (qubits[0] >= qubit_n || qubits[1] >= qubit_n || qubits[0] == qubits[1])
+        throw std::invalid_argument("Invalid qubits for a two qubit gate!");
+
+    const size_t bit0 = qubit_n - 1 - qubits[0], bit1 = qubit_n - 1 - qubits[1];
+    struct Job
+    {
+        std::complex<double> *amp;
+        const FixedGate<2> &gate;
+        size_t low_bit;
+        size_t high_bit;
+        size_t stride0;
+        size_t stride1;
+    } job{state.data(), gate, std::min(bit0, bit1), std::max(bit0, bit1),
+          static_cast<size_t>(1) << bit0, static_cast<size_t>(1) << bit1};
+
+    parallel_for(0, state.size() >> 2, [&job](size_t begin, size_t end)
+    {
+        const FixedComplex *m = job.gate.entries;
+        std::complex<double> *amp = job.amp;
+
+        for (size_t k = begin; k < end; k++)
+        {
+            const size_t i0 = insert_zero_bit(insert_zero_bit(k, job.low_bit), job.high_bit);
+            const size_t i1 = i0 + job.stride1, i2 = i0 + job.stride0, i3 = i2 + job.stride1;
+            const std::complex<double> a0 = amp[i0], a1 = amp[i1], a2 = amp[i2], a3 = amp[i3];
+
+            amp[i0] = fixed_multiply(m[0], a0) + fixed_multiply(m[1], a1) + fixed_multiply(m[2], a2) + fixed_multiply(m[3], a3);
+            amp[i1] = fixed_multiply(m[4], a0) + fixed_multiply(m[5], a1) + fixed_multiply(m[6], a2) + fixed_multiply(m[7], a3);
+            amp[i2] = fixed_multiply(m[8], a0) + fixed_multiply(m[9], a1) + fixed_multiply(m[10], a2) + fixed_multiply(m[11], a3);
+            amp[i3] = fixed_multiply(m[12], a0) + fixed_multiply(m[13], a1) + fixed_multiply(m[14], a2) + fixed_multiply(m[15], a3);
+        }
+    });
+}
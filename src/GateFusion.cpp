@@ -0,0 +1,182 @@
+#include "../include/QuantumCircuit.hpp"
+#include <iterator>
+
+/*
+Gate fusion.
+Every gate applied by evolve() streams the whole statevector through memory once, so merging gates
+before the simulation reduces the number of passes.
+
+Stage 1: single qubit gates on the same qubit are multiplied into one 2x2 gate. Gates on different
+qubits commute, so the product for a qubit is only flushed when a multi-qubit gate (CNOT, Swap, ...)
+touches that qubit, or at the end of the circuit. Products equal to the identity (H H, X X, ...) are dropped.
+
+Stage 2: neighbouring gates whose qubits together fit into max_block_qubits are merged into one dense
+block. The block matrix is obtained by applying its gates to every basis state of the block qubits.
+*/
+
+// A fused 2x2 gate closer than this to the identity is dropped.
+static const double FUSION_IDENTITY_TOLERANCE = 1e-12;
+
+static bool is_identity_core(const QuantumGate &core)
+{
+    return std::abs(core(1, 1) - 1.0) < FUSION_IDENTITY_TOLERANCE &&
+           std::abs(core(1, 2)) < FUSION_IDENTITY_TOLERANCE &&
+           std::abs(core(2, 1)) < FUSION_IDENTITY_TOLERANCE &&
+           std::abs(core(2, 2) - 1.0) < FUSION_IDENTITY_TOLERANCE;
+}
+
+// Build the dense matrix of the gates, which all act on a subset of block_qubits (sorted).
+static QuantumGate block_matrix(const std::vector<GateOp> &gates, const std::vector<QuantumGate> &matrices,
+                                const std::vector<size_t> &block_qubits)
+{
+    const size_t block = static_cast<size_t>(1) << block_qubits.size();
+
+    // Rewrite the targets relative to the block, e.g. block {2, 5}: qubit 5 becomes local qubit 1
+    std::vector<GateOp> local_gates = gates;
+    for (auto it = local_gates.begin(); it != local_gates.end(); it++)
+    {
+        for (size_t j = 0; j < it->qubit_count; j++)
+        {
+            size_t pos = std::lower_bound(block_qubits.begin(), block_qubits.end(), it->qubits[j]) - block_qubits.begin();
+            it->qubits[j] = static_cast<uint32_t>(pos);
+        }
+    }
+
+    QuantumGate result(block);
+    for (size_t col = 0; col < block; col++)
+    {
+        Statevector column(block_qubits.size());
+        column[col] = 1;
+        for (auto it = local_gates.begin(); it != local_gates.end(); it++)
+        {
+            apply_gate(column, *it, matrices);
+        }
+        for (size_t row = 0; row < block; row++)
+        {
+            result(row + 1, col + 1) = column[row];
+        }
+    }
+
+    return result;
+}
+
+// Copy a gate into another circuit, its matrix (if any) is moved to the matrix table of the target
+static GateOp copy_gate(const GateOp &op, const std::vector<QuantumGate> &from, std::vector<QuantumGate> &to)
+{
+    if (op.code != GateCode::Matrix)
+        return op;
+    GateOp copy = op;
+    copy.matrix = static_cast<uint32_t>(to.size());
+    to.push_back(from[op.matrix]);
+    return copy;
+}
+
+QuantumCircuit QuantumCircuit::fuse_gates(size_t max_block_qubits, FusionStats *stats) const
+{
+    if (max_block_qubits > GateOp::MAX_QUBITS)
+        throw std::invalid_argument("A fused block can have at most 6 qubits!");
+
+    // Stage 1: multiply consecutive single qubit gates on each qubit
+    std::vector<GateOp> single_fused;
+    std::vector<QuantumGate> single_matrices;
+    std::vector<GateOp> pending_gate(qubit_n);
+    std::vector<QuantumGate> pending(qubit_n);
+    std::vector<size_t> pending_count(qubit_n, 0);
+
+    auto flush = [&](size_t q)
+    {
+        if (pending_count[q] == 0)
+            return;
+        // A single gate keeps its code, so evolve() can still pick the permutation or diagonal kernel
+        if (pending_count[q] == 1)
+            single_fused.push_back(copy_gate(pending_gate[q], matrices, single_matrices));
+        else if (!is_identity_core(pending[q]))
+            single_fused.push_back(make_gate_op({q}, pending[q], single_matrices));
+        pending_count[q] = 0;
+    };
+
+    for (auto it = gates.begin(); it != gates.end(); it++)
+    {
+        if (it->qubit_count == 1)
+        {
+            const size_t q = it->qubits[0];
+            // The later gate multiplies from the left
+            if (pending_count[q] == 0)
+            {
+                pending_gate[q] = *it;
+                pending[q] = gate_core(*it, matrices);
+            }
+            else
+                pending[q] = gate_core(*it, matrices) * pending[q];
+            pending_count[q]++;
+        }
+        else
+        {
+            for (size_t j = 0; j < it->qubit_count; j++)
+            {
+                flush(it->qubits[j]);
+            }
+            single_fused.push_back(copy_gate(*it, matrices, single_matrices));
+        }
+    }
+    for (size_t q = 0; q < qubit_n; q++)
+    {
+        flush(q);
+    }
+
+    QuantumCircuit fused{qubit_n};
+
+    // Stage 2: merge neighbouring gates into blocks of at most max_block_qubits qubits
+    if (max_block_qubits <= 1)
+    {
+        fused.gates = single_fused;
+        fused.matrices = single_matrices;
+    }
+    else
+    {
+        std::vector<GateOp> block_gates;
+        std::vector<size_t> block_qubits;
+
+        auto emit_block = [&]()
+        {
+            if (block_gates.size() == 1)
+                fused.gates.push_back(copy_gate(block_gates[0], single_matrices, fused.matrices));
+            else if (block_gates.size() > 1)
+                fused.gates.push_back(make_gate_op(block_qubits, block_matrix(block_gates, single_matrices, block_qubits), fused.matrices));
+            block_gates.clear();
+            block_qubits.clear();
+        };
+
+        for (auto it = single_fused.begin(); it != single_fused.end(); it++)
+        {
+            std::vector<size_t> op_qubits = gate_qubits(*it);
+            std::sort(op_qubits.begin(), op_qubits.end());
+
+            std::vector<size_t> merged_qubits;
+            std::set_union(block_qubits.begin(), block_qubits.end(), op_qubits.begin(), op_qubits.end(),
+                           std::back_inserter(merged_qubits));
+
+            if (merged_qubits.size() > max_block_qubits)
+            {
+                emit_block();
+                merged_qubits = op_qubits;
+            }
+            block_gates.push_back(*it);
+            block_qubits = merged_qubits;
+        }
+        emit_block();
+    }
+
+    if (stats != nullptr)
+    {
+        stats->gates_in = gates.size();
+        stats->blocks_out = fused.gates.size();
+    }
+
+    return fused;
+}
+
+void FusionStats::display() const
+{
+    std::cout << "Gate fusion: " << gates_in << " gates -> " << blocks_out << " fused blocks" << std::endl;
+}
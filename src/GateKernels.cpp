@@ -0,0 +1,576 @@
+#include "../include/GateKernels.hpp"
+
+void apply_single_qubit_gate(Statevector &state, size_t qubit, const QuantumGate &core)
+{
+    if (core.get_rows() != 2 || core.get_cols() != 2)
+        throw std::invalid_argument("A single qubit gate core must be a 2x2 matrix!");
+    if (qubit >= state.qubit_num())
+        throw std::invalid_argument("Target qubit is out of range!");
+
+    const std::complex<double> m00 = core(1, 1), m01 = core(1, 2);
+    const std::complex<double> m10 = core(2, 1), m11 = core(2, 2);
+
+    const size_t stride = qubit_stride(state.qubit_num(), qubit);
+    const size_t bit = state.qubit_num() - 1 - qubit;
+    std::complex<double> *amp = state.data();
+
+    // k enumerates the amplitude pairs, i is the index of the first amplitude of pair k.
+    parallel_for(0, state.size() / 2, [=](size_t begin, size_t end)
+    {
+        for (size_t k = begin; k < end; k++)
+        {
+            const size_t i = insert_zero_bit(k, bit);
+            const std::complex<double> a0 = amp[i];
+            const std::complex<double> a1 = amp[i + stride];
+            amp[i] = m00 * a0 + m01 * a1;
+            amp[i + stride] = m10 * a0 + m11 * a1;
+        }
+    });
+}
+
+// Low bits of the chunks in which the butterflies of the Hadamard and Fourier transforms stay in the cache (64 KB)
+static const size_t TRANSFORM_BLOCK_BITS = 12;
+// High bits of the Hadamard and Fourier transforms done per pass
+static const size_t TRANSFORM_RADIX_BITS = 4;
+
+size_t apply_hadamard_layer(Statevector &state, const std::vector<size_t> &qubits)
+{
+    const size_t qubit_n = state.qubit_num();
+
+    // H H = I, so a qubit listed twice cancels
+    std::vector<size_t> bits;
+    for (auto q = qubits.begin(); q != qubits.end(); q++)
+    {
+        if (*q >= qubit_n)
+            throw std::invalid_argument("Target qubit is out of range!");
+        auto found = std::find(bits.begin(), bits.end(), qubit_n - 1 - *q);
+        if (found != bits.end())
+            bits.erase(found);
+        else
+            bits.push_back(qubit_n - 1 - *q);
+    }
+    if (bits.empty())
+        return 0;
+    std::sort(bits.begin(), bits.end());
+
+    const size_t block_bits = std::min(TRANSFORM_BLOCK_BITS, qubit_n);
+    std::vector<size_t> low_bits, high_bits;
+    for (auto bit = bits.begin(); bit != bits.end(); bit++)
+        (*bit < block_bits ? low_bits : high_bits).push_back(*bit);
+
+    // The butterflies are not normalised, the first pass multiplies by 2^(-k/2)
+    const double scale = std::pow(M_SQRT1_2, static_cast<double>(bits.size()));
+    std::complex<double> *amp = state.data();
+    size_t passes = 0;
+
+    if (!low_bits.empty())
+    {
+        const size_t chunk = static_cast<size_t>(1) << block_bits;
+        parallel_for(0, state.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t chunk_base = begin; chunk_base < end; chunk_base += chunk)
+            {
+                std::complex<double> *a = amp + chunk_base;
+                for (auto bit = low_bits.begin(); bit != low_bits.end(); bit++)
+                {
+                    const size_t stride = static_cast<size_t>(1) << *bit;
+                    for (size_t i0 = 0; i0 < chunk; i0 += 2 * stride)
+                    {
+                        for (size_t i = i0; i < i0 + stride; i++)
+                        {
+                            const std::complex<double> a0 = a[i], a1 = a[i + stride];
+                            a[i] = a0 + a1;
+                            a[i + stride] = a0 - a1;
+                        }
+                    }
+                }
+                for (size_t i = 0; i < chunk; i++)
+                    a[i] *= scale;
+            }
+        }, chunk);
+        passes++;
+    }
+
+    for (size_t first = 0; first < high_bits.size(); first += TRANSFORM_RADIX_BITS)
+    {
+        const size_t r = std::min(TRANSFORM_RADIX_BITS, high_bits.size() - first);
+        const size_t block = static_cast<size_t>(1) << r;
+        const double factor = passes == 0 ? scale : 1.0;
+
+        // Local bit l of a group is the bit high_bits[first + l] of the index
+        std::vector<size_t> offsets(block, 0);
+        for (size_t j = 0; j < block; j++)
+            for (size_t l = 0; l < r; l++)
+                if ((j >> l) & 1)
+                    offsets[j] |= static_cast<size_t>(1) << high_bits[first + l];
+
+        parallel_for(0, state.size() >> r, [&](size_t begin, size_t end)
+        {
+            std::complex<double> in[static_cast<size_t>(1) << TRANSFORM_RADIX_BITS];
+            for (size_t g = begin; g < end; g++)
+            {
+                size_t base = g;
+                for (size_t l = 0; l < r; l++)
+                    base = insert_zero_bit(base, high_bits[first + l]);
+
+                for (size_t j = 0; j < block; j++)
+                    in[j] = amp[base + offsets[j]];
+                for (size_t stride = 1; stride < block; stride <<= 1)
+                {
+                    for (size_t i0 = 0; i0 < block; i0 += 2 * stride)
+                    {
+                        for (size_t i = i0; i < i0 + stride; i++)
+                        {
+                            const std::complex<double> a0 = in[i], a1 = in[i + stride];
+                            in[i] = a0 + a1;
+                            in[i + stride] = a0 - a1;
+                        }
+                    }
+                }
+                for (size_t j = 0; j < block; j++)
+                    amp[base + offsets[j]] = in[j] * factor;
+            }
+        });
+        passes++;
+    }
+
+    return passes;
+}
+
+// The lowest `width` bits of x in reverse order
+static size_t reverse_bits(uint64_t x, size_t width)
+{
+    x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+    x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    x = ((x >> 8) & 0x00FF00FF00FF00FFULL) | ((x & 0x00FF00FF00FF00FFULL) << 8);
+    x = ((x >> 16) & 0x0000FFFF0000FFFFULL) | ((x & 0x0000FFFF0000FFFFULL) << 16);
+    x = (x >> 32) | (x << 32);
+    return static_cast<size_t>(x >> (64 - width));
+}
+
+/*
+Twiddle factors w^t = e^{±2 pi i t / M} for t < M / 2, from two tables of about sqrt(M) entries:
+w^t = coarse[t >> fine_bits] * fine[t & fine_mask].
+*/
+struct FourierTwiddles
+{
+    size_t fine_bits;
+    std::vector<std::complex<double>> fine;
+    std::vector<std::complex<double>> coarse;
+
+    FourierTwiddles(size_t m, bool inverse) :
+    fine_bits(m / 2), fine(static_cast<size_t>(1) << (m / 2)), coarse(static_cast<size_t>(1) << (m - 1 - std::min(m / 2, m - 1)))
+    {
+        const double angle = (inverse ? -2.0 : 2.0) * M_PI / static_cast<double>(static_cast<size_t>(1) << m);
+        for (size_t t = 0; t < fine.size(); t++)
+            fine[t] = std::polar(1.0, angle * static_cast<double>(t));
+        for (size_t c = 0; c < coarse.size(); c++)
+            coarse[c] = std::polar(1.0, angle * static_cast<double>(c << fine_bits));
+    }
+
+    std::complex<double> operator()(size_t t) const
+    {
+        // The products are written out, std::complex multiplication checks for infinities and NaNs
+        const std::complex<double> c = coarse[t >> fine_bits], f = fine[t & ((static_cast<size_t>(1) << fine_bits) - 1)];
+        return {c.real() * f.real() - c.imag() * f.imag(), c.real() * f.imag() + c.imag() * f.real()};
+    }
+};
+
+// a0, a1 <- a0 + w a1, a0 - w a1
+static inline void fourier_butterfly(std::complex<double> &a0, std::complex<double> &a1, std::complex<double> w)
+{
+    const std::complex<double> v{a1.real() * w.real() - a1.imag() * w.imag(), a1.real() * w.imag() + a1.imag() * w.real()};
+    a1 = a0 - v;
+    a0 += v;
+}
+
+void apply_fourier_transform(Statevector &state, size_t first_qubit, size_t qubit_count, bool inverse)
+{
+    const size_t qubit_n = state.qubit_num();
+    if (qubit_count == 0 || first_qubit + qubit_count > qubit_n)
+        throw std::invalid_argument("The qubits of the Fourier transform are out of range!");
+
+    const size_t m = qubit_count;
+    const size_t low = qubit_n - first_qubit - m; // bit of the least significant qubit of the register
+    const size_t stride = static_cast<size_t>(1) << low;
+    const size_t register_mask = (static_cast<size_t>(1) << m) - 1;
+    const double scale = 1.0 / std::sqrt(static_cast<double>(static_cast<size_t>(1) << m));
+    const FourierTwiddles twiddles(m, inverse);
+    std::complex<double> *amp = state.data();
+
+    // 1. Bit reversal of the register value, row by row (a row is the stride amplitudes with the same index above low)
+    parallel_for(0, state.size() >> low, [&](size_t begin, size_t end)
+    {
+        for (size_t row = begin; row < end; row++)
+        {
+            const size_t x = row & register_mask;
+            const size_t r = reverse_bits(x, m);
+            if (x > r)
+                continue;
+            std::complex<double> *a = amp + (row << low);
+            if (x == r)
+            {
+                for (size_t lo = 0; lo < stride; lo++)
+                    a[lo] *= scale;
+                continue;
+            }
+            // The partner row is exchanged by the lower of the two
+            std::complex<double> *b = amp + ((row ^ x ^ r) << low);
+            for (size_t lo = 0; lo < stride; lo++)
+            {
+                const std::complex<double> t = a[lo];
+                a[lo] = b[lo] * scale;
+                b[lo] = t * scale;
+            }
+        }
+    });
+
+    // 2. The stages s with pairs inside a chunk of 2^block_bits amplitudes, in one pass chunk by chunk
+    const size_t block_bits = std::min(TRANSFORM_BLOCK_BITS, qubit_n);
+    const size_t local_stages = low < block_bits ? std::min(m, block_bits - low) : 0;
+    if (local_stages > 0)
+    {
+        const size_t chunk = static_cast<size_t>(1) << block_bits;
+        parallel_for(0, state.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t chunk_base = begin; chunk_base < end; chunk_base += chunk)
+            {
+                std::complex<double> *a = amp + chunk_base;
+                for (size_t s = 0; s < local_stages; s++)
+                {
+                    const size_t half = stride << s;
+                    for (size_t start = 0; start < chunk; start += 2 * half)
+                    {
+                        for (size_t j = 0; j < (static_cast<size_t>(1) << s); j++)
+                        {
+                            const std::complex<double> w = twiddles(j << (m - 1 - s));
+                            std::complex<double> *p = a + start + (j << low);
+                            for (size_t lo = 0; lo < stride; lo++)
+                                fourier_butterfly(p[lo], p[lo + half], w);
+                        }
+                    }
+                }
+            }
+        }, chunk);
+    }
+
+    /*
+    3. The other stages TRANSFORM_RADIX_BITS at a time: the amplitudes that differ in the bits of the stages
+    (consecutive bits from low + first) are gathered, transformed locally and written back in one pass.
+    */
+    for (size_t first = local_stages; first < m; first += TRANSFORM_RADIX_BITS)
+    {
+        const size_t r = std::min(TRANSFORM_RADIX_BITS, m - first);
+        const size_t bit = low + first;
+        const size_t block = static_cast<size_t>(1) << r;
+
+        /*
+        The twiddle of stage first + l for the local index u is w^((x_low + (u mod 2^l) 2^first) 2^(m-1-s)),
+        x_low being the register bits below the first stage. The factor of u mod 2^l is the same for every
+        group (local_twiddles[2^l + v]), the factor of x_low is computed once per group and stage.
+        */
+        std::vector<std::complex<double>> local_twiddles(block);
+        for (size_t l = 0; l < r; l++)
+            for (size_t v = 0; v < (static_cast<size_t>(1) << l); v++)
+                local_twiddles[(static_cast<size_t>(1) << l) + v] = twiddles((v << first) << (m - 1 - first - l));
+
+        parallel_for(0, state.size() >> r, [&](size_t begin, size_t end)
+        {
+            std::complex<double> in[static_cast<size_t>(1) << TRANSFORM_RADIX_BITS];
+            std::complex<double> w[static_cast<size_t>(1) << TRANSFORM_RADIX_BITS];
+            for (size_t g = begin; g < end; g++)
+            {
+                const size_t base = ((g >> bit) << (bit + r)) | (g & ((static_cast<size_t>(1) << bit) - 1));
+                const size_t x_low = (base >> low) & ((static_cast<size_t>(1) << first) - 1);
+                for (size_t l = 0; l < r; l++)
+                {
+                    const std::complex<double> group_w = twiddles(x_low << (m - 1 - first - l));
+                    for (size_t v = (static_cast<size_t>(1) << l); v < (static_cast<size_t>(2) << l); v++)
+                        w[v] = {group_w.real() * local_twiddles[v].real() - group_w.imag() * local_twiddles[v].imag(),
+                                group_w.real() * local_twiddles[v].imag() + group_w.imag() * local_twiddles[v].real()};
+                }
+
+                for (size_t u = 0; u < block; u++)
+                    in[u] = amp[base + (u << bit)];
+                for (size_t l = 0; l < r; l++)
+                {
+                    const size_t pair = static_cast<size_t>(1) << l;
+                    for (size_t start = 0; start < block; start += 2 * pair)
+                        for (size_t v = 0; v < pair; v++)
+                            fourier_butterfly(in[start + v], in[start + v + pair], w[pair + v]);
+                }
+                for (size_t u = 0; u < block; u++)
+                    amp[base + (u << bit)] = in[u];
+            }
+        });
+    }
+}
+
+void apply_pauli_x(Statevector &state, size_t qubit)
+{
+    if (qubit >= state.qubit_num())
+        throw std::invalid_argument("Target qubit is out of range!");
+
+    const size_t stride = qubit_stride(state.qubit_num(), qubit);
+    const size_t bit = state.qubit_num() - 1 - qubit;
+    std::complex<double> *amp = state.data();
+
+    parallel_for(0, state.size() / 2, [=](size_t begin, size_t end)
+    {
+        for (size_t k = begin; k < end; k++)
+        {
+            const size_t i = insert_zero_bit(k, bit);
+            std::swap(amp[i], amp[i + stride]);
+        }
+    });
+}
+
+void apply_cnot(Statevector &state, size_t control_qubit, size_t target_qubit)
+{
+    const size_t qubit_n = state.qubit_num();
+    if (control_qubit >= qubit_n || target_qubit >= qubit_n || control_qubit == target_qubit)
+        throw std::invalid_argument("Invalid control and target qubits for CNOT!");
+
+    const size_t control_bit = qubit_n - 1 - control_qubit;
+    const size_t target_bit = qubit_n - 1 - target_qubit;
+    const size_t control_mask = static_cast<size_t>(1) << control_bit;
+    const size_t target_mask = static_cast<size_t>(1) << target_bit;
+    // Insert the lower bit first so that the higher bit position is still valid afterwards.
+    const size_t low_bit = std::min(control_bit, target_bit);
+    const size_t high_bit = std::max(control_bit, target_bit);
+    std::complex<double> *amp = state.data();
+
+    // Each k enumerates one index with both bits 0, a quarter of the statevector.
+    parallel_for(0, state.size() >> 2, [=](size_t begin, size_t end)
+    {
+        for (size_t k = begin; k < end; k++)
+        {
+            const size_t i = insert_zero_bit(insert_zero_bit(k, low_bit), high_bit) | control_mask;
+            std::swap(amp[i], amp[i | target_mask]);
+        }
+    });
+}
+
+void apply_swap(Statevector &state, size_t qubit1, size_t qubit2)
+{
+    const size_t qubit_n = state.qubit_num();
+    if (qubit1 >= qubit_n || qubit2 >= qubit_n || qubit1 == qubit2)
+        throw std::invalid_argument("Invalid qubits for Swap!");
+
+    const size_t bit1 = qubit_n - 1 - qubit1;
+    const size_t bit2 = qubit_n - 1 - qubit2;
+    const size_t mask1 = static_cast<size_t>(1) << bit1;
+    const size_t mask2 = static_cast<size_t>(1) << bit2;
+    const size_t low_bit = std::min(bit1, bit2);
+    const size_t high_bit = std::max(bit1, bit2);
+    std::complex<double> *amp = state.data();
+
+    parallel_for(0, state.size() >> 2, [=](size_t begin, size_t end)
+    {
+        for (size_t k = begin; k < end; k++)
+        {
+            const size_t i = insert_zero_bit(insert_zero_bit(k, low_bit), high_bit);
+            std::swap(amp[i | mask1], amp[i | mask2]);
+        }
+    });
+}
+
+void apply_controlled_phase(Statevector &state, size_t qubit1, size_t qubit2, std::complex<double> factor)
+{
+    const size_t qubit_n = state.qubit_num();
+    if (qubit1 >= qubit_n || qubit2 >= qubit_n || qubit1 == qubit2)
+        throw std::invalid_argument("Invalid qubits for the controlled phase!");
+
+    const size_t bit1 = qubit_n - 1 - qubit1;
+    const size_t bit2 = qubit_n - 1 - qubit2;
+    const size_t both_mask = (static_cast<size_t>(1) << bit1) | (static_cast<size_t>(1) << bit2);
+    const size_t low_bit = std::min(bit1, bit2);
+    const size_t high_bit = std::max(bit1, bit2);
+    std::complex<double> *amp = state.data();
+
+    // Each k enumerates one index with both bits 1, a quarter of the statevector.
+    parallel_for(0, state.size() >> 2, [=](size_t begin, size_t end)
+    {
+        for (size_t k = begin; k < end; k++)
+            amp[insert_zero_bit(insert_zero_bit(k, low_bit), high_bit) | both_mask] *= factor;
+    });
+}
+
+bool is_diagonal(const QuantumGate &core)
+{
+    return core.get_rows() == 2 && core.get_cols() == 2 &&
+           core(1, 2) == std::complex<double>(0, 0) && core(2, 1) == std::complex<double>(0, 0);
+}
+
+void apply_diagonal_gate(Statevector &state, size_t qubit, std::complex<double> d0, std::complex<double> d1)
+{
+    if (qubit >= state.qubit_num())
+        throw std::invalid_argument("Target qubit is out of range!");
+
+    const size_t mask = qubit_stride(state.qubit_num(), qubit);
+    const size_t bit = state.qubit_num() - 1 - qubit;
+    std::complex<double> *amp = state.data();
+
+    // Phase and Pauli Z leave the |0> half untouched, which saves half of the multiplications.
+    if (d0 == std::complex<double>(1, 0))
+    {
+        parallel_for(0, state.size() / 2, [=](size_t begin, size_t end)
+        {
+            for (size_t k = begin; k < end; k++)
+                amp[insert_zero_bit(k, bit) | mask] *= d1;
+        });
+    }
+    else
+    {
+        parallel_for(0, state.size(), [=](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+                amp[i] *= (i & mask) ? d1 : d0;
+        });
+    }
+}
+
+/*
+The merged factors are grouped into lookup tables of at most DIAGONAL_TABLE_BITS qubits.
+A table holds the product of the factors for every combination of its qubits' bits, so each amplitude
+needs one table lookup per group (gathering the bits is cheap integer work) instead of one complex
+multiplication per gate.
+*/
+static const size_t DIAGONAL_TABLE_BITS = 10;
+
+void apply_diagonal_gates(Statevector &state, const std::vector<DiagonalFactor> &factors)
+{
+    if (factors.empty())
+        return;
+
+    // Merge factors acting on the same qubit
+    std::map<size_t, DiagonalFactor> merged;
+    for (auto it = factors.begin(); it != factors.end(); it++)
+    {
+        if (it->qubit >= state.qubit_num())
+            throw std::invalid_argument("Target qubit is out of range!");
+
+        auto found = merged.find(it->qubit);
+        if (found == merged.end())
+        {
+            merged[it->qubit] = *it;
+        }
+        else
+        {
+            found->second.d0 *= it->d0;
+            found->second.d1 *= it->d1;
+        }
+    }
+
+    if (merged.size() == 1)
+    {
+        const DiagonalFactor &f = merged.begin()->second;
+        apply_diagonal_gate(state, f.qubit, f.d0, f.d1);
+        return;
+    }
+
+    // Build one lookup table per group of qubits
+    std::vector<std::vector<size_t>> group_bits;
+    std::vector<std::vector<std::complex<double>>> tables;
+    for (auto it = merged.begin(); it != merged.end(); it++)
+    {
+        if (group_bits.empty() || group_bits.back().size() == DIAGONAL_TABLE_BITS)
+        {
+            group_bits.push_back({});
+            tables.push_back({std::complex<double>(1, 0)});
+        }
+
+        std::vector<std::complex<double>> &table = tables.back();
+        const size_t old_size = table.size();
+        table.resize(2 * old_size);
+        for (size_t j = 0; j < old_size; j++)
+        {
+            table[old_size + j] = table[j] * it->second.d1;
+            table[j] *= it->second.d0;
+        }
+        group_bits.back().push_back(state.qubit_num() - 1 - it->first);
+    }
+
+    std::complex<double> *amp = state.data();
+
+    parallel_for(0, state.size(), [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            std::complex<double> factor{1.0, 0.0};
+            for (size_t g = 0; g < tables.size(); g++)
+            {
+                const std::vector<size_t> &bits = group_bits[g];
+                size_t j = 0;
+                for (size_t b = 0; b < bits.size(); b++)
+                    j |= ((i >> bits[b]) & 1) << b;
+                factor *= tables[g][j];
+            }
+            amp[i] *= factor;
+        }
+    });
+}
+
+void apply_multi_qubit_gate(Statevector &state, const std::vector<size_t> &qubits, const QuantumGate &matrix)
+{
+    const size_t qubit_n = state.qubit_num();
+    const size_t k = qubits.size();
+    const size_t block = static_cast<size_t>(1) << k;
+
+    if (matrix.get_rows() != block || matrix.get_cols() != block)
+        throw std::invalid_argument("The gate matrix does not match the number of target qubits!");
+
+    std::vector<size_t> sorted_bits;
+    for (auto q = qubits.begin(); q != qubits.end(); q++)
+    {
+        if (*q >= qubit_n)
+            throw std::invalid_argument("Target qubit is out of range!");
+        sorted_bits.push_back(qubit_n - 1 - *q);
+    }
+    std::sort(sorted_bits.begin(), sorted_bits.end());
+    if (std::adjacent_find(sorted_bits.begin(), sorted_bits.end()) != sorted_bits.end())
+        throw std::invalid_argument("The target qubits must be distinct!");
+
+    // offsets[j] is the position of local basis state j relative to the group's base index
+    std::vector<size_t> offsets(block, 0);
+    for (size_t j = 0; j < block; j++)
+    {
+        for (size_t l = 0; l < k; l++)
+        {
+            if (j & (static_cast<size_t>(1) << (k - 1 - l)))
+                offsets[j] |= static_cast<size_t>(1) << (qubit_n - 1 - qubits[l]);
+        }
+    }
+
+    // Copy the matrix once so the inner loop does not go through operator()
+    std::vector<std::complex<double>> m(block * block);
+    for (size_t r = 0; r < block; r++)
+        for (size_t c = 0; c < block; c++)
+            m[r * block + c] = matrix(r + 1, c + 1);
+
+    std::complex<double> *amp = state.data();
+
+    parallel_for(0, state.size() >> k, [&](size_t begin, size_t end)
+    {
+        std::vector<std::complex<double>> in(block);
+
+        for (size_t g = begin; g < end; g++)
+        {
+            size_t base = g;
+            for (size_t l = 0; l < k; l++)
+                base = insert_zero_bit(base, sorted_bits[l]);
+
+            for (size_t j = 0; j < block; j++)
+                in[j] = amp[base + offsets[j]];
+
+            for (size_t r = 0; r < block; r++)
+            {
+                std::complex<double> sum{0.0, 0.0};
+                for (size_t c = 0; c < block; c++)
+                    sum += m[r * block + c] * in[c];
+                amp[base + offsets[r]] = sum;
+            }
+        }
+    });
+}
@@ -0,0 +1,164 @@
+#include "../include/GateOp.hpp"
+#include "../include/GateKernels.hpp"
+#include "../include/QuantumGates/Phase.hpp"
+#include "../include/QuantumGates/ControlledPhase.hpp"
+
+// Number of qubits of the gates of each code, Matrix gates have any number
+static const size_t CODE_QUBITS[] = {1, 1, 1, 1, 1, 1, 2, 2, 2, 0};
+
+GateOp make_gate_op(GateCode code, std::initializer_list<size_t> qubits, double param)
+{
+    if (code == GateCode::Matrix)
+        throw std::invalid_argument("A Matrix gate needs its matrix!");
+    if (qubits.size() != CODE_QUBITS[static_cast<size_t>(code)])
+        throw std::invalid_argument("The number of target qubits does not match the gate!");
+
+    GateOp op{param, 0, {0}, code, static_cast<uint8_t>(qubits.size()), 0};
+    size_t j = 0;
+    for (auto q = qubits.begin(); q != qubits.end(); q++, j++)
+        op.qubits[j] = static_cast<uint32_t>(*q);
+    return op;
+}
+
+GateOp make_gate_op(const std::vector<size_t> &qubits, const QuantumGate &gate, std::vector<QuantumGate> &matrices)
+{
+    if (qubits.empty() || qubits.size() > GateOp::MAX_QUBITS)
+        throw std::invalid_argument("A gate acts on 1 to 6 qubits!");
+    if (gate.get_rows() != (size_t(1) << qubits.size()))
+        throw std::invalid_argument("The size of the gate does not match the number of target qubits!");
+
+    GateOp op{0.0, 0, {0}, GateCode::Matrix, static_cast<uint8_t>(qubits.size()), 0};
+    for (size_t j = 0; j < qubits.size(); j++)
+        op.qubits[j] = static_cast<uint32_t>(qubits[j]);
+
+    switch (gate.get_type())
+    {
+    case QuantumGate::Type::Hadamard:
+        op.code = GateCode::Hadamard;
+        break;
+    case QuantumGate::Type::PauliX:
+        op.code = GateCode::PauliX;
+        break;
+    case QuantumGate::Type::PauliY:
+        op.code = GateCode::PauliY;
+        break;
+    case QuantumGate::Type::PauliZ:
+        op.code = GateCode::PauliZ;
+        break;
+    case QuantumGate::Type::Identity:
+        op.code = GateCode::Identity;
+        break;
+    case QuantumGate::Type::Phase:
+        op.code = GateCode::Phase;
+        op.param = std::arg(gate(2, 2));
+        break;
+    case QuantumGate::Type::ControlledPhase:
+        op.code = GateCode::ControlledPhase;
+        op.param = std::arg(gate(4, 4));
+        break;
+    case QuantumGate::Type::CNOT:
+        op.code = GateCode::CNOT;
+        break;
+    case QuantumGate::Type::Swap:
+        op.code = GateCode::Swap;
+        break;
+    default:
+        break;
+    }
+
+    // The type of a full 2^n x 2^n gate does not describe its core, such gates are kept as matrices
+    if (op.code != GateCode::Matrix && CODE_QUBITS[static_cast<size_t>(op.code)] != qubits.size())
+        op.code = GateCode::Matrix;
+    if (op.code == GateCode::Matrix)
+    {
+        op.matrix = static_cast<uint32_t>(matrices.size());
+        matrices.push_back(gate);
+    }
+    return op;
+}
+
+std::vector<size_t> gate_qubits(const GateOp &op)
+{
+    return std::vector<size_t>(op.qubits, op.qubits + op.qubit_count);
+}
+
+QuantumGate::Type gate_type(const GateOp &op)
+{
+    switch (op.code)
+    {
+    case GateCode::Hadamard:
+        return QuantumGate::Type::Hadamard;
+    case GateCode::PauliX:
+        return QuantumGate::Type::PauliX;
+    case GateCode::PauliY:
+        return QuantumGate::Type::PauliY;
+    case GateCode::PauliZ:
+        return QuantumGate::Type::PauliZ;
+    case GateCode::Identity:
+        return QuantumGate::Type::Identity;
+    case GateCode::Phase:
+        return QuantumGate::Type::Phase;
+    case GateCode::ControlledPhase:
+        return QuantumGate::Type::ControlledPhase;
+    case GateCode::CNOT:
+        return QuantumGate::Type::CNOT;
+    case GateCode::Swap:
+        return QuantumGate::Type::Swap;
+    default:
+        return QuantumGate::Type::Custom;
+    }
+}
+
+QuantumGate gate_core(const GateOp &op, const std::vector<QuantumGate> &matrices)
+{
+    switch (op.code)
+    {
+    case GateCode::Hadamard:
+        return QuantumGate::Hadamard2x2;
+    case GateCode::PauliX:
+        return QuantumGate::PauliX;
+    case GateCode::PauliY:
+        return QuantumGate::PauliY;
+    case GateCode::PauliZ:
+        return QuantumGate::PauliZ;
+    case GateCode::Identity:
+        return QuantumGate::Identity2x2;
+    case GateCode::Phase:
+        return Phase{op.param};
+    case GateCode::ControlledPhase:
+        return ControlledPhase{op.param};
+    case GateCode::CNOT:
+        return QuantumGate::CNOT4x4;
+    case GateCode::Swap:
+        return QuantumGate::SWAP4x4;
+    default:
+        return matrices[op.matrix];
+    }
+}
+
+bool diagonal_factors(const GateOp &op, const std::vector<QuantumGate> &matrices, std::complex<double> &d0, std::complex<double> &d1)
+{
+    switch (op.code)
+    {
+    case GateCode::PauliZ:
+        d0 = 1.0;
+        d1 = -1.0;
+        return true;
+    case GateCode::Identity:
+        d0 = 1.0;
+        d1 = 1.0;
+        return true;
+    case GateCode::Phase:
+        d0 = 1.0;
+        d1 = std::polar(1.0, op.param);
+        return true;
+    case GateCode::Matrix:
+        if (op.qubit_count != 1 || !is_diagonal(matrices[op.matrix]))
+            return false;
+        d0 = matrices[op.matrix](1, 1);
+        d1 = matrices[op.matrix](2, 2);
+        return true;
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,292 @@
+#include "../include/QuantumCircuit.hpp"
+#include <cmath>
+
+/*
+Peephole optimisation.
+Generated circuits often contain gates that undo each other (H H, X X, CNOT CNOT, Swap Swap) or phase
+gates that can be added up, and every one of them costs a pass over the statevector.
+
+The circuit is swept once from left to right. For every qubit a stack holds the gates kept so far
+that act on it, the latest on top. An incoming gate looks down the stack of its first qubit for a
+partner: the same self-inverse gate on the same qubits (the pair cancels), or a phase gate on the same
+qubits (the angles are added). Gates it commutes with are skipped:
+
+    P(a) ──•── P(b)    =    P(a + b) ──•──        a phase commutes with the control of a CNOT
+           │                           │
+    ───────⊕──────          ───────────⊕──
+
+    ──•── P(c) ──•──    =    P(c)                  then the two CNOTs meet and cancel
+      │          │
+    ──⊕──────────⊕──    =    ────
+
+Two gates commute if on each of their common qubits both are diagonal (Z, Phase, controlled phase, the
+control of a CNOT) or both are bit flips (X, the target of a CNOT). A two qubit gate must reach its
+partner on both of its stacks. At most PEEPHOLE_WINDOW gates are skipped per stack, so a sweep is
+linear in the number of gates; sweeps are repeated until nothing changes.
+
+The gates of a Fourier block are kept as they are, so evolve() still replaces the block with the FFT.
+*/
+
+// Number of earlier gates on a qubit that an incoming gate can be moved past
+static const size_t PEEPHOLE_WINDOW = 32;
+// A merged phase closer than this to 0 (mod 2 pi) is dropped
+static const double PEEPHOLE_PHASE_TOLERANCE = 1e-12;
+
+struct PeepholeGate
+{
+    GateOp op;
+    size_t origin;  // index of the gate in the original circuit
+    bool locked;    // part of a Fourier block
+    bool removed;
+};
+
+enum class QubitRole
+{
+    Diagonal,
+    Flip,
+    Other
+};
+
+static QubitRole qubit_role(const GateOp &op, size_t q)
+{
+    switch (op.code)
+    {
+    case GateCode::PauliZ:
+    case GateCode::Phase:
+    case GateCode::Identity:
+    case GateCode::ControlledPhase:
+        return QubitRole::Diagonal;
+    case GateCode::PauliX:
+        return QubitRole::Flip;
+    case GateCode::CNOT:
+        return op.qubits[0] == q ? QubitRole::Diagonal : QubitRole::Flip;
+    default:
+        return QubitRole::Other;
+    }
+}
+
+static bool acts_on(const GateOp &op, size_t q)
+{
+    for (size_t j = 0; j < op.qubit_count; j++)
+        if (op.qubits[j] == q)
+            return true;
+    return false;
+}
+
+static bool commutes(const GateOp &a, const GateOp &b)
+{
+    for (size_t j = 0; j < b.qubit_count; j++)
+    {
+        const size_t q = b.qubits[j];
+        if (!acts_on(a, q))
+            continue;
+        const QubitRole role = qubit_role(a, q);
+        if (role == QubitRole::Other || role != qubit_role(b, q))
+            return false;
+    }
+    return true;
+}
+
+enum class PairKind
+{
+    None,
+    Cancel,
+    Merge
+};
+
+static bool same_pair(const GateOp &a, const GateOp &b)
+{
+    return (a.qubits[0] == b.qubits[0] && a.qubits[1] == b.qubits[1]) ||
+           (a.qubits[0] == b.qubits[1] && a.qubits[1] == b.qubits[0]);
+}
+
+// What an earlier gate and a later gate become when they meet
+static PairKind pair_kind(const GateOp &earlier, const GateOp &later)
+{
+    if (earlier.code == later.code)
+    {
+        switch (later.code)
+        {
+        case GateCode::Hadamard:
+        case GateCode::PauliX:
+        case GateCode::PauliY:
+        case GateCode::PauliZ:
+            return earlier.qubits[0] == later.qubits[0] ? PairKind::Cancel : PairKind::None;
+        case GateCode::CNOT:
+            return earlier.qubits[0] == later.qubits[0] && earlier.qubits[1] == later.qubits[1] ? PairKind::Cancel : PairKind::None;
+        case GateCode::Swap:
+            return same_pair(earlier, later) ? PairKind::Cancel : PairKind::None;
+        case GateCode::ControlledPhase:
+            return same_pair(earlier, later) ? PairKind::Merge : PairKind::None;
+        default:
+            break;
+        }
+    }
+
+    const bool earlier_phase = earlier.code == GateCode::Phase || earlier.code == GateCode::PauliZ;
+    const bool later_phase = later.code == GateCode::Phase || later.code == GateCode::PauliZ;
+    if (earlier_phase && later_phase && earlier.qubits[0] == later.qubits[0])
+        return PairKind::Merge;
+    return PairKind::None;
+}
+
+static double phase_angle(const GateOp &op)
+{
+    return op.code == GateCode::PauliZ ? M_PI : op.param;
+}
+
+// True if the gate at index can be reached from the top of the stack by skipping gates that commute with op
+static bool reachable(const std::vector<PeepholeGate> &out, const std::vector<size_t> &stack, size_t index, const GateOp &op)
+{
+    for (size_t k = 0; k < stack.size() && k <= PEEPHOLE_WINDOW; k++)
+    {
+        const size_t earlier = stack[stack.size() - 1 - k];
+        if (earlier == index)
+            return true;
+        if (out[earlier].locked || !commutes(out[earlier].op, op))
+            return false;
+    }
+    return false;
+}
+
+// The earlier gate that op cancels with or merges into, if it can be moved next to it
+static PairKind find_partner(const std::vector<PeepholeGate> &out, const std::vector<std::vector<size_t>> &stacks,
+                             const GateOp &op, size_t &partner)
+{
+    const std::vector<size_t> &stack = stacks[op.qubits[0]];
+    for (size_t k = 0; k < stack.size() && k <= PEEPHOLE_WINDOW; k++)
+    {
+        const PeepholeGate &earlier = out[stack[stack.size() - 1 - k]];
+        if (earlier.locked)
+            return PairKind::None;
+
+        const PairKind kind = pair_kind(earlier.op, op);
+        if (kind != PairKind::None)
+        {
+            for (size_t j = 1; j < op.qubit_count; j++)
+                if (!reachable(out, stacks[op.qubits[j]], stack[stack.size() - 1 - k], op))
+                    return PairKind::None;
+            partner = stack[stack.size() - 1 - k];
+            return kind;
+        }
+        if (!commutes(earlier.op, op))
+            return PairKind::None;
+    }
+    return PairKind::None;
+}
+
+// One sweep over the gates, returns true if anything was removed or merged
+static bool peephole_pass(std::vector<PeepholeGate> &gates, size_t qubit_n, OptimizationStats &stats)
+{
+    std::vector<PeepholeGate> out;
+    std::vector<std::vector<size_t>> stacks(qubit_n);
+    bool changed = false;
+
+    auto remove = [&](size_t index)
+    {
+        out[index].removed = true;
+        for (size_t j = 0; j < out[index].op.qubit_count; j++)
+        {
+            std::vector<size_t> &stack = stacks[out[index].op.qubits[j]];
+            stack.erase(std::find(stack.rbegin(), stack.rend(), index).base() - 1);
+        }
+    };
+
+    for (auto it = gates.begin(); it != gates.end(); it++)
+    {
+        if (!it->locked)
+        {
+            if (it->op.code == GateCode::Identity)
+            {
+                changed = true;
+                continue;
+            }
+
+            size_t partner = 0;
+            const PairKind kind = find_partner(out, stacks, it->op, partner);
+            if (kind == PairKind::Cancel)
+            {
+                remove(partner);
+                stats.cancelled_pairs++;
+                changed = true;
+                continue;
+            }
+            if (kind == PairKind::Merge)
+            {
+                // The merged angle stays at the place of the earlier gate, reduced to (-pi, pi]
+                GateOp &merged = out[partner].op;
+                const double angle = std::remainder(phase_angle(merged) + phase_angle(it->op), 2.0 * M_PI);
+                if (merged.code == GateCode::PauliZ)
+                    merged.code = GateCode::Phase;
+                merged.param = angle;
+                if (std::abs(angle) < PEEPHOLE_PHASE_TOLERANCE)
+                    remove(partner);
+                stats.merged_phases++;
+                changed = true;
+                continue;
+            }
+        }
+
+        out.push_back(*it);
+        for (size_t j = 0; j < it->op.qubit_count; j++)
+            stacks[it->op.qubits[j]].push_back(out.size() - 1);
+    }
+
+    gates.clear();
+    for (auto it = out.begin(); it != out.end(); it++)
+    {
+        if (!it->removed)
+            gates.push_back(*it);
+    }
+    stats.passes++;
+    return changed;
+}
+
+QuantumCircuit QuantumCircuit::optimize_gates(OptimizationStats *stats) const
+{
+    std::vector<PeepholeGate> kept;
+    for (size_t g = 0; g < gates.size(); g++)
+        kept.push_back({gates[g], g, false, false});
+    for (auto block = fourier_blocks.begin(); block != fourier_blocks.end(); block++)
+        for (size_t g = block->first_gate; g < block->first_gate + block->gate_count; g++)
+            kept[g].locked = true;
+
+    OptimizationStats local_stats;
+    local_stats.gates_in = gates.size();
+    bool changed = true;
+    while (changed)
+        changed = peephole_pass(kept, qubit_n, local_stats);
+    local_stats.gates_out = kept.size();
+
+    QuantumCircuit optimized{qubit_n};
+    optimized.matrices = matrices;
+    for (auto it = kept.begin(); it != kept.end(); it++)
+        optimized.gates.push_back(it->op);
+
+    // The Fourier blocks are kept whole, only their first index moves
+    for (auto block = fourier_blocks.begin(); block != fourier_blocks.end(); block++)
+    {
+        FourierBlock moved = *block;
+        for (size_t g = 0; g < kept.size(); g++)
+        {
+            if (kept[g].origin == block->first_gate)
+            {
+                moved.first_gate = g;
+                break;
+            }
+        }
+        optimized.fourier_blocks.push_back(moved);
+    }
+
+    if (stats != nullptr)
+        *stats = local_stats;
+
+    return optimized;
+}
+
+void OptimizationStats::display() const
+{
+    std::cout << "Peephole optimisation: " << gates_in << " gates -> " << gates_out << " gates ("
+              << cancelled_pairs << " cancelled pairs, " << merged_phases << " merged phases, "
+              << passes << " passes)" << std::endl;
+}
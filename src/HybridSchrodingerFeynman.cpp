@@ -0,0 +1,308 @@
+#include "../include/HybridSchrodingerFeynman.hpp"
+#include "../include/MatrixProductState.hpp"
+#include <algorithm>
+
+// Schmidt terms below this fraction of the largest singular value are dropped
+static const double SCHMIDT_CUTOFF = 1e-12;
+// Upper bound of the number of paths, beyond it the run would not finish anyway
+static const double MAX_PATHS = 1e12;
+
+static const QuantumGate PROJECTOR_0{QuantumGate::Type::Custom, 2, {1, 0, 0, 0}};
+static const QuantumGate PROJECTOR_1{QuantumGate::Type::Custom, 2, {0, 0, 0, 1}};
+static const std::complex<double> HALF = 0.5;
+static const QuantumGate HALF_IDENTITY{QuantumGate::Type::Custom, 2, {0.5, 0, 0, 0.5}};
+
+// Apply a gate to one half with the matching kernel, an empty list of qubits is the identity
+static void apply_half_gate(Statevector &state, const std::vector<size_t> &qubits, const QuantumGate &gate)
+{
+    if (qubits.empty())
+        return;
+
+    if (gate.get_rows() == 2)
+    {
+        if (gate.get_type() == QuantumGate::Type::PauliX)
+            apply_pauli_x(state, qubits[0]);
+        else if (is_diagonal(gate))
+            apply_diagonal_gate(state, qubits[0], gate(1, 1), gate(2, 2));
+        else
+            apply_single_qubit_gate(state, qubits[0], gate);
+    }
+    else if (gate.get_type() == QuantumGate::Type::CNOT)
+        apply_cnot(state, qubits[0], qubits[1]);
+    else if (gate.get_type() == QuantumGate::Type::Swap)
+        apply_swap(state, qubits[0], qubits[1]);
+    else
+        apply_multi_qubit_gate(state, qubits, gate);
+}
+
+// The statevector of a basis state given as a string of binary digits
+static Statevector basis_statevector(const std::string &bits)
+{
+    Statevector state(bits.length());
+    size_t index = 0;
+    for (auto it = bits.begin(); it != bits.end(); it++)
+        index = (index << 1) | size_t(*it - '0');
+    state[index] = 1.0;
+    return state;
+}
+
+HybridSchrodingerFeynman::HybridSchrodingerFeynman(size_t qubit_n_) :
+HybridSchrodingerFeynman(qubit_n_, std::string(qubit_n_, '0'))
+{
+}
+
+HybridSchrodingerFeynman::HybridSchrodingerFeynman(size_t qubit_n_, const std::string &basis_state, size_t cut_) :
+qubit_n(qubit_n_), cut(cut_ == 0 ? qubit_n_ / 2 : cut_), initial_state(basis_state)
+{
+    if (qubit_n < 2)
+        throw std::invalid_argument("The hybrid simulator needs at least two qubits!");
+    if (cut >= qubit_n)
+        throw std::invalid_argument("The cut must leave at least one qubit on each side!");
+    if (basis_state.length() != qubit_n)
+        throw std::invalid_argument("The length of the state must be equal to the number of qubits!");
+    for (auto it = basis_state.begin(); it != basis_state.end(); it++)
+        if (*it != '0' && *it != '1')
+            throw std::invalid_argument("The state can only contain binary digits!");
+}
+
+void HybridSchrodingerFeynman::add_gate(const std::vector<size_t> &qubits, const QuantumGate &gate)
+{
+    const size_t k = qubits.size();
+    if (gate.get_rows() != (size_t(1) << k))
+        throw std::invalid_argument("The size of the gate does not match the number of target qubits!");
+
+    // Positions of the targets on each side of the cut, and their qubits within the half
+    std::vector<size_t> upper_positions, lower_positions, upper_qubits, lower_qubits;
+    for (size_t i = 0; i < k; i++)
+    {
+        if (qubits[i] >= qubit_n)
+            throw std::invalid_argument("The target qubit is out of range!");
+        if (std::find(qubits.begin(), qubits.begin() + i, qubits[i]) != qubits.begin() + i)
+            throw std::invalid_argument("The target qubits must be different!");
+        if (qubits[i] < cut)
+        {
+            upper_positions.push_back(i);
+            upper_qubits.push_back(qubits[i]);
+        }
+        else
+        {
+            lower_positions.push_back(i);
+            lower_qubits.push_back(qubits[i] - cut);
+        }
+    }
+
+    HybridGate hybrid;
+    hybrid.crossing = !upper_qubits.empty() && !lower_qubits.empty();
+    if (!hybrid.crossing)
+    {
+        if (lower_qubits.empty())
+            hybrid.upper.push_back(HalfGate{upper_qubits, gate});
+        else
+            hybrid.lower.push_back(HalfGate{lower_qubits, gate});
+    }
+    else if (gate.get_type() == QuantumGate::Type::CNOT)
+    {
+        // Control c, target t: |0><0|_c (x) I + |1><1|_c (x) X_t
+        const bool control_upper = qubits[0] < cut;
+        const std::vector<size_t> &control = control_upper ? upper_qubits : lower_qubits;
+        const std::vector<size_t> &target = control_upper ? lower_qubits : upper_qubits;
+        std::vector<HalfGate> control_terms{HalfGate{control, PROJECTOR_0}, HalfGate{control, PROJECTOR_1}};
+        std::vector<HalfGate> target_terms{HalfGate{{}, QuantumGate::Identity2x2}, HalfGate{target, QuantumGate::PauliX}};
+        hybrid.upper = control_upper ? control_terms : target_terms;
+        hybrid.lower = control_upper ? target_terms : control_terms;
+    }
+    else if (gate.get_type() == QuantumGate::Type::Swap)
+    {
+        // (I (x) I + X (x) X + Y (x) Y + Z (x) Z) / 2, the factor 1/2 goes to the upper half
+        hybrid.upper = {HalfGate{upper_qubits, HALF_IDENTITY}, HalfGate{upper_qubits, QuantumGate::PauliX * HALF},
+                        HalfGate{upper_qubits, QuantumGate::PauliY * HALF}, HalfGate{upper_qubits, QuantumGate::PauliZ * HALF}};
+        hybrid.lower = {HalfGate{{}, QuantumGate::Identity2x2}, HalfGate{lower_qubits, QuantumGate::PauliX},
+                        HalfGate{lower_qubits, QuantumGate::PauliY}, HalfGate{lower_qubits, QuantumGate::PauliZ}};
+    }
+    else
+    {
+        /*
+        Operator Schmidt decomposition: the entries M[r][c] are reshuffled into a matrix whose rows are
+        the (row, column) bits of the upper targets and whose columns are the ones of the lower targets.
+        Its SVD U S V^dagger gives the terms sqrt(s) U[:, j] (x) sqrt(s) conj(V[:, j]).
+        */
+        const size_t upper_k = upper_positions.size(), lower_k = lower_positions.size();
+        const size_t upper_dim = size_t(1) << upper_k, lower_dim = size_t(1) << lower_k;
+        const size_t rows = upper_dim * upper_dim, cols = lower_dim * lower_dim;
+        std::vector<std::complex<double>> reshuffled(rows * cols, 0.0);
+        for (size_t r = 0; r < gate.get_rows(); r++)
+            for (size_t c = 0; c < gate.get_cols(); c++)
+            {
+                size_t ru = 0, cu = 0, rl = 0, cl = 0;
+                for (auto p = upper_positions.begin(); p != upper_positions.end(); p++)
+                {
+                    ru = (ru << 1) | ((r >> (k - 1 - *p)) & 1);
+                    cu = (cu << 1) | ((c >> (k - 1 - *p)) & 1);
+                }
+                for (auto p = lower_positions.begin(); p != lower_positions.end(); p++)
+                {
+                    rl = (rl << 1) | ((r >> (k - 1 - *p)) & 1);
+                    cl = (cl << 1) | ((c >> (k - 1 - *p)) & 1);
+                }
+                reshuffled[(ru * upper_dim + cu) * cols + rl * lower_dim + cl] = gate(r + 1, c + 1);
+            }
+
+        std::vector<std::complex<double>> u, v;
+        std::vector<double> s;
+        singular_value_decomposition(reshuffled, rows, cols, u, s, v);
+        const size_t rank = s.size();
+        for (size_t j = 0; j < rank && s[j] > SCHMIDT_CUTOFF * s[0]; j++)
+        {
+            const double scale = std::sqrt(s[j]);
+            QuantumGate upper_term(upper_dim), lower_term(lower_dim);
+            for (size_t r = 0; r < upper_dim; r++)
+                for (size_t c = 0; c < upper_dim; c++)
+                    upper_term(r + 1, c + 1) = scale * u[(r * upper_dim + c) * rank + j];
+            for (size_t r = 0; r < lower_dim; r++)
+                for (size_t c = 0; c < lower_dim; c++)
+                    lower_term(r + 1, c + 1) = scale * std::conj(v[(r * lower_dim + c) * rank + j]);
+            hybrid.upper.push_back(HalfGate{upper_qubits, upper_term});
+            hybrid.lower.push_back(HalfGate{lower_qubits, lower_term});
+        }
+    }
+    gates.push_back(hybrid);
+}
+
+size_t HybridSchrodingerFeynman::crossing_gate_num() const
+{
+    size_t count = 0;
+    for (auto it = gates.begin(); it != gates.end(); it++)
+        count += it->crossing ? 1 : 0;
+    return count;
+}
+
+double HybridSchrodingerFeynman::path_count() const
+{
+    double count = 1.0;
+    for (auto it = gates.begin(); it != gates.end(); it++)
+        if (it->crossing)
+            count *= it->upper.size();
+    return count;
+}
+
+void HybridSchrodingerFeynman::display_plan() const
+{
+    const double job_bytes = 16.0 * (std::ldexp(1.0, cut) + std::ldexp(1.0, qubit_n - cut));
+    std::cout << "Hybrid Schrödinger-Feynman: cut between qubits " << cut - 1 << " and " << cut << ", "
+              << crossing_gate_num() << " crossing gates, " << path_count() << " paths, "
+              << job_bytes << " bytes per job" << std::endl;
+}
+
+void HybridSchrodingerFeynman::run_paths(size_t begin, size_t end, const Statevector &upper_start, const Statevector &lower_start,
+                                         size_t first_crossing, const std::function<void(const Statevector &, const Statevector &)> &collect) const
+{
+    for (size_t path = begin; path < end; path++)
+    {
+        Statevector upper = upper_start, lower = lower_start;
+        // The digits of the path choose the terms, the first crossing gate is the least significant digit
+        size_t digits = path;
+        for (size_t g = first_crossing; g < gates.size(); g++)
+        {
+            const HybridGate &gate = gates[g];
+            size_t term = 0;
+            if (gate.crossing)
+            {
+                term = digits % gate.upper.size();
+                digits /= gate.upper.size();
+            }
+            if (term < gate.upper.size())
+                apply_half_gate(upper, gate.upper[term].qubits, gate.upper[term].gate);
+            if (term < gate.lower.size())
+                apply_half_gate(lower, gate.lower[term].qubits, gate.lower[term].gate);
+        }
+        collect(upper, lower);
+    }
+}
+
+std::vector<std::complex<double>> HybridSchrodingerFeynman::sum_over_paths(size_t result_n,
+    const std::function<void(const Statevector &, const Statevector &, std::vector<std::complex<double>> &)> &accumulate) const
+{
+    const double path_n = path_count();
+    if (path_n > MAX_PATHS)
+        throw std::invalid_argument("The cut is crossed by too many gates!");
+
+    // The gates before the first crossing gate are the same for all the paths
+    Statevector upper = basis_statevector(initial_state.substr(0, cut));
+    Statevector lower = basis_statevector(initial_state.substr(cut));
+    size_t first_crossing = 0;
+    for (; first_crossing < gates.size() && !gates[first_crossing].crossing; first_crossing++)
+    {
+        const HybridGate &gate = gates[first_crossing];
+        if (!gate.upper.empty())
+            apply_half_gate(upper, gate.upper[0].qubits, gate.upper[0].gate);
+        if (!gate.lower.empty())
+            apply_half_gate(lower, gate.lower[0].qubits, gate.lower[0].gate);
+    }
+
+    // One contiguous range of paths per job, the partial sums are added in a fixed order
+    const size_t paths = static_cast<size_t>(path_n);
+    const size_t job_n = std::min(get_thread_count(), paths);
+    std::vector<std::vector<std::complex<double>>> partial(job_n, std::vector<std::complex<double>>(result_n, 0.0));
+    auto job = [&](size_t j)
+    {
+        run_paths(j * paths / job_n, (j + 1) * paths / job_n, upper, lower, first_crossing,
+                  [&](const Statevector &u, const Statevector &l) { accumulate(u, l, partial[j]); });
+    };
+    // One job per thread of the global pool; the kernels inside the jobs stay serial, the jobs are the parallelism
+    parallel_for(0, job_n, [&](size_t begin, size_t end)
+    {
+        for (size_t j = begin; j < end; j++)
+            job(j);
+    }, 1, 1);
+
+    std::vector<std::complex<double>> result(result_n, 0.0);
+    for (auto it = partial.begin(); it != partial.end(); it++)
+        for (size_t i = 0; i < result_n; i++)
+            result[i] += (*it)[i];
+    return result;
+}
+
+std::vector<std::complex<double>> HybridSchrodingerFeynman::amplitudes(const std::vector<std::string> &bitstrings) const
+{
+    std::vector<size_t> upper_index, lower_index;
+    for (auto it = bitstrings.begin(); it != bitstrings.end(); it++)
+    {
+        if (it->length() != qubit_n)
+            throw std::invalid_argument("The length of the state must be equal to the number of qubits!");
+        size_t index = 0;
+        for (size_t q = 0; q < qubit_n; q++)
+        {
+            if ((*it)[q] != '0' && (*it)[q] != '1')
+                throw std::invalid_argument("The state can only contain binary digits!");
+            index = (index << 1) | size_t((*it)[q] - '0');
+        }
+        upper_index.push_back(index >> (qubit_n - cut));
+        lower_index.push_back(index & ((size_t(1) << (qubit_n - cut)) - 1));
+    }
+
+    return sum_over_paths(bitstrings.size(), [&](const Statevector &u, const Statevector &l, std::vector<std::complex<double>> &sum)
+    {
+        for (size_t i = 0; i < sum.size(); i++)
+            sum[i] += u[upper_index[i]] * l[lower_index[i]];
+    });
+}
+
+Statevector HybridSchrodingerFeynman::to_statevector() const
+{
+    if (qubit_n > 24)
+        throw std::invalid_argument("The statevector of more than 24 qubits is too large!");
+
+    const size_t lower_size = size_t(1) << (qubit_n - cut);
+    const std::vector<std::complex<double>> amplitudes = sum_over_paths(size_t(1) << qubit_n,
+        [&](const Statevector &u, const Statevector &l, std::vector<std::complex<double>> &sum)
+    {
+        for (size_t a = 0; a < u.size(); a++)
+            for (size_t b = 0; b < lower_size; b++)
+                sum[a * lower_size + b] += u[a] * l[b];
+    });
+
+    Statevector state(qubit_n);
+    for (size_t i = 0; i < amplitudes.size(); i++)
+        state[i] = amplitudes[i];
+    return state;
+}
@@ -0,0 +1,197 @@
+#include "../include/KroneckerOperator.hpp"
+#include <iterator>
+
+// Number of qubits of a 2^k x 2^k factor
+static size_t factor_qubit_num(const QuantumGate &factor)
+{
+    const size_t rows = factor.get_rows();
+    if (rows < 2 || rows != factor.get_cols() || (rows & (rows - 1)) != 0)
+        throw std::invalid_argument("The factors of a Kronecker operator must be 2^k x 2^k gates!");
+
+    size_t k = 0;
+    while ((static_cast<size_t>(1) << k) < rows)
+        k++;
+    return k;
+}
+
+static bool is_identity(const QuantumGate &factor)
+{
+    if (factor.is_sparse())
+    {
+        const SparseMatrix &m = *factor.get_sparse();
+        for (size_t i = 0; i < m.rows; i++)
+        {
+            if (m.row_start[i + 1] - m.row_start[i] != 1)
+                return false;
+            if (m.col_index[m.row_start[i]] != i || m.values[m.row_start[i]] != 1.0)
+                return false;
+        }
+        return true;
+    }
+
+    for (size_t i = 1; i <= factor.get_rows(); i++)
+        for (size_t j = 1; j <= factor.get_cols(); j++)
+            if (factor(i, j) != (i == j ? 1.0 : 0.0))
+                return false;
+    return true;
+}
+
+/*
+A sparse factor on the qubits offset .. offset + k - 1. The amplitudes are split into 2^(n-k) slices of
+2^k amplitudes that only differ in these qubits, each slice is gathered, multiplied and written back:
+
+    index = [ left (offset bits) | j (k bits) | right (n - offset - k bits) ]
+*/
+static void apply_sparse_factor(Statevector &state, size_t offset, size_t k, const SparseMatrix &m)
+{
+    const size_t qubit_n = state.qubit_num();
+    const size_t right_bits = qubit_n - offset - k;
+    const size_t right_mask = (static_cast<size_t>(1) << right_bits) - 1;
+    std::complex<double> *amp = state.data();
+
+    parallel_for(0, state.size() >> k, [&](size_t begin, size_t end)
+    {
+        std::vector<std::complex<double>> in(m.rows), out(m.rows);
+        for (size_t s = begin; s < end; s++)
+        {
+            const size_t base = ((s & ~right_mask) << k) | (s & right_mask);
+            for (size_t j = 0; j < m.rows; j++)
+                in[j] = amp[base + (j << right_bits)];
+            sparse_multiply(m, in.data(), out.data());
+            for (size_t j = 0; j < m.rows; j++)
+                amp[base + (j << right_bits)] = out[j];
+        }
+    });
+}
+
+/*
+Merge the factors between consecutive boundaries (qubit positions, 0 and n included) into one factor each.
+Every boundary must be a boundary between two factors.
+*/
+static std::vector<QuantumGate> merge_factors(const std::vector<QuantumGate> &factors, const std::vector<size_t> &factor_qubits,
+                                              const std::vector<size_t> &boundaries)
+{
+    std::vector<QuantumGate> merged;
+    size_t position = 0, next = 1;
+    bool starts_group = true;
+
+    for (size_t j = 0; j < factors.size(); j++)
+    {
+        if (starts_group)
+            merged.push_back(factors[j]);
+        else
+            merged.back() = merged.back().kronecker(factors[j]);
+
+        position += factor_qubits[j];
+        starts_group = position == boundaries[next];
+        if (starts_group)
+            next++;
+    }
+    return merged;
+}
+
+KroneckerOperator::KroneckerOperator(std::initializer_list<QuantumGate> factors_) :
+KroneckerOperator(std::vector<QuantumGate>(factors_))
+{}
+
+KroneckerOperator::KroneckerOperator(const std::vector<QuantumGate> &factors_) :
+factors(factors_)
+{
+    for (auto it = factors.begin(); it != factors.end(); it++)
+    {
+        factor_qubits.push_back(factor_qubit_num(*it));
+        qubit_n += factor_qubits.back();
+    }
+}
+
+size_t KroneckerOperator::factor_offset(size_t j) const
+{
+    size_t offset = 0;
+    for (size_t i = 0; i < j; i++)
+        offset += factor_qubits[i];
+    return offset;
+}
+
+KroneckerOperator KroneckerOperator::kronecker(const QuantumGate &q) const
+{
+    KroneckerOperator result{*this};
+    result.factors.push_back(q);
+    result.factor_qubits.push_back(factor_qubit_num(q));
+    result.qubit_n += result.factor_qubits.back();
+    return result;
+}
+
+KroneckerOperator KroneckerOperator::kronecker(const KroneckerOperator &op) const
+{
+    KroneckerOperator result{*this};
+    result.factors.insert(result.factors.end(), op.factors.begin(), op.factors.end());
+    result.factor_qubits.insert(result.factor_qubits.end(), op.factor_qubits.begin(), op.factor_qubits.end());
+    result.qubit_n += op.qubit_n;
+    return result;
+}
+
+KroneckerOperator KroneckerOperator::operator*(const KroneckerOperator &op) const
+{
+    if (qubit_n != op.qubit_n)
+        throw std::invalid_argument("Kronecker operators must act on the same number of qubits!");
+
+    // The boundaries of both operators, the factors in between are merged so that the two partitions match
+    std::vector<size_t> own{0}, other{0}, common;
+    for (size_t j = 0; j < factor_qubits.size(); j++)
+        own.push_back(own.back() + factor_qubits[j]);
+    for (size_t j = 0; j < op.factor_qubits.size(); j++)
+        other.push_back(other.back() + op.factor_qubits[j]);
+    std::set_intersection(own.begin(), own.end(), other.begin(), other.end(), std::back_inserter(common));
+
+    const std::vector<QuantumGate> left = merge_factors(factors, factor_qubits, common);
+    const std::vector<QuantumGate> right = merge_factors(op.factors, op.factor_qubits, common);
+
+    std::vector<QuantumGate> product;
+    for (size_t j = 0; j < left.size(); j++)
+        product.push_back(left[j] * right[j]);
+    return KroneckerOperator(product);
+}
+
+void KroneckerOperator::apply(Statevector &state) const
+{
+    if (state.qubit_num() != qubit_n)
+        throw std::invalid_argument("The Kronecker operator and the statevector have different numbers of qubits!");
+
+    size_t offset = 0;
+    for (size_t j = 0; j < factors.size(); offset += factor_qubits[j], j++)
+    {
+        const QuantumGate &factor = factors[j];
+        if (is_identity(factor))
+            continue;
+
+        if (factor.is_sparse())
+        {
+            apply_sparse_factor(state, offset, factor_qubits[j], *factor.get_sparse());
+        }
+        else if (factor_qubits[j] == 1)
+        {
+            if (is_diagonal(factor))
+                apply_diagonal_gate(state, offset, factor(1, 1), factor(2, 2));
+            else
+                apply_single_qubit_gate(state, offset, factor);
+        }
+        else
+        {
+            std::vector<size_t> qubits;
+            for (size_t q = offset; q < offset + factor_qubits[j]; q++)
+                qubits.push_back(q);
+            apply_multi_qubit_gate(state, qubits, factor);
+        }
+    }
+}
+
+QuantumGate KroneckerOperator::to_matrix() const
+{
+    if (factors.empty())
+        return Identity(1);
+
+    QuantumGate result{factors[0]};
+    for (size_t j = 1; j < factors.size(); j++)
+        result = result.kronecker(factors[j]);
+    return result;
+}
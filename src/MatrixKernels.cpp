@@ -0,0 +1,227 @@
+#include "../include/MatrixKernels.hpp"
+#include "../include/SimdKernels.hpp"
+#include "../include/ThreadPool.hpp"
+#include <vector>
+
+// Same runtime dispatch as SimdKernels.cpp, the SIMD versions are only called after the CPUID check.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define QC_SIMD_X86 1
+#include <immintrin.h>
+#define QC_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define QC_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+// Matrices smaller than this use the plain loop
+static const size_t GEMM_MIN_TILED = 16;
+// Rows (depth) and columns of a packed panel of B: 2 x 128 x 128 doubles = 256 KB
+static const size_t GEMM_KC = 128;
+static const size_t GEMM_NC = 128;
+// Rows of C computed together by the micro-kernels
+static const size_t GEMM_MR = 2;
+
+/*
+The micro-kernels compute a GEMM_MR x NR block of A B over the depth kc of a panel.
+a points to the first entry of the block rows in A (interleaved complex, row stride lda complex numbers),
+br and bi to the first column of the block in the planar panel (row stride ldb). The block is written to
+tr and ti (planar, row stride NR).
+*/
+static void scalar_micro(const double *a, size_t lda, const double *br, const double *bi, size_t ldb, size_t kc, double *tr, double *ti)
+{
+    double c0r[4] = {0}, c0i[4] = {0}, c1r[4] = {0}, c1i[4] = {0};
+    for (size_t k = 0; k < kc; k++)
+    {
+        const double a0r = a[2 * k], a0i = a[2 * k + 1];
+        const double a1r = a[2 * (lda + k)], a1i = a[2 * (lda + k) + 1];
+        const double *pr = br + k * ldb, *pi = bi + k * ldb;
+        for (size_t s = 0; s < 4; s++)
+        {
+            c0r[s] += a0r * pr[s] - a0i * pi[s];
+            c0i[s] += a0r * pi[s] + a0i * pr[s];
+            c1r[s] += a1r * pr[s] - a1i * pi[s];
+            c1i[s] += a1r * pi[s] + a1i * pr[s];
+        }
+    }
+    for (size_t s = 0; s < 4; s++)
+    {
+        tr[s] = c0r[s];
+        ti[s] = c0i[s];
+        tr[4 + s] = c1r[s];
+        ti[4 + s] = c1i[s];
+    }
+}
+
+#ifdef QC_SIMD_X86
+
+QC_TARGET_AVX2 static void avx2_micro(const double *a, size_t lda, const double *br, const double *bi, size_t ldb, size_t kc, double *tr, double *ti)
+{
+    __m256d c0r0 = _mm256_setzero_pd(), c0r1 = _mm256_setzero_pd(), c0i0 = _mm256_setzero_pd(), c0i1 = _mm256_setzero_pd();
+    __m256d c1r0 = _mm256_setzero_pd(), c1r1 = _mm256_setzero_pd(), c1i0 = _mm256_setzero_pd(), c1i1 = _mm256_setzero_pd();
+
+    for (size_t k = 0; k < kc; k++)
+    {
+        const __m256d br0 = _mm256_loadu_pd(br + k * ldb), br1 = _mm256_loadu_pd(br + k * ldb + 4);
+        const __m256d bi0 = _mm256_loadu_pd(bi + k * ldb), bi1 = _mm256_loadu_pd(bi + k * ldb + 4);
+
+        __m256d ar = _mm256_broadcast_sd(a + 2 * k), ai = _mm256_broadcast_sd(a + 2 * k + 1);
+        c0r0 = _mm256_fnmadd_pd(ai, bi0, _mm256_fmadd_pd(ar, br0, c0r0));
+        c0r1 = _mm256_fnmadd_pd(ai, bi1, _mm256_fmadd_pd(ar, br1, c0r1));
+        c0i0 = _mm256_fmadd_pd(ai, br0, _mm256_fmadd_pd(ar, bi0, c0i0));
+        c0i1 = _mm256_fmadd_pd(ai, br1, _mm256_fmadd_pd(ar, bi1, c0i1));
+
+        ar = _mm256_broadcast_sd(a + 2 * (lda + k));
+        ai = _mm256_broadcast_sd(a + 2 * (lda + k) + 1);
+        c1r0 = _mm256_fnmadd_pd(ai, bi0, _mm256_fmadd_pd(ar, br0, c1r0));
+        c1r1 = _mm256_fnmadd_pd(ai, bi1, _mm256_fmadd_pd(ar, br1, c1r1));
+        c1i0 = _mm256_fmadd_pd(ai, br0, _mm256_fmadd_pd(ar, bi0, c1i0));
+        c1i1 = _mm256_fmadd_pd(ai, br1, _mm256_fmadd_pd(ar, bi1, c1i1));
+    }
+
+    _mm256_storeu_pd(tr, c0r0);
+    _mm256_storeu_pd(tr + 4, c0r1);
+    _mm256_storeu_pd(ti, c0i0);
+    _mm256_storeu_pd(ti + 4, c0i1);
+    _mm256_storeu_pd(tr + 8, c1r0);
+    _mm256_storeu_pd(tr + 12, c1r1);
+    _mm256_storeu_pd(ti + 8, c1i0);
+    _mm256_storeu_pd(ti + 12, c1i1);
+}
+
+QC_TARGET_AVX512 static void avx512_micro(const double *a, size_t lda, const double *br, const double *bi, size_t ldb, size_t kc, double *tr, double *ti)
+{
+    __m512d c0r0 = _mm512_setzero_pd(), c0r1 = _mm512_setzero_pd(), c0i0 = _mm512_setzero_pd(), c0i1 = _mm512_setzero_pd();
+    __m512d c1r0 = _mm512_setzero_pd(), c1r1 = _mm512_setzero_pd(), c1i0 = _mm512_setzero_pd(), c1i1 = _mm512_setzero_pd();
+
+    for (size_t k = 0; k < kc; k++)
+    {
+        const __m512d br0 = _mm512_loadu_pd(br + k * ldb), br1 = _mm512_loadu_pd(br + k * ldb + 8);
+        const __m512d bi0 = _mm512_loadu_pd(bi + k * ldb), bi1 = _mm512_loadu_pd(bi + k * ldb + 8);
+
+        __m512d ar = _mm512_set1_pd(a[2 * k]), ai = _mm512_set1_pd(a[2 * k + 1]);
+        c0r0 = _mm512_fnmadd_pd(ai, bi0, _mm512_fmadd_pd(ar, br0, c0r0));
+        c0r1 = _mm512_fnmadd_pd(ai, bi1, _mm512_fmadd_pd(ar, br1, c0r1));
+        c0i0 = _mm512_fmadd_pd(ai, br0, _mm512_fmadd_pd(ar, bi0, c0i0));
+        c0i1 = _mm512_fmadd_pd(ai, br1, _mm512_fmadd_pd(ar, bi1, c0i1));
+
+        ar = _mm512_set1_pd(a[2 * (lda + k)]);
+        ai = _mm512_set1_pd(a[2 * (lda + k) + 1]);
+        c1r0 = _mm512_fnmadd_pd(ai, bi0, _mm512_fmadd_pd(ar, br0, c1r0));
+        c1r1 = _mm512_fnmadd_pd(ai, bi1, _mm512_fmadd_pd(ar, br1, c1r1));
+        c1i0 = _mm512_fmadd_pd(ai, br0, _mm512_fmadd_pd(ar, bi0, c1i0));
+        c1i1 = _mm512_fmadd_pd(ai, br1, _mm512_fmadd_pd(ar, bi1, c1i1));
+    }
+
+    _mm512_storeu_pd(tr, c0r0);
+    _mm512_storeu_pd(tr + 8, c0r1);
+    _mm512_storeu_pd(ti, c0i0);
+    _mm512_storeu_pd(ti + 8, c0i1);
+    _mm512_storeu_pd(tr + 16, c1r0);
+    _mm512_storeu_pd(tr + 24, c1r1);
+    _mm512_storeu_pd(ti + 16, c1i0);
+    _mm512_storeu_pd(ti + 24, c1i1);
+}
+
+#endif
+
+// Columns of the block computed by the micro-kernel of the level
+static size_t micro_width(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::AVX512:
+        return 16;
+    case SimdLevel::AVX2:
+        return 8;
+    default:
+        return 4;
+    }
+}
+
+// The blocks at the right and bottom edges that do not fill a micro-kernel, C += A B over the panel
+static void scalar_edge(const double *a, size_t lda, const double *br, const double *bi, size_t ldb, size_t kc,
+                        size_t rows, size_t cols, std::complex<double> *c, size_t ldc)
+{
+    for (size_t r = 0; r < rows; r++)
+    {
+        for (size_t k = 0; k < kc; k++)
+        {
+            const double ar = a[2 * (r * lda + k)], ai = a[2 * (r * lda + k) + 1];
+            const double *pr = br + k * ldb, *pi = bi + k * ldb;
+            for (size_t s = 0; s < cols; s++)
+                c[r * ldc + s] += std::complex<double>(ar * pr[s] - ai * pi[s], ar * pi[s] + ai * pr[s]);
+        }
+    }
+}
+
+void multiply_matrices(const std::complex<double> *a, const std::complex<double> *b, std::complex<double> *c, size_t n)
+{
+    std::fill(c, c + n * n, std::complex<double>(0.0, 0.0));
+
+    if (n < GEMM_MIN_TILED)
+    {
+        // i-k-j order, the rows of B and C are read contiguously
+        for (size_t i = 0; i < n; i++)
+            for (size_t k = 0; k < n; k++)
+            {
+                const double ar = a[i * n + k].real(), ai = a[i * n + k].imag();
+                for (size_t j = 0; j < n; j++)
+                {
+                    const double br = b[k * n + j].real(), bi = b[k * n + j].imag();
+                    c[i * n + j] += std::complex<double>(ar * br - ai * bi, ar * bi + ai * br);
+                }
+            }
+        return;
+    }
+
+    const SimdLevel level = get_simd_level();
+    const size_t nr = micro_width(level);
+    const double *a_d = reinterpret_cast<const double *>(a);
+
+    // One index per entry of C, so the grain of the pool compares with the size of the result
+    parallel_for(0, n * n, [=](size_t begin, size_t end)
+    {
+        const size_t row_begin = begin / n, row_end = end / n;
+        std::vector<double> panel_r(GEMM_KC * GEMM_NC), panel_i(GEMM_KC * GEMM_NC);
+        double tr[GEMM_MR * 16], ti[GEMM_MR * 16];
+
+        for (size_t jj = 0; jj < n; jj += GEMM_NC)
+        {
+            const size_t nc = std::min(GEMM_NC, n - jj);
+            for (size_t kk = 0; kk < n; kk += GEMM_KC)
+            {
+                const size_t kc = std::min(GEMM_KC, n - kk);
+                for (size_t k = 0; k < kc; k++)
+                    for (size_t j = 0; j < nc; j++)
+                    {
+                        panel_r[k * nc + j] = b[(kk + k) * n + jj + j].real();
+                        panel_i[k * nc + j] = b[(kk + k) * n + jj + j].imag();
+                    }
+
+                size_t i = row_begin;
+                for (; i + GEMM_MR <= row_end; i += GEMM_MR)
+                {
+                    const double *a_block = a_d + 2 * (i * n + kk);
+                    size_t j = 0;
+                    for (; j + nr <= nc; j += nr)
+                    {
+#ifdef QC_SIMD_X86
+                        if (level == SimdLevel::AVX512)
+                            avx512_micro(a_block, n, &panel_r[j], &panel_i[j], nc, kc, tr, ti);
+                        else if (level == SimdLevel::AVX2)
+                            avx2_micro(a_block, n, &panel_r[j], &panel_i[j], nc, kc, tr, ti);
+                        else
+#endif
+                            scalar_micro(a_block, n, &panel_r[j], &panel_i[j], nc, kc, tr, ti);
+
+                        for (size_t r = 0; r < GEMM_MR; r++)
+                            for (size_t s = 0; s < nr; s++)
+                                c[(i + r) * n + jj + j + s] += std::complex<double>(tr[r * nr + s], ti[r * nr + s]);
+                    }
+                    if (j < nc)
+                        scalar_edge(a_block, n, &panel_r[j], &panel_i[j], nc, kc, GEMM_MR, nc - j, c + i * n + jj + j, n);
+                }
+                if (i < row_end)
+                    scalar_edge(a_d + 2 * (i * n + kk), n, &panel_r[0], &panel_i[0], nc, kc, row_end - i, nc, c + i * n + jj, n);
+            }
+        }
+    }, n * GEMM_MR);
+}
@@ -0,0 +1,468 @@
+#include "../include/MatrixProductState.hpp"
+
+// Singular values below this fraction of the largest one are treated as zero
+static const double SINGULAR_VALUE_CUTOFF = 1e-14;
+// Upper bound of Jacobi sweeps, the rotations usually converge in less than 10
+static const size_t MAX_JACOBI_SWEEPS = 60;
+
+void singular_value_decomposition(const std::vector<std::complex<double>> &matrix, size_t rows, size_t cols,
+                                  std::vector<std::complex<double>> &u, std::vector<double> &s,
+                                  std::vector<std::complex<double>> &v)
+{
+    /*
+    One-sided Jacobi: the columns of A (m x n, m >= n) are orthogonalised by plane rotations that are
+    accumulated in W, so that A W = U diag(S) at the end. A wide matrix is decomposed through its
+    conjugate transpose. The columns are stored contiguously.
+    */
+    const bool transposed = rows < cols;
+    const size_t m = transposed ? cols : rows;
+    const size_t n = transposed ? rows : cols;
+
+    std::vector<std::complex<double>> a(m * n), w(n * n, 0.0);
+    for (size_t j = 0; j < n; j++)
+    {
+        w[j * n + j] = 1.0;
+        for (size_t i = 0; i < m; i++)
+            a[j * m + i] = transposed ? std::conj(matrix[j * cols + i]) : matrix[i * cols + j];
+    }
+
+    for (size_t sweep = 0; sweep < MAX_JACOBI_SWEEPS; sweep++)
+    {
+        bool rotated = false;
+        for (size_t i = 0; i + 1 < n; i++)
+        {
+            for (size_t j = i + 1; j < n; j++)
+            {
+                std::complex<double> *ai = &a[i * m], *aj = &a[j * m];
+                double alpha = 0.0, beta = 0.0;
+                std::complex<double> gamma = 0.0;
+                for (size_t k = 0; k < m; k++)
+                {
+                    alpha += std::norm(ai[k]);
+                    beta += std::norm(aj[k]);
+                    gamma += std::conj(ai[k]) * aj[k];
+                }
+
+                const double abs_gamma = std::abs(gamma);
+                if (abs_gamma == 0.0 || abs_gamma <= 1e-15 * std::sqrt(alpha * beta))
+                    continue;
+                rotated = true;
+
+                // Rotation that makes column j orthogonal to column i, after removing the phase of gamma
+                const double zeta = (beta - alpha) / (2.0 * abs_gamma);
+                const double t = (zeta >= 0 ? 1.0 : -1.0) / (std::abs(zeta) + std::sqrt(1.0 + zeta * zeta));
+                const double c = 1.0 / std::sqrt(1.0 + t * t);
+                const double sn = c * t;
+                const std::complex<double> phase = gamma / abs_gamma;
+
+                for (size_t k = 0; k < m; k++)
+                {
+                    const std::complex<double> x = ai[k], y = aj[k];
+                    ai[k] = c * x - sn * std::conj(phase) * y;
+                    aj[k] = sn * phase * x + c * y;
+                }
+                std::complex<double> *wi = &w[i * n], *wj = &w[j * n];
+                for (size_t k = 0; k < n; k++)
+                {
+                    const std::complex<double> x = wi[k], y = wj[k];
+                    wi[k] = c * x - sn * std::conj(phase) * y;
+                    wj[k] = sn * phase * x + c * y;
+                }
+            }
+        }
+        if (!rotated)
+            break;
+    }
+
+    // Singular values are the column norms, sorted in decreasing order
+    std::vector<double> norms(n);
+    std::vector<size_t> order(n);
+    for (size_t j = 0; j < n; j++)
+    {
+        double sum = 0.0;
+        for (size_t k = 0; k < m; k++)
+            sum += std::norm(a[j * m + k]);
+        norms[j] = std::sqrt(sum);
+        order[j] = j;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t x, size_t y) { return norms[x] > norms[y]; });
+
+    // Left vectors of A (m x n) are the normalised columns, right vectors the columns of W (n x n)
+    std::vector<std::complex<double>> left(m * n, 0.0), right(n * n);
+    s.assign(n, 0.0);
+    for (size_t j = 0; j < n; j++)
+    {
+        const size_t col = order[j];
+        s[j] = norms[col];
+        for (size_t k = 0; k < m; k++)
+            left[k * n + j] = s[j] > 0.0 ? a[col * m + k] / s[j] : 0.0;
+        for (size_t k = 0; k < n; k++)
+            right[k * n + j] = w[col * n + k];
+    }
+
+    // M = U S V^dagger, or for the transposed case M^dagger = left S right^dagger
+    u = transposed ? right : left;
+    v = transposed ? left : right;
+}
+
+MatrixProductState::MatrixProductState(size_t qubit_n_, size_t max_bond_) :
+MatrixProductState(qubit_n_, std::string(qubit_n_, '0'), max_bond_)
+{
+}
+
+MatrixProductState::MatrixProductState(size_t qubit_n_, const std::string &basis_state, size_t max_bond_) :
+qubit_n(qubit_n_)
+{
+    if (qubit_n == 0)
+        throw std::invalid_argument("A matrix product state needs at least one qubit!");
+    if (basis_state.length() != qubit_n)
+        throw std::invalid_argument("The length of the state must be equal to the number of qubits!");
+    set_max_bond(max_bond_);
+
+    // A basis state is a product state, every bond has dimension 1
+    bonds.assign(qubit_n - 1, 1);
+    for (size_t q = 0; q < qubit_n; q++)
+    {
+        if (basis_state[q] != '0' && basis_state[q] != '1')
+            throw std::invalid_argument("The state can only contain binary digits!");
+        std::vector<std::complex<double>> site(2, 0.0);
+        site[basis_state[q] - '0'] = 1.0;
+        tensors.push_back(site);
+    }
+}
+
+void MatrixProductState::set_max_bond(size_t max_bond_)
+{
+    if (max_bond_ == 0)
+        throw std::invalid_argument("The bond dimension cap must be at least 1!");
+    max_bond = max_bond_;
+}
+
+void MatrixProductState::check_qubit(size_t q) const
+{
+    if (q >= qubit_n)
+        throw std::invalid_argument("Target qubit is out of range!");
+}
+
+void MatrixProductState::move_centre(size_t q)
+{
+    std::vector<std::complex<double>> u, v;
+    std::vector<double> s;
+
+    while (centre < q)
+    {
+        // A[c] = U (left orthonormal), S V^dagger is pushed into A[c+1]
+        const size_t l = left_bond(centre), r = right_bond(centre), r2 = right_bond(centre + 1);
+        singular_value_decomposition(tensors[centre], 2 * l, r, u, s, v);
+        const size_t full = s.size();
+        size_t k = 0;
+        while (k < full && s[k] > SINGULAR_VALUE_CUTOFF * s[0])
+            k++;
+
+        std::vector<std::complex<double>> site(2 * l * k);
+        for (size_t i = 0; i < 2 * l; i++)
+            for (size_t j = 0; j < k; j++)
+                site[i * k + j] = u[i * full + j];
+
+        std::vector<std::complex<double>> next(k * 2 * r2, 0.0);
+        for (size_t j = 0; j < k; j++)
+            for (size_t m = 0; m < r; m++)
+            {
+                const std::complex<double> svh = s[j] * std::conj(v[m * full + j]);
+                for (size_t x = 0; x < 2 * r2; x++)
+                    next[j * 2 * r2 + x] += svh * tensors[centre + 1][m * 2 * r2 + x];
+            }
+
+        tensors[centre] = site;
+        tensors[centre + 1] = next;
+        bonds[centre] = k;
+        centre++;
+    }
+
+    while (centre > q)
+    {
+        // A[c] = V^dagger (right orthonormal), U S is pushed into A[c-1]
+        const size_t l = left_bond(centre), r = right_bond(centre), l2 = left_bond(centre - 1);
+        singular_value_decomposition(tensors[centre], l, 2 * r, u, s, v);
+        const size_t full = s.size();
+        size_t k = 0;
+        while (k < full && s[k] > SINGULAR_VALUE_CUTOFF * s[0])
+            k++;
+
+        std::vector<std::complex<double>> site(k * 2 * r);
+        for (size_t j = 0; j < k; j++)
+            for (size_t x = 0; x < 2 * r; x++)
+                site[j * 2 * r + x] = std::conj(v[x * full + j]);
+
+        std::vector<std::complex<double>> previous(l2 * 2 * k, 0.0);
+        for (size_t x = 0; x < l2 * 2; x++)
+            for (size_t m = 0; m < l; m++)
+            {
+                const std::complex<double> a = tensors[centre - 1][x * l + m];
+                for (size_t j = 0; j < k; j++)
+                    previous[x * k + j] += a * u[m * full + j] * s[j];
+            }
+
+        tensors[centre] = site;
+        tensors[centre - 1] = previous;
+        bonds[centre - 1] = k;
+        centre--;
+    }
+}
+
+void MatrixProductState::apply_single_qubit_gate(size_t q, const QuantumGate &core)
+{
+    check_qubit(q);
+    if (core.get_rows() != 2 || core.get_cols() != 2)
+        throw std::invalid_argument("A single qubit gate core must be a 2x2 matrix!");
+
+    const std::complex<double> m00 = core(1, 1), m01 = core(1, 2);
+    const std::complex<double> m10 = core(2, 1), m11 = core(2, 2);
+    const size_t l = left_bond(q), r = right_bond(q);
+    std::vector<std::complex<double>> &site = tensors[q];
+
+    for (size_t i = 0; i < l; i++)
+        for (size_t j = 0; j < r; j++)
+        {
+            const std::complex<double> a0 = site[(i * 2) * r + j];
+            const std::complex<double> a1 = site[(i * 2 + 1) * r + j];
+            site[(i * 2) * r + j] = m00 * a0 + m01 * a1;
+            site[(i * 2 + 1) * r + j] = m10 * a0 + m11 * a1;
+        }
+}
+
+void MatrixProductState::apply_adjacent_gate(size_t q, const std::vector<std::complex<double>> &matrix)
+{
+    // The truncation is optimal if the centre is one of the two sites
+    if (centre < q)
+        move_centre(q);
+    else if (centre > q + 1)
+        move_centre(q + 1);
+
+    const size_t l = left_bond(q), m = right_bond(q), r = right_bond(q + 1);
+    const std::vector<std::complex<double>> &a = tensors[q], &b = tensors[q + 1];
+
+    // theta[l, s1, s2, r] = sum over the bond of A[q][l, s1, .] A[q+1][., s2, r]
+    std::vector<std::complex<double>> theta(l * 4 * r, 0.0);
+    for (size_t i = 0; i < l; i++)
+        for (size_t s1 = 0; s1 < 2; s1++)
+            for (size_t k = 0; k < m; k++)
+            {
+                const std::complex<double> x = a[(i * 2 + s1) * m + k];
+                if (x == std::complex<double>(0, 0))
+                    continue;
+                for (size_t s2 = 0; s2 < 2; s2++)
+                    for (size_t j = 0; j < r; j++)
+                        theta[((i * 2 + s1) * 2 + s2) * r + j] += x * b[(k * 2 + s2) * r + j];
+            }
+
+    // Apply the gate on the two physical indices; the result is a (2l) x (2r) matrix
+    std::vector<std::complex<double>> gated(l * 4 * r, 0.0);
+    for (size_t i = 0; i < l; i++)
+        for (size_t out = 0; out < 4; out++)
+            for (size_t in = 0; in < 4; in++)
+            {
+                const std::complex<double> g = matrix[out * 4 + in];
+                if (g == std::complex<double>(0, 0))
+                    continue;
+                for (size_t j = 0; j < r; j++)
+                    gated[(i * 4 + out) * r + j] += g * theta[(i * 4 + in) * r + j];
+            }
+
+    std::vector<std::complex<double>> u, v;
+    std::vector<double> s;
+    singular_value_decomposition(gated, 2 * l, 2 * r, u, s, v);
+    const size_t full = s.size();
+
+    double total = 0.0;
+    for (size_t j = 0; j < full; j++)
+        total += s[j] * s[j];
+
+    size_t k = 0;
+    while (k < full && k < max_bond && s[k] > SINGULAR_VALUE_CUTOFF * s[0])
+        k++;
+
+    // The discarded weight is counted relative to the norm, the kept values are rescaled to keep it
+    double kept = 0.0;
+    for (size_t j = 0; j < k; j++)
+        kept += s[j] * s[j];
+    if (total > 0.0)
+        discarded_weight += (total - kept) / total;
+    const double rescale = kept > 0.0 ? std::sqrt(total / kept) : 1.0;
+
+    std::vector<std::complex<double>> left(2 * l * k), right(k * 2 * r);
+    for (size_t x = 0; x < 2 * l; x++)
+        for (size_t j = 0; j < k; j++)
+            left[x * k + j] = u[x * full + j];
+    for (size_t j = 0; j < k; j++)
+        for (size_t y = 0; y < 2 * r; y++)
+            right[j * 2 * r + y] = s[j] * rescale * std::conj(v[y * full + j]);
+
+    tensors[q] = left;
+    tensors[q + 1] = right;
+    bonds[q] = k;
+    centre = q + 1;
+}
+
+// The 4x4 matrix of a gate as a row major vector
+static std::vector<std::complex<double>> two_qubit_matrix(const QuantumGate &gate)
+{
+    if (gate.get_rows() != 4 || gate.get_cols() != 4)
+        throw std::invalid_argument("A two qubit gate must be a 4x4 matrix!");
+    std::vector<std::complex<double>> matrix(16);
+    for (size_t r = 0; r < 4; r++)
+        for (size_t c = 0; c < 4; c++)
+            matrix[r * 4 + c] = gate(r + 1, c + 1);
+    return matrix;
+}
+
+void MatrixProductState::apply_two_qubit_gate(size_t q1, size_t q2, const QuantumGate &gate)
+{
+    check_qubit(q1);
+    check_qubit(q2);
+    if (q1 == q2)
+        throw std::invalid_argument("A two qubit gate needs two different qubits!");
+
+    std::vector<std::complex<double>> matrix = two_qubit_matrix(gate);
+    if (q1 > q2)
+    {
+        // Exchange the roles of the two bits of the row and column indices
+        std::vector<std::complex<double>> exchanged(16);
+        const size_t flip[4] = {0, 2, 1, 3};
+        for (size_t r = 0; r < 4; r++)
+            for (size_t c = 0; c < 4; c++)
+                exchanged[flip[r] * 4 + flip[c]] = matrix[r * 4 + c];
+        matrix = exchanged;
+    }
+
+    const size_t low = std::min(q1, q2), high = std::max(q1, q2);
+    const std::vector<std::complex<double>> swap_matrix = two_qubit_matrix(QuantumGate::SWAP4x4);
+
+    // Swap network: bring the high qubit next to the low one, apply the gate and move it back
+    for (size_t p = high - 1; p > low; p--)
+        apply_adjacent_gate(p, swap_matrix);
+    apply_adjacent_gate(low, matrix);
+    for (size_t p = low + 1; p < high; p++)
+        apply_adjacent_gate(p, swap_matrix);
+}
+
+void MatrixProductState::apply_swap(size_t q1, size_t q2)
+{
+    check_qubit(q1);
+    check_qubit(q2);
+    if (q1 == q2)
+        return;
+
+    const size_t low = std::min(q1, q2), high = std::max(q1, q2);
+    const std::vector<std::complex<double>> swap_matrix = two_qubit_matrix(QuantumGate::SWAP4x4);
+
+    // The high qubit moves down next to the low one, they are swapped, and the low one moves up to high
+    for (size_t p = high - 1; p > low; p--)
+        apply_adjacent_gate(p, swap_matrix);
+    apply_adjacent_gate(low, swap_matrix);
+    for (size_t p = low + 1; p < high; p++)
+        apply_adjacent_gate(p, swap_matrix);
+}
+
+std::complex<double> MatrixProductState::amplitude(const std::string &basis_state) const
+{
+    if (basis_state.length() != qubit_n)
+        throw std::invalid_argument("The length of the state must be equal to the number of qubits!");
+
+    std::vector<std::complex<double>> row{1.0};
+    for (size_t q = 0; q < qubit_n; q++)
+    {
+        const size_t l = left_bond(q), r = right_bond(q);
+        const size_t s = basis_state[q] == '1' ? 1 : 0;
+        std::vector<std::complex<double>> next(r, 0.0);
+        for (size_t i = 0; i < l; i++)
+            for (size_t j = 0; j < r; j++)
+                next[j] += row[i] * tensors[q][(i * 2 + s) * r + j];
+        row = next;
+    }
+    return row[0];
+}
+
+Statevector MatrixProductState::to_statevector() const
+{
+    if (qubit_n > 24)
+        throw std::invalid_argument("The statevector of more than 24 qubits is too large!");
+
+    // partial[index, bond] for the qubits contracted so far, qubit 0 being the most significant bit
+    std::vector<std::complex<double>> partial{1.0};
+    size_t prefix_n = 1;
+    for (size_t q = 0; q < qubit_n; q++)
+    {
+        const size_t l = left_bond(q), r = right_bond(q);
+        std::vector<std::complex<double>> next(prefix_n * 2 * r, 0.0);
+        for (size_t idx = 0; idx < prefix_n; idx++)
+            for (size_t i = 0; i < l; i++)
+            {
+                const std::complex<double> x = partial[idx * l + i];
+                for (size_t s = 0; s < 2; s++)
+                    for (size_t j = 0; j < r; j++)
+                        next[(idx * 2 + s) * r + j] += x * tensors[q][(i * 2 + s) * r + j];
+            }
+        partial = next;
+        prefix_n *= 2;
+    }
+
+    Statevector state(qubit_n);
+    for (size_t idx = 0; idx < prefix_n; idx++)
+        state[idx] = partial[idx];
+    return state;
+}
+
+std::map<std::string, size_t> MatrixProductState::sample(size_t shots, std::mt19937_64 &rng)
+{
+    // With the centre on site 0, all the other tensors are right orthonormal and the marginals are local
+    move_centre(0);
+
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::map<std::string, size_t> counts;
+    for (size_t shot = 0; shot < shots; shot++)
+    {
+        std::string bits(qubit_n, '0');
+        std::vector<std::complex<double>> row{1.0};
+        for (size_t q = 0; q < qubit_n; q++)
+        {
+            const size_t l = left_bond(q), r = right_bond(q);
+            std::vector<std::complex<double>> branch[2] = {std::vector<std::complex<double>>(r, 0.0),
+                                                           std::vector<std::complex<double>>(r, 0.0)};
+            double probability[2] = {0.0, 0.0};
+            for (size_t s = 0; s < 2; s++)
+            {
+                for (size_t i = 0; i < l; i++)
+                    for (size_t j = 0; j < r; j++)
+                        branch[s][j] += row[i] * tensors[q][(i * 2 + s) * r + j];
+                for (size_t j = 0; j < r; j++)
+                    probability[s] += std::norm(branch[s][j]);
+            }
+
+            const size_t outcome = uniform(rng) * (probability[0] + probability[1]) < probability[0] ? 0 : 1;
+            bits[q] = outcome ? '1' : '0';
+            const double norm = std::sqrt(probability[outcome]);
+            row = branch[outcome];
+            for (auto it = row.begin(); it != row.end(); it++)
+                *it /= norm;
+        }
+        counts[bits]++;
+    }
+    return counts;
+}
+
+size_t MatrixProductState::max_bond_dimension() const
+{
+    size_t result = 1;
+    for (auto it = bonds.begin(); it != bonds.end(); it++)
+        result = std::max(result, *it);
+    return result;
+}
+
+size_t MatrixProductState::memory_size() const
+{
+    size_t result = 0;
+    for (auto it = tensors.begin(); it != tensors.end(); it++)
+        result += it->size();
+    return result;
+}
@@ -1,4 +1,6 @@
 #include "../include/QuantumCircuit.hpp"
+#include "../include/CacheBlocking.hpp"
+#include "../include/FixedGate.hpp"
 
 // Default constructor
 QuantumCircuit::QuantumCircuit()
@@ -12,46 +14,213 @@ QuantumCircuit::QuantumCircuit(size_t qubit_n_)
     qubit_n = qubit_n_;
 }
 
+/*
+The gates are stored as GateOp records, the matrices of the named gates are never built for the
+simulation; evolve() dispatches on the code of each record to the matrix-free kernels in GateKernels.hpp.
+*/
+
 // Method to add a Hadamard gate to a single qubit
 void QuantumCircuit::add_Hadamard(size_t q)
 {
-    std::vector<size_t> qubit_eff{q};
-    gates_targets.push_back({qubit_eff, Hadamard{qubit_n, q}});
+    gates.push_back(make_gate_op(GateCode::Hadamard, {q}));
 }
 
-// Method to add a Hadamard gate to multiple qubits parallelly
+// Method to add a Hadamard gate to multiple qubits parallelly, one record per qubit in the same layer
 void QuantumCircuit::add_Hadamard(std::initializer_list<size_t> qubit_eff_list)
 {
-    std::vector<size_t> qubit_eff{qubit_eff_list};
-    gates_targets.push_back({qubit_eff, Hadamard{qubit_n, qubit_eff_list}});
+    for (auto q = qubit_eff_list.begin(); q != qubit_eff_list.end(); q++)
+    {
+        gates.push_back(make_gate_op(GateCode::Hadamard, {*q}));
+        if (q != qubit_eff_list.begin())
+            gates.back().flags |= GateOp::SAME_LAYER;
+    }
 }
 
 // Method to add a Swap gate to two qubits
 void QuantumCircuit::add_Swap(size_t q1, size_t q2)
 {
-    std::vector<size_t> qubit_eff{q1, q2};
-    gates_targets.push_back({qubit_eff, Swap{qubit_n, q1, q2}});
+    gates.push_back(make_gate_op(GateCode::Swap, {q1, q2}));
 }
 
 // Method to add a CNOT gate to two qubits
 void QuantumCircuit::add_CNOT(size_t q1, size_t q2)
 {
-    std::vector<size_t> qubit_eff{q1, q2};
-    gates_targets.push_back({qubit_eff, CNOT{qubit_n, q1, q2}});
+    gates.push_back(make_gate_op(GateCode::CNOT, {q1, q2}));
 }
 
 // Method to add a Pauli gate to a single qubit
 void QuantumCircuit::add_Pauli(size_t q, std::string pauli_type)
 {
-    std::vector<size_t> qubit_eff{q};
-    gates_targets.push_back({qubit_eff, Pauli{qubit_n, q, pauli_type}});
+    if (pauli_type == "X")
+        gates.push_back(make_gate_op(GateCode::PauliX, {q}));
+    else if (pauli_type == "Y")
+        gates.push_back(make_gate_op(GateCode::PauliY, {q}));
+    else if (pauli_type == "Z")
+        gates.push_back(make_gate_op(GateCode::PauliZ, {q}));
+    else
+        gates.push_back(make_gate_op(GateCode::Identity, {q}));
 }
 
 // Method to add a Phase gate to a single qubit
 void QuantumCircuit::add_Phase(size_t q, double phase)
 {
-    std::vector<size_t> qubit_eff{q};
-    gates_targets.push_back({qubit_eff, Phase{qubit_n, q, phase}});
+    gates.push_back(make_gate_op(GateCode::Phase, {q}, phase));
+}
+
+// Method to add a controlled phase gate to two qubits
+void QuantumCircuit::add_CPhase(size_t q1, size_t q2, double phase)
+{
+    gates.push_back(make_gate_op(GateCode::ControlledPhase, {q1, q2}, phase));
+}
+
+// Method to add any gate given as a matrix
+void QuantumCircuit::add_gate(const std::vector<size_t> &qubits, const QuantumGate &gate)
+{
+    for (auto q = qubits.begin(); q != qubits.end(); q++)
+        if (*q >= qubit_n)
+            throw std::invalid_argument("The target qubit is out of range!");
+    gates.push_back(make_gate_op(qubits, gate, matrices));
+}
+
+/*
+The QFT of m qubits is decomposed as: for each qubit j of the register, H on j followed by the controlled
+phases pi / 2^(k - j) with every later qubit k, then Swaps that reverse the order of the qubits.
+The inverse applies the same gates in the reverse order with the opposite phases.
+*/
+void QuantumCircuit::add_Fourier_block(size_t first_qubit, size_t qubit_count, bool inverse)
+{
+    if (qubit_count == 0 || first_qubit + qubit_count > qubit_n)
+        throw std::invalid_argument("The qubits of the Fourier transform are out of range!");
+
+    std::vector<GateOp> decomposition;
+    for (size_t j = 0; j < qubit_count; j++)
+    {
+        decomposition.push_back(make_gate_op(GateCode::Hadamard, {first_qubit + j}));
+        for (size_t k = j + 1; k < qubit_count; k++)
+            decomposition.push_back(make_gate_op(GateCode::ControlledPhase, {first_qubit + k, first_qubit + j}, M_PI / std::pow(2.0, k - j)));
+    }
+    for (size_t j = 0; j < qubit_count / 2; j++)
+        decomposition.push_back(make_gate_op(GateCode::Swap, {first_qubit + j, first_qubit + qubit_count - 1 - j}));
+
+    if (inverse)
+    {
+        std::reverse(decomposition.begin(), decomposition.end());
+        for (auto it = decomposition.begin(); it != decomposition.end(); it++)
+        {
+            if (it->code == GateCode::ControlledPhase)
+                it->param = -it->param;
+        }
+    }
+
+    fourier_blocks.push_back({gates.size(), decomposition.size(), first_qubit, qubit_count, inverse});
+    gates.insert(gates.end(), decomposition.begin(), decomposition.end());
+}
+
+// Method to add a quantum Fourier transform to a range of qubits
+void QuantumCircuit::add_QFT(size_t first_qubit, size_t qubit_count)
+{
+    add_Fourier_block(first_qubit, qubit_count, false);
+}
+
+// Method to add an inverse quantum Fourier transform to a range of qubits
+void QuantumCircuit::add_inverse_QFT(size_t first_qubit, size_t qubit_count)
+{
+    add_Fourier_block(first_qubit, qubit_count, true);
+}
+
+/*
+Dispatch of a gate record to the kernels of a state layout. The single qubit gates use the static 2x2
+cores and the diagonal gates only their two factors, so nothing is allocated; the Matrix gates read
+their matrix from the table of the circuit.
+*/
+template <class State>
+static void dispatch_gate(State &state, const GateOp &op, const std::vector<QuantumGate> &matrices)
+{
+    std::complex<double> d0, d1;
+
+    switch (op.code)
+    {
+    case GateCode::CNOT:
+        // qubits[0] is the control qubit, qubits[1] the target qubit
+        apply_cnot(state, op.qubits[0], op.qubits[1]);
+        break;
+    case GateCode::Swap:
+        apply_swap(state, op.qubits[0], op.qubits[1]);
+        break;
+    case GateCode::PauliX:
+        apply_pauli_x(state, op.qubits[0]);
+        break;
+    case GateCode::Hadamard:
+        apply_single_qubit_gate(state, op.qubits[0], QuantumGate::Hadamard2x2);
+        break;
+    case GateCode::PauliY:
+        apply_single_qubit_gate(state, op.qubits[0], QuantumGate::PauliY);
+        break;
+    case GateCode::Identity:
+        break;
+    case GateCode::ControlledPhase:
+        apply_controlled_phase(state, op.qubits[0], op.qubits[1], std::polar(1.0, op.param));
+        break;
+    default:
+        if (diagonal_factors(op, matrices, d0, d1))
+            apply_diagonal_gate(state, op.qubits[0], d0, d1);
+        else if (op.qubit_count == 1)
+            apply_single_qubit_gate(state, op.qubits[0], matrices[op.matrix]);
+        else
+            // Dense k-qubit gate, e.g. a block produced by fuse_gates()
+            apply_multi_qubit_gate(state, gate_qubits(op), matrices[op.matrix]);
+        break;
+    }
+}
+
+/*
+On a Statevector the Hadamard, Y and dense one and two qubit gates use the unrolled kernels of
+FixedGate.hpp, with the matrix on the stack.
+*/
+void apply_gate(Statevector &state, const GateOp &op, const std::vector<QuantumGate> &matrices)
+{
+    std::complex<double> d0, d1;
+
+    switch (op.code)
+    {
+    case GateCode::Hadamard:
+        apply_fixed_gate<1>(state, {{op.qubits[0]}}, FixedHadamard2x2);
+        return;
+    case GateCode::PauliY:
+        apply_fixed_gate<1>(state, {{op.qubits[0]}}, FixedPauliY);
+        return;
+    case GateCode::Matrix:
+        if (op.qubit_count == 1 && !diagonal_factors(op, matrices, d0, d1))
+        {
+            apply_fixed_gate<1>(state, {{op.qubits[0]}}, to_fixed_gate<1>(matrices[op.matrix]));
+            return;
+        }
+        if (op.qubit_count == 2)
+        {
+            apply_fixed_gate<2>(state, {{op.qubits[0], op.qubits[1]}}, to_fixed_gate<2>(matrices[op.matrix]));
+            return;
+        }
+        break;
+    default:
+        break;
+    }
+    dispatch_gate(state, op, matrices);
+}
+
+void apply_gate(SplitStatevector &state, const GateOp &op, const std::vector<QuantumGate> &matrices)
+{
+    dispatch_gate(state, op, matrices);
+}
+
+void apply_gate(SparseStatevector &state, const GateOp &op, const std::vector<QuantumGate> &matrices)
+{
+    dispatch_gate(state, op, matrices);
+}
+
+void apply_gate(Statevector &state, const std::vector<size_t> &qubits, const QuantumGate &gate)
+{
+    std::vector<QuantumGate> matrices;
+    apply_gate(state, make_gate_op(qubits, gate, matrices), matrices);
 }
 
 // Friend function to evolve a statevector with a quantum circuit
@@ -59,31 +228,378 @@ Statevector evolve(Statevector &state, QuantumCircuit &circuit, std::string show
 {
     Statevector final_state = state;
 
-    int i = 1;
-    for (auto it = circuit.gates_targets.begin(); it != circuit.gates_targets.end(); it++, i++)
+    // A basis state through a reversible circuit stays a basis state, only its index and phase are computed
+    if (show_step != "all" && circuit.is_reversible())
     {
-        // Decompose the pair
-        std::vector<size_t> qubit_eff = it->first;
-        QuantumGate gate = it->second;
+        size_t nonzero_n = 0, index = 0;
+        for (size_t i = 0; i < final_state.size() && nonzero_n < 2; i++)
+        {
+            if (std::abs(final_state[i]) > 1e-12)
+            {
+                nonzero_n++;
+                index = i;
+            }
+        }
+        if (nonzero_n == 1)
+        {
+            ReversibleCircuit empty(circuit.qubit_n);
+            const ReversibleCircuit reversible = evolve(empty, circuit);
+            std::string input(circuit.qubit_n, '0');
+            for (size_t q = 0; q < circuit.qubit_n; q++)
+                input[q] = (index >> (circuit.qubit_n - 1 - q)) & 1 ? '1' : '0';
+            const std::pair<std::string, std::complex<double>> output = reversible.run(input);
+
+            const std::complex<double> amplitude = final_state[index] * output.second;
+            final_state[index] = 0.0;
+            final_state[std::stoull(output.first, nullptr, 2)] = amplitude;
+            final_state.round();
+            return final_state;
+        }
+    }
+
+    // States larger than a cache block are simulated with the cache-blocked schedule
+    if (show_step != "all" && final_state.qubit_num() > get_cache_block_qubits())
+    {
+        // The gates between the Fourier blocks are cache blocked, the blocks run as FFTs
+        const GateOp *gates = circuit.gates.data();
+        size_t next_gate = 0;
+        for (auto block = circuit.fourier_blocks.begin(); block != circuit.fourier_blocks.end(); block++)
+        {
+            apply_gates_cache_blocked(final_state, gates + next_gate, gates + block->first_gate, circuit.matrices);
+            apply_fourier_transform(final_state, block->first_qubit, block->qubit_count, block->inverse);
+            next_gate = block->first_gate + block->gate_count;
+        }
+        apply_gates_cache_blocked(final_state, gates + next_gate, gates + circuit.gates.size(), circuit.matrices);
+        final_state.round();
+        return final_state;
+    }
+
+    /*
+    Diagonal gates (Phase, Pauli Z) commute with each other, so consecutive ones are collected
+    in diagonal_run and applied together in one pass when the run ends. Consecutive Hadamard gates
+    are collected in hadamard_run and applied as one Walsh-Hadamard transform.
+    When every step is displayed, each gate is applied on its own instead.
+    */
+    std::vector<DiagonalFactor> diagonal_run;
+    std::vector<size_t> hadamard_run;
+    auto block = circuit.fourier_blocks.begin();
+
+    auto flush_runs = [&]()
+    {
+        apply_diagonal_gates(final_state, diagonal_run);
+        diagonal_run.clear();
+        if (hadamard_run.size() == 1)
+            apply_single_qubit_gate(final_state, hadamard_run[0], QuantumGate::Hadamard2x2);
+        else if (hadamard_run.size() > 1)
+            apply_hadamard_layer(final_state, hadamard_run);
+        hadamard_run.clear();
+    };
+
+    for (size_t g = 0; g < circuit.gates.size(); g++)
+    {
+        const GateOp &op = circuit.gates[g];
+
+        if (show_step != "all")
+        {
+            // The decomposition of a quantum Fourier transform is replaced by the FFT
+            if (block != circuit.fourier_blocks.end() && g == block->first_gate)
+            {
+                flush_runs();
+                apply_fourier_transform(final_state, block->first_qubit, block->qubit_count, block->inverse);
+                g += block->gate_count - 1;
+                block++;
+                continue;
+            }
+
+            std::complex<double> d0, d1;
+            if (diagonal_factors(op, circuit.matrices, d0, d1))
+            {
+                if (!hadamard_run.empty())
+                    flush_runs();
+                diagonal_run.push_back({op.qubits[0], d0, d1});
+                continue;
+            }
+            if (op.code == GateCode::Hadamard)
+            {
+                if (!diagonal_run.empty())
+                    flush_runs();
+                hadamard_run.push_back(op.qubits[0]);
+                continue;
+            }
+        }
+
+        flush_runs();
+        apply_gate(final_state, op, circuit.matrices);
 
         if (show_step == "all")
         {
-            std::cout << "[Step " << i << "]  " << std::endl;
+            std::cout << "[Step " << g + 1 << "]  " << std::endl;
             std::cout << "Gate: " << std::endl;
-            gate.display_matrix();
-
-            final_state = gate * final_state;
+            gate_core(op, circuit.matrices).display_matrix();
 
+            final_state.round();
             std::cout << "Current state: " << std::endl;
             final_state.display_row();
 
             std::cout << std::endl;
         }
-        else 
+    }
+
+    flush_runs();
+
+    final_state.round();
+    return final_state;
+}
+
+// Friend function to evolve a statevector in the split (structure-of-arrays) layout with the SIMD kernels
+SplitStatevector evolve(SplitStatevector &state, QuantumCircuit &circuit)
+{
+    SplitStatevector final_state = state;
+
+    for (auto op = circuit.gates.begin(); op != circuit.gates.end(); op++)
+    {
+        apply_gate(final_state, *op, circuit.matrices);
+    }
+
+    return final_state;
+}
+
+/*
+A Phase gate diag(1, e^{i phase}) is a Clifford gate if e^{i phase} is 1, i, -1 or -i, i.e. S applied
+0 to 3 times. Returns false for any other phase.
+*/
+static bool phase_quarter_turns(double phase, size_t &quarter_turns)
+{
+    const std::complex<double> d1 = std::polar(1.0, phase);
+    const std::complex<double> turns[4] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+    for (size_t k = 0; k < 4; k++)
+    {
+        if (std::abs(d1 - turns[k]) < 1e-10)
+        {
+            quarter_turns = k;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool QuantumCircuit::is_clifford() const
+{
+    for (auto op = gates.begin(); op != gates.end(); op++)
+    {
+        size_t quarter_turns;
+        switch (op->code)
         {
-            final_state = gate * final_state;
+        case GateCode::Hadamard:
+        case GateCode::Swap:
+        case GateCode::CNOT:
+        case GateCode::PauliX:
+        case GateCode::PauliY:
+        case GateCode::PauliZ:
+        case GateCode::Identity:
+            break;
+        case GateCode::Phase:
+            if (!phase_quarter_turns(op->param, quarter_turns))
+                return false;
+            break;
+        default:
+            return false;
         }
     }
+    return true;
+}
+
+bool QuantumCircuit::is_reversible() const
+{
+    if (qubit_n > ReversibleCircuit::MAX_QUBITS)
+        return false;
+    for (auto op = gates.begin(); op != gates.end(); op++)
+    {
+        // Every named gate except H permutes basis states, the matrices are checked entry by entry
+        if (op->code == GateCode::Hadamard)
+            return false;
+        if (op->code == GateCode::Matrix && !ReversibleCircuit::is_reversible(matrices[op->matrix]))
+            return false;
+    }
+    return true;
+}
+
+// Friend function to evolve a stabilizer tableau with a circuit made of Clifford gates
+StabilizerTableau evolve(StabilizerTableau &state, QuantumCircuit &circuit)
+{
+    if (state.qubit_num() != circuit.qubit_n)
+        throw std::invalid_argument("The number of qubits of the state and the circuit are different!");
+
+    StabilizerTableau final_state = state;
+
+    for (auto op = circuit.gates.begin(); op != circuit.gates.end(); op++)
+    {
+        size_t quarter_turns = 0;
+
+        switch (op->code)
+        {
+        case GateCode::Hadamard:
+            final_state.hadamard(op->qubits[0]);
+            break;
+        case GateCode::Swap:
+            final_state.swap(op->qubits[0], op->qubits[1]);
+            break;
+        case GateCode::CNOT:
+            final_state.cnot(op->qubits[0], op->qubits[1]);
+            break;
+        case GateCode::PauliX:
+            final_state.pauli_x(op->qubits[0]);
+            break;
+        case GateCode::PauliY:
+            final_state.pauli_y(op->qubits[0]);
+            break;
+        case GateCode::PauliZ:
+            final_state.pauli_z(op->qubits[0]);
+            break;
+        case GateCode::Identity:
+            break;
+        case GateCode::Phase:
+            if (!phase_quarter_turns(op->param, quarter_turns))
+                throw std::invalid_argument("A Phase gate of a stabilizer circuit must be a multiple of 90 degrees!");
+            for (size_t k = 0; k < quarter_turns; k++)
+                final_state.phase_s(op->qubits[0]);
+            break;
+        default:
+            throw std::invalid_argument("The circuit contains a gate that is not a Clifford gate!");
+        }
+    }
+
+    return final_state;
+}
+
+// Friend function to evolve a matrix product state, gates on distant qubits go through swap networks
+MatrixProductState evolve(MatrixProductState &state, QuantumCircuit &circuit)
+{
+    if (state.qubit_num() != circuit.qubit_n)
+        throw std::invalid_argument("The number of qubits of the state and the circuit are different!");
+
+    MatrixProductState final_state = state;
+
+    for (auto op = circuit.gates.begin(); op != circuit.gates.end(); op++)
+    {
+        if (op->code == GateCode::Swap)
+            final_state.apply_swap(op->qubits[0], op->qubits[1]);
+        else if (op->qubit_count == 1)
+            final_state.apply_single_qubit_gate(op->qubits[0], gate_core(*op, circuit.matrices));
+        else if (op->qubit_count == 2)
+            final_state.apply_two_qubit_gate(op->qubits[0], op->qubits[1], gate_core(*op, circuit.matrices));
+        else
+            throw std::invalid_argument("The matrix product state only supports one and two qubit gates!");
+    }
+
+    return final_state;
+}
+
+// Friend function to evolve a sparse statevector, it switches to the dense layout by itself when it fills up
+SparseStatevector evolve(SparseStatevector &state, QuantumCircuit &circuit)
+{
+    SparseStatevector final_state = state;
+
+    for (auto op = circuit.gates.begin(); op != circuit.gates.end(); op++)
+    {
+        apply_gate(final_state, *op, circuit.matrices);
+    }
+
+    return final_state;
+}
+
+// Friend function to evolve a decision diagram, the multi-target single qubit gates are applied per target
+DecisionDiagram evolve(DecisionDiagram &state, QuantumCircuit &circuit)
+{
+    if (state.qubit_num() != circuit.qubit_n)
+        throw std::invalid_argument("The number of qubits of the state and the circuit are different!");
+
+    DecisionDiagram final_state = state;
+
+    for (auto op = circuit.gates.begin(); op != circuit.gates.end(); op++)
+    {
+        final_state.apply_gate(gate_qubits(*op), gate_core(*op, circuit.matrices));
+    }
+
+    return final_state;
+}
+
+// Friend function to append the gates of a circuit to a tensor network, nothing is contracted yet
+TensorNetwork evolve(TensorNetwork &state, QuantumCircuit &circuit)
+{
+    if (state.qubit_num() != circuit.qubit_n)
+        throw std::invalid_argument("The number of qubits of the state and the circuit are different!");
+
+    TensorNetwork final_state = state;
+
+    for (auto op = circuit.gates.begin(); op != circuit.gates.end(); op++)
+    {
+        final_state.add_gate(gate_qubits(*op), gate_core(*op, circuit.matrices));
+    }
+
+    return final_state;
+}
+
+// Friend function to append the gates of a circuit to a path sum, the paths are only summed by amplitude()
+FeynmanPathSum evolve(FeynmanPathSum &state, QuantumCircuit &circuit)
+{
+    if (state.qubit_num() != circuit.qubit_n)
+        throw std::invalid_argument("The number of qubits of the state and the circuit are different!");
+
+    FeynmanPathSum final_state = state;
+
+    for (auto op = circuit.gates.begin(); op != circuit.gates.end(); op++)
+    {
+        final_state.add_gate(gate_qubits(*op), gate_core(*op, circuit.matrices));
+    }
+
+    return final_state;
+}
+
+// Friend function to append the gates of a circuit to a hybrid simulator, the paths are only run by amplitudes()
+HybridSchrodingerFeynman evolve(HybridSchrodingerFeynman &state, QuantumCircuit &circuit)
+{
+    if (state.qubit_num() != circuit.qubit_n)
+        throw std::invalid_argument("The number of qubits of the state and the circuit are different!");
+
+    HybridSchrodingerFeynman final_state = state;
+
+    for (auto op = circuit.gates.begin(); op != circuit.gates.end(); op++)
+    {
+        final_state.add_gate(gate_qubits(*op), gate_core(*op, circuit.matrices));
+    }
+
+    return final_state;
+}
+
+// Friend function to evolve a factorized state, clusters are merged by the gates that entangle them
+FactorizedState evolve(FactorizedState &state, QuantumCircuit &circuit)
+{
+    if (state.qubit_num() != circuit.qubit_n)
+        throw std::invalid_argument("The number of qubits of the state and the circuit are different!");
+
+    FactorizedState final_state = state;
+
+    for (auto op = circuit.gates.begin(); op != circuit.gates.end(); op++)
+    {
+        final_state.apply_gate(gate_qubits(*op), gate_core(*op, circuit.matrices));
+    }
+
+    return final_state;
+}
+
+// Friend function to compile a circuit of X, Y, CNOT, Swap and diagonal gates for the reversible fast path
+ReversibleCircuit evolve(ReversibleCircuit &state, QuantumCircuit &circuit)
+{
+    if (state.qubit_num() != circuit.qubit_n)
+        throw std::invalid_argument("The number of qubits of the state and the circuit are different!");
+
+    ReversibleCircuit final_state = state;
+
+    for (auto op = circuit.gates.begin(); op != circuit.gates.end(); op++)
+    {
+        final_state.add_gate(gate_qubits(*op), gate_core(*op, circuit.matrices));
+    }
 
     return final_state;
 }
@@ -166,21 +682,28 @@ void QuantumCircuit::display_circuit()
     add_qubit_number(circuit_lines, qubit_n);
 
     /*
-        gates_targets example:
-        {0} Hadamard,
-        {1} Hadamard,
-        {0, 2} Swap
-        The order of gates_targets is the order of gates in the circuit from left to right
+        gates example:
+        {Hadamard, {0}},
+        {Hadamard, {1}, SAME_LAYER},
+        {Swap, {0, 2}}
+        The order of gates is the order of gates in the circuit from left to right,
+        the gates of one layer are drawn in the same column
     */
-    for (auto it = gates_targets.begin(); it != gates_targets.end(); it++)
+    for (auto it = gates.begin(); it != gates.end(); it++)
     {
-        std::vector<size_t> qubit_eff = it->first;
-        QuantumGate gate = it->second;
+        std::vector<size_t> qubit_eff = gate_qubits(*it);
+        const QuantumGate::Type type = gate_type(*it);
+        while (type == QuantumGate::Type::Hadamard && it + 1 != gates.end() &&
+               it[1].code == GateCode::Hadamard && (it[1].flags & GateOp::SAME_LAYER))
+        {
+            it++;
+            qubit_eff.push_back(it->qubits[0]);
+        }
 
         // Add wire at the beginning of each gate
         add_wire(circuit_lines, 2);
 
-        if (gate.get_type() == QuantumGate::Type::Hadamard)
+        if (type == QuantumGate::Type::Hadamard)
         {
             if (qubit_eff.size() == 1)
             {
@@ -234,8 +757,11 @@ void QuantumCircuit::display_circuit()
         qubit_eff[0] is the controlled qubit
         qubit_eff[1] is the target qubit
         */
-        if (gate.get_type() == QuantumGate::Type::CNOT)
+        if (type == QuantumGate::Type::CNOT || type == QuantumGate::Type::ControlledPhase)
         {
+            // The controlled phase is symmetric, both of its qubits are drawn as controls
+            const std::string target_symbol = type == QuantumGate::Type::CNOT ? CIRCUIT_SYMBOLS::TARGET : CIRCUIT_SYMBOLS::CONTROL;
+
             // e.g. {0, 2} CNOT or {0, 4} CNOT
             if (qubit_eff[0] < qubit_eff[1])
             {
@@ -247,7 +773,7 @@ void QuantumCircuit::display_circuit()
                 circuit_lines[qubit_eff[0]].bottom += CIRCUIT_SYMBOLS::VERTICAL;
 
                 circuit_lines[qubit_eff[1]].upper += CIRCUIT_SYMBOLS::VERTICAL;
-                circuit_lines[qubit_eff[1]].middle += CIRCUIT_SYMBOLS::TARGET;
+                circuit_lines[qubit_eff[1]].middle += target_symbol;
                 circuit_lines[qubit_eff[1]].bottom += CIRCUIT_SYMBOLS::SPACE;
 
                 // Step 4: Draw additional vertical lines between qubit_eff[0] and qubit_eff[1]
@@ -285,7 +811,7 @@ void QuantumCircuit::display_circuit()
             {
                 // Draw symbols at qubit_eff[0] and qubit_eff[1]
                 circuit_lines[qubit_eff[1]].upper += CIRCUIT_SYMBOLS::SPACE;
-                circuit_lines[qubit_eff[1]].middle += CIRCUIT_SYMBOLS::TARGET;
+                circuit_lines[qubit_eff[1]].middle += target_symbol;
                 circuit_lines[qubit_eff[1]].bottom += CIRCUIT_SYMBOLS::VERTICAL;
 
                 circuit_lines[qubit_eff[0]].upper += CIRCUIT_SYMBOLS::VERTICAL;
@@ -328,7 +854,7 @@ void QuantumCircuit::display_circuit()
             }
         }
 
-        if (gate.get_type() == QuantumGate::Type::Swap)
+        if (type == QuantumGate::Type::Swap)
         {
             // e.g. {0, 2} Swap
             // 0 is qubit_above, 2 is qubit_below
@@ -371,19 +897,19 @@ void QuantumCircuit::display_circuit()
             }
         }
 
-        if (gate.get_type() == QuantumGate::Type::PauliX ||
-            gate.get_type() == QuantumGate::Type::PauliY ||
-            gate.get_type() == QuantumGate::Type::PauliZ)
+        if (type == QuantumGate::Type::PauliX ||
+            type == QuantumGate::Type::PauliY ||
+            type == QuantumGate::Type::PauliZ)
         {
             if (qubit_eff.size() == 1)
             {
                 circuit_lines[qubit_eff[0]].upper += CIRCUIT_SYMBOLS::BOX_TOP;
 
-                if (gate.get_type() == QuantumGate::Type::PauliX)
+                if (type == QuantumGate::Type::PauliX)
                     circuit_lines[qubit_eff[0]].middle += CIRCUIT_SYMBOLS::BOX_MIDDLE_PX;
-                else if (gate.get_type() == QuantumGate::Type::PauliY)
+                else if (type == QuantumGate::Type::PauliY)
                     circuit_lines[qubit_eff[0]].middle += CIRCUIT_SYMBOLS::BOX_MIDDLE_PY;
-                else if (gate.get_type() == QuantumGate::Type::PauliZ)
+                else if (type == QuantumGate::Type::PauliZ)
                     circuit_lines[qubit_eff[0]].middle += CIRCUIT_SYMBOLS::BOX_MIDDLE_PZ;
 
                 circuit_lines[qubit_eff[0]].bottom += CIRCUIT_SYMBOLS::BOX_BOTTOM;
@@ -402,7 +928,7 @@ void QuantumCircuit::display_circuit()
             }
         }
 
-        if (gate.get_type() == QuantumGate::Type::Phase)
+        if (type == QuantumGate::Type::Phase)
         {
             circuit_lines[qubit_eff[0]].upper += CIRCUIT_SYMBOLS::BOX_TOP;
             circuit_lines[qubit_eff[0]].middle += CIRCUIT_SYMBOLS::BOX_MIDDLE_PHASE;
@@ -428,10 +954,15 @@ void QuantumCircuit::display_circuit()
 
 void QuantumCircuit::show_gate_list() const
 {
-    for (auto it = gates_targets.begin(); it != gates_targets.end(); it++)
+    for (auto it = gates.begin(); it != gates.end(); it++)
     {
-        std::vector<size_t> qubit_eff = it->first;
-        QuantumGate gate = it->second;
+        std::vector<size_t> qubit_eff = gate_qubits(*it);
+        while (it->code == GateCode::Hadamard && it + 1 != gates.end() &&
+               it[1].code == GateCode::Hadamard && (it[1].flags & GateOp::SAME_LAYER))
+        {
+            it++;
+            qubit_eff.push_back(it->qubits[0]);
+        }
 
         std::cout << "{ ";
         for (auto it2 = qubit_eff.begin(); it2 != qubit_eff.end(); it2++)
@@ -440,7 +971,7 @@ void QuantumCircuit::show_gate_list() const
         }
         std::cout << "} ";
 
-        std::cout << gate.get_type() << std::endl;
+        std::cout << gate_type(*it) << std::endl;
     }
 }
 
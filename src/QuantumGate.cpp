@@ -1,4 +1,5 @@
 #include "../include/QuantumGate.hpp"
+#include "../include/MatrixKernels.hpp"
 
 QuantumGate::QuantumGate()
 {
@@ -33,15 +34,29 @@ rows(size_), cols(size_), type(type_)
     this->round();
 }
 
+QuantumGate::QuantumGate(Type type_, SparseMatrix matrix_) :
+rows(matrix_.rows), cols(matrix_.cols), type(type_)
+{
+    sparse = std::make_unique<SparseMatrix>(std::move(matrix_));
+    this->round();
+}
+
 // Copy constructor
 QuantumGate::QuantumGate(const QuantumGate &q) :
 rows(q.rows), cols(q.cols), type(q.type)
 {
-    array = std::make_unique<std::complex<double>[]>(rows * cols);
-
-    for (size_t i = 0; i < rows * cols; i++)
+    if (q.is_sparse())
     {
-        array[i] = q.array[i];
+        sparse = std::make_unique<SparseMatrix>(*q.sparse);
+    }
+    else
+    {
+        array = std::make_unique<std::complex<double>[]>(rows * cols);
+
+        for (size_t i = 0; i < rows * cols; i++)
+        {
+            array[i] = q.array[i];
+        }
     }
 
     this->round();
@@ -55,11 +70,20 @@ QuantumGate &QuantumGate::operator=(const QuantumGate &q)
         rows = q.rows;
         cols = q.cols;
         type = q.type;
-        array = std::make_unique<std::complex<double>[]>(rows * cols);
-
-        for (size_t i = 0; i < rows * cols; i++)
+        if (q.is_sparse())
         {
-            array[i] = q.array[i];
+            array = nullptr;
+            sparse = std::make_unique<SparseMatrix>(*q.sparse);
+        }
+        else
+        {
+            sparse = nullptr;
+            array = std::make_unique<std::complex<double>[]>(rows * cols);
+
+            for (size_t i = 0; i < rows * cols; i++)
+            {
+                array[i] = q.array[i];
+            }
         }
     }
 
@@ -69,7 +93,7 @@ QuantumGate &QuantumGate::operator=(const QuantumGate &q)
 
 // Move constructor
 QuantumGate::QuantumGate(QuantumGate &&q) :
-rows(std::move(q.rows)), cols(std::move(q.cols)), type(std::move(q.type)), array(std::move(q.array))
+rows(std::move(q.rows)), cols(std::move(q.cols)), type(std::move(q.type)), array(std::move(q.array)), sparse(std::move(q.sparse))
 {}
 
 // Move assignment operator
@@ -81,6 +105,7 @@ QuantumGate &QuantumGate::operator=(QuantumGate &&q)
         cols = std::move(q.cols);
         type = std::move(q.type);
         array = std::move(q.array);
+        sparse = std::move(q.sparse);
     }
 
     this->round();
@@ -90,15 +115,45 @@ QuantumGate &QuantumGate::operator=(QuantumGate &&q)
 // Overload () operator
 std::complex<double> &QuantumGate::operator()(size_t row, size_t col)
 {
+    if (is_sparse())
+        make_dense();
     return array[(row - 1) * cols + col - 1];
 }
 
 // Overload () operator for const objects
 const std::complex<double> &QuantumGate::operator()(size_t row, size_t col) const
 {
+    if (is_sparse())
+    {
+        static const std::complex<double> zero{0.0, 0.0};
+        const std::complex<double> *entry = sparse->find(row - 1, col - 1);
+        return entry != nullptr ? *entry : zero;
+    }
     return array[(row - 1) * cols + col - 1];
 }
 
+size_t QuantumGate::nonzeros() const
+{
+    return is_sparse() ? sparse->nonzeros() : rows * cols;
+}
+
+void QuantumGate::make_sparse()
+{
+    if (is_sparse())
+        return;
+    sparse = std::make_unique<SparseMatrix>(dense_to_sparse(array.get(), rows, cols));
+    array = nullptr;
+}
+
+void QuantumGate::make_dense()
+{
+    if (!is_sparse())
+        return;
+    array = std::make_unique<std::complex<double>[]>(rows * cols);
+    sparse_to_dense(*sparse, array.get());
+    sparse = nullptr;
+}
+
 // Overload operators
 QuantumGate QuantumGate::operator+(const QuantumGate &q) const
 {
@@ -129,9 +184,9 @@ QuantumGate QuantumGate::operator-(const QuantumGate &q) const
 
     QuantumGate result(this->rows);
 
-    for (size_t i = 0; i < result.rows; i++)
+    for (size_t i = 1; i <= result.rows; i++)
     {
-        for (size_t j = 0; j < result.cols; j++)
+        for (size_t j = 1; j <= result.cols; j++)
         {
             result(i, j) = (*this)(i, j) - q(i, j);
         }
@@ -148,26 +203,34 @@ QuantumGate QuantumGate::operator*(const QuantumGate &q) const
         throw("incompatible dimensions");
     }
 
-    QuantumGate result(this->rows);
-
-    for (size_t i = 1; i <= result.rows; i++)
+    if (is_sparse() && q.is_sparse())
+        return QuantumGate(Type::Custom, sparse_product(*sparse, *q.sparse));
+    if (is_sparse() || q.is_sparse())
     {
-        for (size_t j = 1; j <= result.cols; j++)
-        {
-            std::complex<double> sum{0.0, 0.0};
-            for (size_t k = 1; k <= this->cols; k++)
-            {
-                sum += (*this)(i, k) * q(k, j);
-            }
-            result(i, j) = sum;
-        }
+        // A sparse gate times a dense one is dense in general
+        QuantumGate a{*this}, b{q};
+        a.make_dense();
+        b.make_dense();
+        return a * b;
     }
 
+    QuantumGate result(this->rows);
+    multiply_matrices(array.get(), q.array.get(), result.array.get(), rows);
+
     return result;
 }
 
 QuantumGate QuantumGate::operator*(const std::complex<double> &c) const
 {
+    if (is_sparse())
+    {
+        QuantumGate result{*this};
+        result.type = Type::Custom;
+        for (auto it = result.sparse->values.begin(); it != result.sparse->values.end(); it++)
+            *it *= c;
+        return result;
+    }
+
     QuantumGate result(this->rows);
 
     for (size_t i = 1; i <= result.rows; i++)
@@ -183,6 +246,14 @@ QuantumGate QuantumGate::operator*(const std::complex<double> &c) const
 
 QuantumGate QuantumGate::kronecker(const QuantumGate &q) const
 {
+    // If either factor is sparse, the product is built sparse
+    if (is_sparse() || q.is_sparse())
+    {
+        const SparseMatrix a = is_sparse() ? *sparse : dense_to_sparse(array.get(), rows, cols);
+        const SparseMatrix b = q.is_sparse() ? *q.sparse : dense_to_sparse(q.array.get(), q.rows, q.cols);
+        return QuantumGate(Type::Custom, sparse_kronecker(a, b));
+    }
+
     QuantumGate result(this->rows * q.rows);
 
     for (size_t i = 1; i <= this->rows; i++)
@@ -210,17 +281,18 @@ QuantumGate QuantumGate::operator+(QuantumGate &&q) const
         throw("incompatible dimensions");
     }
 
-    QuantumGate result(this->rows);
-
-    for (size_t i = 1; i <= result.rows; i++)
+    // The sum is written into the storage of the temporary q, no new matrix is allocated
+    q.make_dense();
+    q.type = Type::Custom;
+    for (size_t i = 1; i <= rows; i++)
     {
-        for (size_t j = 1; j <= result.cols; j++)
+        for (size_t j = 1; j <= cols; j++)
         {
-            result(i, j) = (*this)(i, j) + q(i, j);
+            q.array[(i - 1) * cols + j - 1] += (*this)(i, j);
         }
     }
 
-    return result;
+    return std::move(q);
 }
 
 QuantumGate QuantumGate::operator-(QuantumGate &&q) const
@@ -229,17 +301,19 @@ QuantumGate QuantumGate::operator-(QuantumGate &&q) const
     if (this->rows != q.rows || this->cols != q.cols)
         throw std::invalid_argument("QuantumGate dimensions must match for subtraction!");
 
-    QuantumGate result(this->rows);
-
-    for (size_t i = 0; i < result.rows; i++)
+    // The difference is written into the storage of the temporary q, no new matrix is allocated
+    q.make_dense();
+    q.type = Type::Custom;
+    for (size_t i = 1; i <= rows; i++)
     {
-        for (size_t j = 0; j < result.cols; j++)
+        for (size_t j = 1; j <= cols; j++)
         {
-            result(i, j) = (*this)(i, j) - q(i, j);
+            std::complex<double> &entry = q.array[(i - 1) * cols + j - 1];
+            entry = (*this)(i, j) - entry;
         }
     }
 
-    return result;
+    return std::move(q);
 }
 
 QuantumGate QuantumGate::operator*(QuantumGate &&q) const
@@ -250,22 +324,7 @@ QuantumGate QuantumGate::operator*(QuantumGate &&q) const
         throw("incompatible dimensions");
     }
 
-    QuantumGate result(this->rows);
-
-    for (size_t i = 1; i <= result.rows; i++)
-    {
-        for (size_t j = 1; j <= result.cols; j++)
-        {
-            std::complex<double> sum{0.0, 0.0};
-            for (size_t k = 1; k <= this->cols; k++)
-            {
-                sum += (*this)(i, k) * q(k, j);
-            }
-            result(i, j) = sum;
-        }
-    }
-
-    return result;
+    return (*this) * static_cast<const QuantumGate &>(q);
 }
 
 QuantumGate& QuantumGate::operator+=(const QuantumGate &q)
@@ -310,10 +369,12 @@ QuantumGate& QuantumGate::operator-=(const QuantumGate &q)
 std::vector<std::string> QuantumGate::to_string()
 {
     std::vector<std::string> matrix_strings;
+    const QuantumGate &gate = *this;
 
-    for (int i = 0; i < rows * cols; i++)
+    for (size_t i = 0; i < rows * cols; i++)
     {
-        std::string str = complex_to_str(array[i]);
+        std::complex<double> entry = gate(i / cols + 1, i % cols + 1);
+        std::string str = complex_to_str(entry);
         matrix_strings.push_back(str);
     }
 
@@ -374,15 +435,18 @@ void QuantumGate::display_matrix()
 
 void QuantumGate::round()
 {
-    for (int i = 0; i < rows * cols; i ++)
+    std::complex<double> *entries = is_sparse() ? sparse->values.data() : array.get();
+    const size_t entry_n = nonzeros();
+
+    for (size_t i = 0; i < entry_n; i ++)
     {
-        if (std::abs(array[i].real()) < ROUND_MINIMUM)
+        if (std::abs(entries[i].real()) < ROUND_MINIMUM)
         {
-            array[i] = std::complex<double>(0, array[i].imag());
+            entries[i] = std::complex<double>(0, entries[i].imag());
         }
-        if (std::abs(array[i].imag()) < ROUND_MINIMUM)
+        if (std::abs(entries[i].imag()) < ROUND_MINIMUM)
         {
-            array[i] = std::complex<double>(array[i].real(), 0);
+            entries[i] = std::complex<double>(entries[i].real(), 0);
         }
     }
 }
@@ -427,6 +491,11 @@ Statevector operator*(QuantumGate &q, Statevector &v)
         throw("matrix and vector sizes don't match");
     }
     Statevector result(std::log2(q.get_rows()));
+    if (q.is_sparse())
+    {
+        sparse_multiply(*q.get_sparse(), v.data(), result.data());
+        return result;
+    }
     for (size_t i = 0; i < q.get_rows(); i++)
     {
         for (size_t j = 0; j < q.get_cols(); j++)
@@ -464,6 +533,25 @@ QuantumGate dyad(Statevector &v1, Statevector &v2)
     return result;
 }
 
+QuantumGate embed_gate(size_t qubit_n, const std::vector<size_t> &qubits, const QuantumGate &core)
+{
+    if (core.get_rows() != 2)
+        throw std::invalid_argument("The core of an embedded gate must be a 2x2 gate!");
+
+    const SparseMatrix identity = sparse_identity(2);
+    const SparseMatrix factor = core.is_sparse() ? *core.get_sparse() : dense_to_sparse(&core(1, 1), 2, 2);
+
+    // Qubit 0 is the leftmost factor
+    SparseMatrix result = sparse_identity(1);
+    for (size_t q = 0; q < qubit_n; q++)
+    {
+        bool is_target = std::find(qubits.begin(), qubits.end(), q) != qubits.end();
+        result = sparse_kronecker(result, is_target ? factor : identity);
+    }
+
+    return QuantumGate(core.get_type(), std::move(result));
+}
+
 // Identity matrix
 QuantumGate Identity(size_t n)
 {
@@ -516,6 +604,9 @@ std::ostream& operator<<(std::ostream& os, const QuantumGate::Type& type)
         case QuantumGate::Type::Phase:
             os << "Phase";
             break;
+        case QuantumGate::Type::ControlledPhase:
+            os << "ControlledPhase";
+            break;
         case QuantumGate::Type::Identity:
             os << "Identity";
             break;
@@ -1,32 +1,28 @@
 #include "../../include/QuantumGates/CNOT.hpp"
 
-CNOT::CNOT()
+CNOT::CNOT() : QuantumGate{QuantumGate::CNOT4x4}
 {
-    QuantumGate{QuantumGate::CNOT4x4};
     qubits = 2;
     control_qubit = 0;
     target_qubit = 1;
 }
 
+/*
+The CNOT gate is a permutation matrix: row i has a single 1 in column i if the control bit of i is 0,
+and in column i with the target bit flipped otherwise.
+The entries are therefore written directly instead of summing 2^n dyads of the standard basis, and the
+gate is stored sparse (O(2^n) memory).
+*/
 CNOT::CNOT(size_t qubits_, size_t control_qubit_, size_t target_qubit_)
-    : QuantumGate(Zeros(qubits_)), qubits(qubits_), control_qubit(control_qubit_), target_qubit(target_qubit_)
+    : QuantumGate(Type::CNOT, sparse_identity(size_t(1) << qubits_)), qubits(qubits_), control_qubit(control_qubit_), target_qubit(target_qubit_)
 {
-    auto basis = generate_std_basis(qubits);
-    QuantumGate res = Zeros(qubits);
+    const size_t control_mask = qubit_stride(qubits, control_qubit);
+    const size_t target_mask = qubit_stride(qubits, target_qubit);
 
-    for (auto it = basis.begin(); it != basis.end(); it++)
+    // One nonzero per row, the identity with the columns of the rows with the control bit set permuted
+    for (size_t i = 0; i < rows; i++)
     {
-        if (it->first.at(control_qubit) == '1')
-        {
-            std::string temp = it->first;
-            temp.at(target_qubit) = (temp.at(target_qubit) == '0') ? '1' : '0';
-            res = res + dyad(basis[it->first], basis[temp]);
-        }
-        else
-        {
-            res = res + dyad(basis[it->first], basis[it->first]);
-        }
+        size_t col = (i & control_mask) ? (i ^ target_mask) : i;
+        sparse->col_index[i] = col;
     }
-    QuantumGate::operator=(res);
-    this->set_type(Type::CNOT);
 }
@@ -0,0 +1,12 @@
+#include "../../include/QuantumGates/ControlledPhase.hpp"
+
+ControlledPhase::ControlledPhase() :
+ControlledPhase(0.0)
+{}
+
+ControlledPhase::ControlledPhase(double phase_) :
+phase(phase_), QuantumGate{Type::ControlledPhase, 4, {1, 0, 0, 0,
+                                                      0, 1, 0, 0,
+                                                      0, 0, 1, 0,
+                                                      0, 0, 0, std::exp(std::complex<double>(0, phase_))}}
+{}
@@ -8,28 +8,11 @@ Phase::Phase()
     phase = 0;
 }
 
+Phase::Phase(double phase_) :
+phase(phase_), QuantumGate{Type::Phase, 2, {1, 0, 0, std::exp(std::complex<double>(0, phase_))}}
+{}
 
+// The embedded gate I ⊗ .. ⊗ P ⊗ .. ⊗ I is diagonal, stored sparse with one nonzero per row.
 Phase::Phase(size_t qubit_n_, size_t qubit_eff_, double phase_) :
-phase(phase_), QuantumGate{Zeros(qubit_n_)}
-{  
-    QuantumGate res{QuantumGate::Identity2x2};
-    QuantumGate Phase2x2{Type::Phase, 2, {1, 0, 0, std::exp(std::complex<double>(0, phase))}};
-
-    if (qubit_eff_ == 0)
-    {
-        res(2, 2) = std::exp(std::complex<double>(0, phase));
-        QuantumGate::operator=(res);
-        this->set_type(Type::Phase);
-        return;
-    }
-    for (int i = 1; i < qubit_n_; i++)
-    {
-        if (i == qubit_eff_)
-            res = res.kronecker(Phase2x2);
-        else
-            res = res.kronecker(QuantumGate::Identity2x2);
-    }
-
-    QuantumGate::operator=(res);
-    this->set_type(Type::Phase);
-}
\ No newline at end of file
+phase(phase_), QuantumGate{embed_gate(qubit_n_, {qubit_eff_}, Phase{phase_})}
+{}
@@ -1,33 +1,27 @@
 #include "../../include/QuantumGates/Swap.hpp"
 
-Swap::Swap()
+Swap::Swap() : QuantumGate{QuantumGate::SWAP4x4}
 {
-    this->set_type(Type::Swap);
-    QuantumGate{QuantumGate::SWAP4x4};
     swap_q1 = 0;
     swap_q2 = 1;
 }
 
+/*
+The Swap gate is a permutation matrix: row i has a single 1 in the column obtained by exchanging
+the bits of swap_q1 and swap_q2 in i. If the two bits are equal, the column is i itself.
+The gate is stored sparse, one nonzero per row.
+*/
 Swap::Swap(size_t qubit_n_, size_t swap_q1_, size_t swap_q2_)
-    : QuantumGate(Zeros(qubit_n_)), swap_q1(swap_q1_), swap_q2(swap_q2_)
+    : QuantumGate(Type::Swap, sparse_identity(size_t(1) << qubit_n_)), swap_q1(swap_q1_), swap_q2(swap_q2_)
 {
-    auto basis = generate_std_basis(qubit_n_);
-    QuantumGate res = Zeros(qubit_n_);
+    const size_t mask1 = qubit_stride(qubit_n_, swap_q1);
+    const size_t mask2 = qubit_stride(qubit_n_, swap_q2);
 
-    for (auto it = basis.begin(); it != basis.end(); it++)
+    for (size_t i = 0; i < rows; i++)
     {
-        if (it->first.at(swap_q1) == it->first.at(swap_q2))
-        {
-            res = res + dyad(basis[it->first], basis[it->first]);
-        }
-        else
-        {
-            std::string temp = it->first;
-            temp.at(swap_q1) = it->first.at(swap_q2);
-            temp.at(swap_q2) = it->first.at(swap_q1);
-            res = res + dyad(basis[it->first], basis[temp]);
-        }
+        bool bit1 = (i & mask1) != 0;
+        bool bit2 = (i & mask2) != 0;
+        size_t col = (bit1 != bit2) ? (i ^ mask1 ^ mask2) : i;
+        sparse->col_index[i] = col;
     }
-    QuantumGate::operator=(res);
-    this->set_type(Type::Swap);
-}
\ No newline at end of file
+}
@@ -0,0 +1,292 @@
+#include "../include/ReversibleCircuit.hpp"
+#include <cmath>
+
+// Entries closer than this to 0 are zero, moduli closer than this to 1 are phases
+static const double REVERSIBLE_TOLERANCE = 1e-10;
+// Inputs per bit slice, and 64 bit words per slice
+static const size_t SLICE_INPUTS = 256;
+static const size_t SLICE_WORDS = SLICE_INPUTS / 64;
+// Bits of the bit-sliced counters, enough for 2^32 phase gates
+static const size_t COUNTER_BITS = 32;
+
+static bool is_phase(std::complex<double> c)
+{
+    return std::abs(std::abs(c) - 1.0) < REVERSIBLE_TOLERANCE;
+}
+
+static bool is_zero(std::complex<double> c)
+{
+    return std::abs(c) < REVERSIBLE_TOLERANCE;
+}
+
+// The angle reduced to (-pi, pi]
+static double reduce_angle(double angle)
+{
+    angle = std::remainder(angle, 2.0 * M_PI);
+    return angle <= -M_PI ? angle + 2.0 * M_PI : angle;
+}
+
+ReversibleCircuit::ReversibleCircuit(size_t qubit_n_) :
+qubit_n(qubit_n_)
+{
+    if (qubit_n == 0 || qubit_n > MAX_QUBITS)
+        throw std::invalid_argument("The reversible fast path supports 1 to 256 qubits!");
+}
+
+bool ReversibleCircuit::is_reversible(const QuantumGate &gate)
+{
+    switch (gate.get_type())
+    {
+    case QuantumGate::Type::PauliX:
+    case QuantumGate::Type::PauliY:
+    case QuantumGate::Type::PauliZ:
+    case QuantumGate::Type::Phase:
+    case QuantumGate::Type::Identity:
+    case QuantumGate::Type::CNOT:
+    case QuantumGate::Type::Swap:
+    case QuantumGate::Type::ControlledPhase:
+        return true;
+    case QuantumGate::Type::Custom:
+        if (gate.get_rows() != 2)
+            return false;
+        // Diagonal or anti-diagonal, with entries of modulus 1
+        if (is_zero(gate(1, 2)) && is_zero(gate(2, 1)))
+            return is_phase(gate(1, 1)) && is_phase(gate(2, 2));
+        if (is_zero(gate(1, 1)) && is_zero(gate(2, 2)))
+            return is_phase(gate(1, 2)) && is_phase(gate(2, 1));
+        return false;
+    default:
+        return false;
+    }
+}
+
+void ReversibleCircuit::add_gate(const std::vector<size_t> &qubits, const QuantumGate &gate)
+{
+    if (!is_reversible(gate))
+        throw std::invalid_argument("The gate does not map basis states to basis states!");
+    if (gate.get_rows() != (size_t(1) << qubits.size()))
+        throw std::invalid_argument("The size of the gate does not match the number of target qubits!");
+    for (auto q = qubits.begin(); q != qubits.end(); q++)
+        if (*q >= qubit_n)
+            throw std::invalid_argument("The target qubit is out of range!");
+
+    ReversibleOp op{ReversibleOp::Kind::Phase, qubits[0], 0, 0.0, 0.0, NO_COUNTER};
+    if (gate.get_type() == QuantumGate::Type::CNOT || gate.get_type() == QuantumGate::Type::Swap)
+    {
+        if (qubits[0] == qubits[1])
+            throw std::invalid_argument("The target qubits must be different!");
+        op.kind = gate.get_type() == QuantumGate::Type::CNOT ? ReversibleOp::Kind::CNOT : ReversibleOp::Kind::Swap;
+        op.b = qubits[1];
+        ops.push_back(op);
+        return;
+    }
+
+    if (gate.get_type() == QuantumGate::Type::ControlledPhase)
+    {
+        if (qubits[0] == qubits[1])
+            throw std::invalid_argument("The target qubits must be different!");
+        op.kind = ReversibleOp::Kind::ControlledPhase;
+        op.b = qubits[1];
+        op.angle1 = std::arg(gate(4, 4));
+    }
+    else if (is_zero(gate(1, 1)))
+    {
+        // Anti-diagonal: |0> -> gate(2, 1) |1>, |1> -> gate(1, 2) |0>
+        op.kind = ReversibleOp::Kind::Flip;
+        op.angle0 = std::arg(gate(2, 1));
+        op.angle1 = std::arg(gate(1, 2));
+    }
+    else
+    {
+        op.angle0 = std::arg(gate(1, 1));
+        op.angle1 = std::arg(gate(2, 2));
+        if (reduce_angle(op.angle0) == 0.0 && reduce_angle(op.angle1) == 0.0)
+            return;
+    }
+
+    // The inputs with the bit set get angle1 - angle0 more than the others, counted per distinct difference
+    const double difference = reduce_angle(op.angle1 - op.angle0);
+    if (std::abs(difference) > REVERSIBLE_TOLERANCE && std::abs(difference - M_PI) > REVERSIBLE_TOLERANCE)
+    {
+        for (op.counter = 0; op.counter < counter_angles.size(); op.counter++)
+            if (std::abs(counter_angles[op.counter] - difference) < REVERSIBLE_TOLERANCE)
+                break;
+        if (op.counter == counter_angles.size())
+            counter_angles.push_back(difference);
+    }
+    ops.push_back(op);
+}
+
+// A register of Words machine words, qubit q is bit q % 64 of word q / 64
+template <size_t Words>
+struct BitRegister
+{
+    uint64_t words[Words];
+
+    uint64_t get(size_t q) const { return (words[q >> 6] >> (q & 63)) & 1; }
+    void flip(size_t q) { words[q >> 6] ^= uint64_t(1) << (q & 63); }
+};
+
+template <size_t Words>
+std::pair<std::string, std::complex<double>> ReversibleCircuit::run_register(const std::string &input) const
+{
+    BitRegister<Words> reg;
+    for (size_t w = 0; w < Words; w++)
+        reg.words[w] = 0;
+    for (size_t q = 0; q < qubit_n; q++)
+        if (input[q] == '1')
+            reg.flip(q);
+
+    double angle = 0.0;
+    for (auto op = ops.begin(); op != ops.end(); op++)
+    {
+        switch (op->kind)
+        {
+        case ReversibleOp::Kind::Flip:
+            angle += reg.get(op->a) ? op->angle1 : op->angle0;
+            reg.flip(op->a);
+            break;
+        case ReversibleOp::Kind::Phase:
+            angle += reg.get(op->a) ? op->angle1 : op->angle0;
+            break;
+        case ReversibleOp::Kind::ControlledPhase:
+            angle += reg.get(op->a) & reg.get(op->b) ? op->angle1 : op->angle0;
+            break;
+        case ReversibleOp::Kind::CNOT:
+            if (reg.get(op->a))
+                reg.flip(op->b);
+            break;
+        case ReversibleOp::Kind::Swap:
+            if (reg.get(op->a) != reg.get(op->b))
+            {
+                reg.flip(op->a);
+                reg.flip(op->b);
+            }
+            break;
+        }
+    }
+
+    std::string output(qubit_n, '0');
+    for (size_t q = 0; q < qubit_n; q++)
+        output[q] = reg.get(q) ? '1' : '0';
+    return std::make_pair(output, std::polar(1.0, reduce_angle(angle)));
+}
+
+std::pair<std::string, std::complex<double>> ReversibleCircuit::run(const std::string &input) const
+{
+    if (input.length() != qubit_n)
+        throw std::invalid_argument("The length of the state must be equal to the number of qubits!");
+    for (auto it = input.begin(); it != input.end(); it++)
+        if (*it != '0' && *it != '1')
+            throw std::invalid_argument("The state can only contain binary digits!");
+
+    if (qubit_n <= 64)
+        return run_register<1>(input);
+    if (qubit_n <= 128)
+        return run_register<2>(input);
+    return run_register<4>(input);
+}
+
+std::vector<std::pair<std::string, std::complex<double>>> ReversibleCircuit::run_batch(const std::vector<std::string> &inputs) const
+{
+    for (auto it = inputs.begin(); it != inputs.end(); it++)
+    {
+        if (it->length() != qubit_n)
+            throw std::invalid_argument("The length of the state must be equal to the number of qubits!");
+        for (auto c = it->begin(); c != it->end(); c++)
+            if (*c != '0' && *c != '1')
+                throw std::invalid_argument("The state can only contain binary digits!");
+    }
+
+    std::vector<std::pair<std::string, std::complex<double>>> outputs;
+    // slices[q * SLICE_WORDS + w]: bit j of word w is qubit q of input 64 w + j
+    std::vector<uint64_t> slices(qubit_n * SLICE_WORDS);
+    std::vector<uint64_t> counters(counter_angles.size() * COUNTER_BITS * SLICE_WORDS);
+    for (size_t first = 0; first < inputs.size(); first += SLICE_INPUTS)
+    {
+        const size_t input_n = std::min(SLICE_INPUTS, inputs.size() - first);
+        std::fill(slices.begin(), slices.end(), 0);
+        std::fill(counters.begin(), counters.end(), 0);
+        for (size_t j = 0; j < input_n; j++)
+            for (size_t q = 0; q < qubit_n; q++)
+                if (inputs[first + j][q] == '1')
+                    slices[q * SLICE_WORDS + j / 64] |= uint64_t(1) << (j % 64);
+
+        // The phase of every input is base + pi * sign + the sum of the counted differences
+        double base = 0.0;
+        uint64_t sign[SLICE_WORDS] = {0};
+        for (auto op = ops.begin(); op != ops.end(); op++)
+        {
+            uint64_t *a = &slices[op->a * SLICE_WORDS];
+            uint64_t *b = &slices[op->b * SLICE_WORDS];
+            switch (op->kind)
+            {
+            case ReversibleOp::Kind::Flip:
+            case ReversibleOp::Kind::Phase:
+            case ReversibleOp::Kind::ControlledPhase:
+            {
+                // The inputs that get angle1 instead of angle0
+                uint64_t selected[SLICE_WORDS];
+                for (size_t w = 0; w < SLICE_WORDS; w++)
+                    selected[w] = op->kind == ReversibleOp::Kind::ControlledPhase ? a[w] & b[w] : a[w];
+
+                base += op->angle0;
+                if (op->counter != NO_COUNTER)
+                {
+                    // Add the selected inputs to the counter, a ripple carry over its bit slices
+                    uint64_t *counter = &counters[op->counter * COUNTER_BITS * SLICE_WORDS];
+                    for (size_t w = 0; w < SLICE_WORDS; w++)
+                    {
+                        uint64_t carry = selected[w];
+                        for (size_t k = 0; k < COUNTER_BITS && carry; k++)
+                        {
+                            const uint64_t next = counter[k * SLICE_WORDS + w] & carry;
+                            counter[k * SLICE_WORDS + w] ^= carry;
+                            carry = next;
+                        }
+                    }
+                }
+                else if (std::abs(reduce_angle(op->angle1 - op->angle0)) > REVERSIBLE_TOLERANCE)
+                {
+                    // A difference of pi flips the sign of the inputs with the bit set
+                    for (size_t w = 0; w < SLICE_WORDS; w++)
+                        sign[w] ^= selected[w];
+                }
+                if (op->kind == ReversibleOp::Kind::Flip)
+                {
+                    for (size_t w = 0; w < SLICE_WORDS; w++)
+                        a[w] = ~a[w];
+                }
+                break;
+            }
+            case ReversibleOp::Kind::CNOT:
+                for (size_t w = 0; w < SLICE_WORDS; w++)
+                    b[w] ^= a[w];
+                break;
+            case ReversibleOp::Kind::Swap:
+                for (size_t w = 0; w < SLICE_WORDS; w++)
+                    std::swap(a[w], b[w]);
+                break;
+            }
+        }
+
+        for (size_t j = 0; j < input_n; j++)
+        {
+            const size_t w = j / 64, bit = j % 64;
+            std::string output(qubit_n, '0');
+            for (size_t q = 0; q < qubit_n; q++)
+                output[q] = (slices[q * SLICE_WORDS + w] >> bit) & 1 ? '1' : '0';
+
+            double angle = base + (((sign[w] >> bit) & 1) ? M_PI : 0.0);
+            for (size_t c = 0; c < counter_angles.size(); c++)
+            {
+                uint64_t count = 0;
+                for (size_t k = 0; k < COUNTER_BITS; k++)
+                    count |= ((counters[(c * COUNTER_BITS + k) * SLICE_WORDS + w] >> bit) & 1) << k;
+                angle += counter_angles[c] * double(count);
+            }
+            outputs.push_back(std::make_pair(output, std::polar(1.0, reduce_angle(angle))));
+        }
+    }
+    return outputs;
+}
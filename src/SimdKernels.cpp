@@ -0,0 +1,470 @@
+#include "../include/SimdKernels.hpp"
+
+/*
+The SIMD versions are compiled with function level target attributes, so no -mavx2 / -mavx512f flag is
+needed and the rest of the program stays runnable on older CPUs. They are only called after the
+runtime check in detect_simd_level().
+*/
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define QC_SIMD_X86 1
+#include <immintrin.h>
+#define QC_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define QC_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+std::ostream &operator<<(std::ostream &os, const SimdLevel &level)
+{
+    switch (level)
+    {
+    case SimdLevel::Scalar:
+        os << "Scalar";
+        break;
+    case SimdLevel::AVX2:
+        os << "AVX2";
+        break;
+    case SimdLevel::AVX512:
+        os << "AVX512";
+        break;
+    }
+    return os;
+}
+
+SimdLevel detect_simd_level()
+{
+#ifdef QC_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SimdLevel::AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return SimdLevel::AVX2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+static SimdLevel &current_simd_level()
+{
+    static SimdLevel level = detect_simd_level();
+    return level;
+}
+
+SimdLevel get_simd_level()
+{
+    return current_simd_level();
+}
+
+// The level can only be lowered below what the CPU supports, a higher request is capped.
+void set_simd_level(SimdLevel level)
+{
+    current_simd_level() = std::min(level, detect_simd_level());
+}
+
+// Width in doubles of a register for the given level
+static size_t simd_width(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::AVX512:
+        return 8;
+    case SimdLevel::AVX2:
+        return 4;
+    default:
+        return 1;
+    }
+}
+
+/*
+The loops below process the amplitude pairs k = begin .. end - 1 of a gate on the given bit, the first
+amplitude of pair k being insert_zero_bit(k, bit) and the second one stride = 2^bit further.
+m holds the matrix as {m00.re, m00.im, m01.re, m01.im, m10.re, m10.im, m11.re, m11.im}.
+*/
+static void scalar_single_qubit(double *re, double *im, size_t begin, size_t end, size_t bit, const double *m)
+{
+    const size_t stride = static_cast<size_t>(1) << bit;
+    for (size_t k = begin; k < end; k++)
+    {
+        const size_t i = insert_zero_bit(k, bit);
+        const double a0r = re[i], a0i = im[i];
+        const double a1r = re[i + stride], a1i = im[i + stride];
+        re[i] = m[0] * a0r - m[1] * a0i + m[2] * a1r - m[3] * a1i;
+        im[i] = m[0] * a0i + m[1] * a0r + m[2] * a1i + m[3] * a1r;
+        re[i + stride] = m[4] * a0r - m[5] * a0i + m[6] * a1r - m[7] * a1i;
+        im[i + stride] = m[4] * a0i + m[5] * a0r + m[6] * a1i + m[7] * a1r;
+    }
+}
+
+/*
+Multiply the amplitudes begin .. end - 1 with the qubit in |0> by d0 and the ones in |1> by d1,
+d = {d0.re, d0.im, d1.re, d1.im}, mask = 2^bit.
+*/
+static void scalar_diagonal(double *re, double *im, size_t begin, size_t end, size_t mask, const double *d)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        const double *di = (i & mask) ? d + 2 : d;
+        const double ar = re[i], ai = im[i];
+        re[i] = di[0] * ar - di[1] * ai;
+        im[i] = di[0] * ai + di[1] * ar;
+    }
+}
+
+#ifdef QC_SIMD_X86
+
+QC_TARGET_AVX2 static void avx2_single_qubit(double *re, double *im, size_t begin, size_t end, size_t bit, const double *m)
+{
+    const size_t stride = static_cast<size_t>(1) << bit;
+    const __m256d m00r = _mm256_set1_pd(m[0]), m00i = _mm256_set1_pd(m[1]);
+    const __m256d m01r = _mm256_set1_pd(m[2]), m01i = _mm256_set1_pd(m[3]);
+    const __m256d m10r = _mm256_set1_pd(m[4]), m10i = _mm256_set1_pd(m[5]);
+    const __m256d m11r = _mm256_set1_pd(m[6]), m11i = _mm256_set1_pd(m[7]);
+
+    // stride >= 4, so pairs k .. k + 3 have contiguous first amplitudes
+    for (size_t k = begin; k < end; k += 4)
+    {
+        const size_t i = insert_zero_bit(k, bit);
+        const __m256d a0r = _mm256_load_pd(re + i), a0i = _mm256_load_pd(im + i);
+        const __m256d a1r = _mm256_load_pd(re + i + stride), a1i = _mm256_load_pd(im + i + stride);
+
+        __m256d n0r = _mm256_mul_pd(m00r, a0r);
+        n0r = _mm256_fnmadd_pd(m00i, a0i, n0r);
+        n0r = _mm256_fmadd_pd(m01r, a1r, n0r);
+        n0r = _mm256_fnmadd_pd(m01i, a1i, n0r);
+
+        __m256d n0i = _mm256_mul_pd(m00r, a0i);
+        n0i = _mm256_fmadd_pd(m00i, a0r, n0i);
+        n0i = _mm256_fmadd_pd(m01r, a1i, n0i);
+        n0i = _mm256_fmadd_pd(m01i, a1r, n0i);
+
+        __m256d n1r = _mm256_mul_pd(m10r, a0r);
+        n1r = _mm256_fnmadd_pd(m10i, a0i, n1r);
+        n1r = _mm256_fmadd_pd(m11r, a1r, n1r);
+        n1r = _mm256_fnmadd_pd(m11i, a1i, n1r);
+
+        __m256d n1i = _mm256_mul_pd(m10r, a0i);
+        n1i = _mm256_fmadd_pd(m10i, a0r, n1i);
+        n1i = _mm256_fmadd_pd(m11r, a1i, n1i);
+        n1i = _mm256_fmadd_pd(m11i, a1r, n1i);
+
+        _mm256_store_pd(re + i, n0r);
+        _mm256_store_pd(im + i, n0i);
+        _mm256_store_pd(re + i + stride, n1r);
+        _mm256_store_pd(im + i + stride, n1i);
+    }
+}
+
+QC_TARGET_AVX2 static void avx2_diagonal(double *re, double *im, size_t begin, size_t end, size_t mask, const double *d)
+{
+    const __m256d d0r = _mm256_set1_pd(d[0]), d0i = _mm256_set1_pd(d[1]);
+    const __m256d d1r = _mm256_set1_pd(d[2]), d1i = _mm256_set1_pd(d[3]);
+
+    // mask >= 4, so the 4 amplitudes loaded together share the same factor
+    for (size_t i = begin; i < end; i += 4)
+    {
+        const __m256d dr = (i & mask) ? d1r : d0r;
+        const __m256d di = (i & mask) ? d1i : d0i;
+        const __m256d ar = _mm256_load_pd(re + i), ai = _mm256_load_pd(im + i);
+        _mm256_store_pd(re + i, _mm256_fnmadd_pd(di, ai, _mm256_mul_pd(dr, ar)));
+        _mm256_store_pd(im + i, _mm256_fmadd_pd(di, ar, _mm256_mul_pd(dr, ai)));
+    }
+}
+
+QC_TARGET_AVX512 static void avx512_single_qubit(double *re, double *im, size_t begin, size_t end, size_t bit, const double *m)
+{
+    const size_t stride = static_cast<size_t>(1) << bit;
+    const __m512d m00r = _mm512_set1_pd(m[0]), m00i = _mm512_set1_pd(m[1]);
+    const __m512d m01r = _mm512_set1_pd(m[2]), m01i = _mm512_set1_pd(m[3]);
+    const __m512d m10r = _mm512_set1_pd(m[4]), m10i = _mm512_set1_pd(m[5]);
+    const __m512d m11r = _mm512_set1_pd(m[6]), m11i = _mm512_set1_pd(m[7]);
+
+    // stride >= 8, so pairs k .. k + 7 have contiguous first amplitudes
+    for (size_t k = begin; k < end; k += 8)
+    {
+        const size_t i = insert_zero_bit(k, bit);
+        const __m512d a0r = _mm512_load_pd(re + i), a0i = _mm512_load_pd(im + i);
+        const __m512d a1r = _mm512_load_pd(re + i + stride), a1i = _mm512_load_pd(im + i + stride);
+
+        __m512d n0r = _mm512_mul_pd(m00r, a0r);
+        n0r = _mm512_fnmadd_pd(m00i, a0i, n0r);
+        n0r = _mm512_fmadd_pd(m01r, a1r, n0r);
+        n0r = _mm512_fnmadd_pd(m01i, a1i, n0r);
+
+        __m512d n0i = _mm512_mul_pd(m00r, a0i);
+        n0i = _mm512_fmadd_pd(m00i, a0r, n0i);
+        n0i = _mm512_fmadd_pd(m01r, a1i, n0i);
+        n0i = _mm512_fmadd_pd(m01i, a1r, n0i);
+
+        __m512d n1r = _mm512_mul_pd(m10r, a0r);
+        n1r = _mm512_fnmadd_pd(m10i, a0i, n1r);
+        n1r = _mm512_fmadd_pd(m11r, a1r, n1r);
+        n1r = _mm512_fnmadd_pd(m11i, a1i, n1r);
+
+        __m512d n1i = _mm512_mul_pd(m10r, a0i);
+        n1i = _mm512_fmadd_pd(m10i, a0r, n1i);
+        n1i = _mm512_fmadd_pd(m11r, a1i, n1i);
+        n1i = _mm512_fmadd_pd(m11i, a1r, n1i);
+
+        _mm512_store_pd(re + i, n0r);
+        _mm512_store_pd(im + i, n0i);
+        _mm512_store_pd(re + i + stride, n1r);
+        _mm512_store_pd(im + i + stride, n1i);
+    }
+}
+
+QC_TARGET_AVX512 static void avx512_diagonal(double *re, double *im, size_t begin, size_t end, size_t mask, const double *d)
+{
+    const __m512d d0r = _mm512_set1_pd(d[0]), d0i = _mm512_set1_pd(d[1]);
+    const __m512d d1r = _mm512_set1_pd(d[2]), d1i = _mm512_set1_pd(d[3]);
+
+    // mask >= 8, so the 8 amplitudes loaded together share the same factor
+    for (size_t i = begin; i < end; i += 8)
+    {
+        const __m512d dr = (i & mask) ? d1r : d0r;
+        const __m512d di = (i & mask) ? d1i : d0i;
+        const __m512d ar = _mm512_load_pd(re + i), ai = _mm512_load_pd(im + i);
+        _mm512_store_pd(re + i, _mm512_fnmadd_pd(di, ai, _mm512_mul_pd(dr, ar)));
+        _mm512_store_pd(im + i, _mm512_fmadd_pd(di, ar, _mm512_mul_pd(dr, ai)));
+    }
+}
+
+#endif // QC_SIMD_X86
+
+void apply_single_qubit_gate(SplitStatevector &state, size_t qubit, const QuantumGate &core)
+{
+    if (core.get_rows() != 2 || core.get_cols() != 2)
+        throw std::invalid_argument("A single qubit gate core must be a 2x2 matrix!");
+    if (qubit >= state.qubit_num())
+        throw std::invalid_argument("Target qubit is out of range!");
+
+    const double m[8] = {core(1, 1).real(), core(1, 1).imag(), core(1, 2).real(), core(1, 2).imag(),
+                         core(2, 1).real(), core(2, 1).imag(), core(2, 2).real(), core(2, 2).imag()};
+    const size_t bit = state.qubit_num() - 1 - qubit;
+    const size_t stride = static_cast<size_t>(1) << bit;
+    double *re = state.real();
+    double *im = state.imag();
+
+    // Pick the widest version whose register fits into the stride
+    SimdLevel level = get_simd_level();
+    while (level != SimdLevel::Scalar && stride < simd_width(level))
+        level = (level == SimdLevel::AVX512) ? SimdLevel::AVX2 : SimdLevel::Scalar;
+
+    parallel_for(0, state.size() / 2, [=](size_t begin, size_t end)
+    {
+#ifdef QC_SIMD_X86
+        if (level == SimdLevel::AVX512)
+            return avx512_single_qubit(re, im, begin, end, bit, m);
+        if (level == SimdLevel::AVX2)
+            return avx2_single_qubit(re, im, begin, end, bit, m);
+#endif
+        scalar_single_qubit(re, im, begin, end, bit, m);
+    }, simd_width(level));
+}
+
+void apply_diagonal_gate(SplitStatevector &state, size_t qubit, std::complex<double> d0, std::complex<double> d1)
+{
+    if (qubit >= state.qubit_num())
+        throw std::invalid_argument("Target qubit is out of range!");
+
+    const double d[4] = {d0.real(), d0.imag(), d1.real(), d1.imag()};
+    const size_t mask = qubit_stride(state.qubit_num(), qubit);
+    double *re = state.real();
+    double *im = state.imag();
+
+    SimdLevel level = get_simd_level();
+    while (level != SimdLevel::Scalar && mask < simd_width(level))
+        level = (level == SimdLevel::AVX512) ? SimdLevel::AVX2 : SimdLevel::Scalar;
+
+    parallel_for(0, state.size(), [=](size_t begin, size_t end)
+    {
+#ifdef QC_SIMD_X86
+        if (level == SimdLevel::AVX512)
+            return avx512_diagonal(re, im, begin, end, mask, d);
+        if (level == SimdLevel::AVX2)
+            return avx2_diagonal(re, im, begin, end, mask, d);
+#endif
+        scalar_diagonal(re, im, begin, end, mask, d);
+    }, simd_width(level));
+}
+
+// The permutation kernels only move data, the same loops as in GateKernels.cpp on both buffers.
+void apply_pauli_x(SplitStatevector &state, size_t qubit)
+{
+    if (qubit >= state.qubit_num())
+        throw std::invalid_argument("Target qubit is out of range!");
+
+    const size_t stride = qubit_stride(state.qubit_num(), qubit);
+    const size_t bit = state.qubit_num() - 1 - qubit;
+    double *re = state.real();
+    double *im = state.imag();
+
+    parallel_for(0, state.size() / 2, [=](size_t begin, size_t end)
+    {
+        for (size_t k = begin; k < end; k++)
+        {
+            const size_t i = insert_zero_bit(k, bit);
+            std::swap(re[i], re[i + stride]);
+            std::swap(im[i], im[i + stride]);
+        }
+    });
+}
+
+void apply_cnot(SplitStatevector &state, size_t control_qubit, size_t target_qubit)
+{
+    const size_t qubit_n = state.qubit_num();
+    if (control_qubit >= qubit_n || target_qubit >= qubit_n || control_qubit == target_qubit)
+        throw std::invalid_argument("Invalid control and target qubits for CNOT!");
+
+    const size_t control_bit = qubit_n - 1 - control_qubit;
+    const size_t target_bit = qubit_n - 1 - target_qubit;
+    const size_t control_mask = static_cast<size_t>(1) << control_bit;
+    const size_t target_mask = static_cast<size_t>(1) << target_bit;
+    const size_t low_bit = std::min(control_bit, target_bit);
+    const size_t high_bit = std::max(control_bit, target_bit);
+    double *re = state.real();
+    double *im = state.imag();
+
+    parallel_for(0, state.size() >> 2, [=](size_t begin, size_t end)
+    {
+        for (size_t k = begin; k < end; k++)
+        {
+            const size_t i = insert_zero_bit(insert_zero_bit(k, low_bit), high_bit) | control_mask;
+            std::swap(re[i], re[i | target_mask]);
+            std::swap(im[i], im[i | target_mask]);
+        }
+    });
+}
+
+void apply_swap(SplitStatevector &state, size_t qubit1, size_t qubit2)
+{
+    const size_t qubit_n = state.qubit_num();
+    if (qubit1 >= qubit_n || qubit2 >= qubit_n || qubit1 == qubit2)
+        throw std::invalid_argument("Invalid qubits for Swap!");
+
+    const size_t bit1 = qubit_n - 1 - qubit1;
+    const size_t bit2 = qubit_n - 1 - qubit2;
+    const size_t mask1 = static_cast<size_t>(1) << bit1;
+    const size_t mask2 = static_cast<size_t>(1) << bit2;
+    const size_t low_bit = std::min(bit1, bit2);
+    const size_t high_bit = std::max(bit1, bit2);
+    double *re = state.real();
+    double *im = state.imag();
+
+    parallel_for(0, state.size() >> 2, [=](size_t begin, size_t end)
+    {
+        for (size_t k = begin; k < end; k++)
+        {
+            const size_t i = insert_zero_bit(insert_zero_bit(k, low_bit), high_bit);
+            std::swap(re[i | mask1], re[i | mask2]);
+            std::swap(im[i | mask1], im[i | mask2]);
+        }
+    });
+}
+
+// Only the quarter of the amplitudes with both bits 1 is multiplied, as in GateKernels.cpp
+void apply_controlled_phase(SplitStatevector &state, size_t qubit1, size_t qubit2, std::complex<double> factor)
+{
+    const size_t qubit_n = state.qubit_num();
+    if (qubit1 >= qubit_n || qubit2 >= qubit_n || qubit1 == qubit2)
+        throw std::invalid_argument("Invalid qubits for the controlled phase!");
+
+    const size_t bit1 = qubit_n - 1 - qubit1;
+    const size_t bit2 = qubit_n - 1 - qubit2;
+
+    // Passed to parallel_for() through one reference, so the std::function does not allocate
+    struct Job
+    {
+        double *re;
+        double *im;
+        size_t low_bit;
+        size_t high_bit;
+        size_t both_mask;
+        double fr;
+        double fi;
+    } job{state.real(), state.imag(), std::min(bit1, bit2), std::max(bit1, bit2),
+          (static_cast<size_t>(1) << bit1) | (static_cast<size_t>(1) << bit2), factor.real(), factor.imag()};
+
+    parallel_for(0, state.size() >> 2, [&job](size_t begin, size_t end)
+    {
+        double *re = job.re;
+        double *im = job.im;
+        for (size_t k = begin; k < end; k++)
+        {
+            const size_t i = insert_zero_bit(insert_zero_bit(k, job.low_bit), job.high_bit) | job.both_mask;
+            const double r = re[i];
+            re[i] = job.fr * r - job.fi * im[i];
+            im[i] = job.fr * im[i] + job.fi * r;
+        }
+    });
+}
+
+void apply_multi_qubit_gate(SplitStatevector &state, const std::vector<size_t> &qubits, const QuantumGate &matrix)
+{
+    const size_t qubit_n = state.qubit_num();
+    const size_t k = qubits.size();
+    const size_t block = static_cast<size_t>(1) << k;
+
+    if (matrix.get_rows() != block || matrix.get_cols() != block)
+        throw std::invalid_argument("The gate matrix does not match the number of target qubits!");
+
+    std::vector<size_t> sorted_bits;
+    for (auto q = qubits.begin(); q != qubits.end(); q++)
+    {
+        if (*q >= qubit_n)
+            throw std::invalid_argument("Target qubit is out of range!");
+        sorted_bits.push_back(qubit_n - 1 - *q);
+    }
+    std::sort(sorted_bits.begin(), sorted_bits.end());
+    if (std::adjacent_find(sorted_bits.begin(), sorted_bits.end()) != sorted_bits.end())
+        throw std::invalid_argument("The target qubits must be distinct!");
+
+    std::vector<size_t> offsets(block, 0);
+    for (size_t j = 0; j < block; j++)
+    {
+        for (size_t l = 0; l < k; l++)
+        {
+            if (j & (static_cast<size_t>(1) << (k - 1 - l)))
+                offsets[j] |= static_cast<size_t>(1) << (qubit_n - 1 - qubits[l]);
+        }
+    }
+
+    std::vector<double> mr(block * block), mi(block * block);
+    for (size_t r = 0; r < block; r++)
+    {
+        for (size_t c = 0; c < block; c++)
+        {
+            mr[r * block + c] = matrix(r + 1, c + 1).real();
+            mi[r * block + c] = matrix(r + 1, c + 1).imag();
+        }
+    }
+
+    double *re = state.real();
+    double *im = state.imag();
+
+    parallel_for(0, state.size() >> k, [&](size_t begin, size_t end)
+    {
+        std::vector<double> in_r(block), in_i(block);
+
+        for (size_t g = begin; g < end; g++)
+        {
+            size_t base = g;
+            for (size_t l = 0; l < k; l++)
+                base = insert_zero_bit(base, sorted_bits[l]);
+
+            for (size_t j = 0; j < block; j++)
+            {
+                in_r[j] = re[base + offsets[j]];
+                in_i[j] = im[base + offsets[j]];
+            }
+
+            for (size_t r = 0; r < block; r++)
+            {
+                double sum_r = 0, sum_i = 0;
+                for (size_t c = 0; c < block; c++)
+                {
+                    sum_r += mr[r * block + c] * in_r[c] - mi[r * block + c] * in_i[c];
+                    sum_i += mr[r * block + c] * in_i[c] + mi[r * block + c] * in_r[c];
+                }
+                re[base + offsets[r]] = sum_r;
+                im[base + offsets[r]] = sum_i;
+            }
+        }
+    });
+}
@@ -0,0 +1,142 @@
+#include "../include/SparseMatrix.hpp"
+#include "../include/ThreadPool.hpp"
+#include <algorithm>
+
+const std::complex<double> *SparseMatrix::find(size_t row, size_t col) const
+{
+    const size_t *first = col_index.data() + row_start[row];
+    const size_t *last = col_index.data() + row_start[row + 1];
+    const size_t *it = std::lower_bound(first, last, col);
+    if (it == last || *it != col)
+        return nullptr;
+    return &values[it - col_index.data()];
+}
+
+SparseMatrix sparse_identity(size_t n)
+{
+    SparseMatrix m;
+    m.rows = n;
+    m.cols = n;
+    m.row_start.resize(n + 1);
+    m.col_index.resize(n);
+    m.values.assign(n, 1.0);
+    for (size_t i = 0; i < n; i++)
+    {
+        m.row_start[i + 1] = i + 1;
+        m.col_index[i] = i;
+    }
+    return m;
+}
+
+SparseMatrix dense_to_sparse(const std::complex<double> *a, size_t rows, size_t cols)
+{
+    SparseMatrix m;
+    m.rows = rows;
+    m.cols = cols;
+    for (size_t i = 0; i < rows; i++)
+    {
+        for (size_t j = 0; j < cols; j++)
+        {
+            if (a[i * cols + j] != 0.0)
+            {
+                m.col_index.push_back(j);
+                m.values.push_back(a[i * cols + j]);
+            }
+        }
+        m.row_start.push_back(m.values.size());
+    }
+    return m;
+}
+
+void sparse_to_dense(const SparseMatrix &m, std::complex<double> *a)
+{
+    std::fill(a, a + m.rows * m.cols, std::complex<double>(0.0, 0.0));
+    for (size_t i = 0; i < m.rows; i++)
+        for (size_t e = m.row_start[i]; e < m.row_start[i + 1]; e++)
+            a[i * m.cols + m.col_index[e]] = m.values[e];
+}
+
+/*
+Row i * B.rows + k of A ⊗ B holds a(i, j) b(k, l) in column j * B.cols + l. Walking the row of A in the
+outer loop and the row of B in the inner loop gives the columns in increasing order.
+*/
+SparseMatrix sparse_kronecker(const SparseMatrix &a, const SparseMatrix &b)
+{
+    SparseMatrix m;
+    m.rows = a.rows * b.rows;
+    m.cols = a.cols * b.cols;
+    m.row_start.reserve(m.rows + 1);
+    m.col_index.reserve(a.nonzeros() * b.nonzeros());
+    m.values.reserve(a.nonzeros() * b.nonzeros());
+
+    for (size_t i = 0; i < a.rows; i++)
+    {
+        for (size_t k = 0; k < b.rows; k++)
+        {
+            for (size_t ea = a.row_start[i]; ea < a.row_start[i + 1]; ea++)
+            {
+                for (size_t eb = b.row_start[k]; eb < b.row_start[k + 1]; eb++)
+                {
+                    m.col_index.push_back(a.col_index[ea] * b.cols + b.col_index[eb]);
+                    m.values.push_back(a.values[ea] * b.values[eb]);
+                }
+            }
+            m.row_start.push_back(m.values.size());
+        }
+    }
+    return m;
+}
+
+SparseMatrix sparse_product(const SparseMatrix &a, const SparseMatrix &b)
+{
+    SparseMatrix m;
+    m.rows = a.rows;
+    m.cols = b.cols;
+    m.row_start.reserve(m.rows + 1);
+
+    // The products of one row, sorted by column and summed
+    std::vector<std::pair<size_t, std::complex<double>>> row;
+    for (size_t i = 0; i < a.rows; i++)
+    {
+        row.clear();
+        for (size_t ea = a.row_start[i]; ea < a.row_start[i + 1]; ea++)
+        {
+            const size_t k = a.col_index[ea];
+            for (size_t eb = b.row_start[k]; eb < b.row_start[k + 1]; eb++)
+                row.emplace_back(b.col_index[eb], a.values[ea] * b.values[eb]);
+        }
+        std::stable_sort(row.begin(), row.end(),
+                         [](const std::pair<size_t, std::complex<double>> &x, const std::pair<size_t, std::complex<double>> &y)
+                         { return x.first < y.first; });
+
+        for (size_t e = 0; e < row.size();)
+        {
+            const size_t col = row[e].first;
+            std::complex<double> sum{0.0, 0.0};
+            for (; e < row.size() && row[e].first == col; e++)
+                sum += row[e].second;
+            if (sum != 0.0)
+            {
+                m.col_index.push_back(col);
+                m.values.push_back(sum);
+            }
+        }
+        m.row_start.push_back(m.values.size());
+    }
+    return m;
+}
+
+void sparse_multiply(const SparseMatrix &m, const std::complex<double> *x, std::complex<double> *y)
+{
+    // The rows are independent, every entry of y is summed in the same order as in a serial loop
+    parallel_for(0, m.rows, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            std::complex<double> sum{0.0, 0.0};
+            for (size_t e = m.row_start[i]; e < m.row_start[i + 1]; e++)
+                sum += m.values[e] * x[m.col_index[e]];
+            y[i] = sum;
+        }
+    });
+}
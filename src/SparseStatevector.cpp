@@ -0,0 +1,402 @@
+#include "../include/SparseStatevector.hpp"
+
+// Amplitudes below this magnitude are rounding residues and always removed
+static const double NEGLIGIBLE_AMPLITUDE = 1e-15;
+// Same value as QuantumGate::ROUND_MINIMUM, used when dropping is enabled
+static const double ROUND_MINIMUM = 1e-10;
+// The indices are size_t and the fill ratio is relative to 2^n
+static const size_t MAX_SPARSE_QUBITS = 62;
+
+// Definition of the in-class constant, which is passed by reference (std::fill, vector::assign)
+const size_t SparseStatevector::EMPTY_KEY;
+
+SparseStatevector::SparseStatevector(size_t qubit_n_) :
+SparseStatevector(qubit_n_, std::string(qubit_n_, '0'))
+{
+}
+
+SparseStatevector::SparseStatevector(size_t qubit_n_, const std::string &basis_state) :
+qubit_n(qubit_n_)
+{
+    if (qubit_n == 0 || qubit_n > MAX_SPARSE_QUBITS)
+        throw std::invalid_argument("A sparse statevector has between 1 and 62 qubits!");
+    if (basis_state.length() != qubit_n)
+        throw std::invalid_argument("The length of the state must be equal to the number of qubits!");
+
+    size_t index = 0;
+    for (auto it = basis_state.begin(); it != basis_state.end(); it++)
+    {
+        if (*it != '0' && *it != '1')
+            throw std::invalid_argument("The state can only contain binary digits!");
+        index = 2 * index + (*it == '1' ? 1 : 0);
+    }
+
+    rehash(4);
+    add(index, 1.0);
+}
+
+SparseStatevector::SparseStatevector(const Statevector &s) :
+qubit_n(s.qubit_num())
+{
+    if (qubit_n == 0 || qubit_n > MAX_SPARSE_QUBITS)
+        throw std::invalid_argument("A sparse statevector has between 1 and 62 qubits!");
+
+    rehash(4);
+    for (size_t i = 0; i < s.size(); i++)
+    {
+        if (std::abs(s[i]) > NEGLIGIBLE_AMPLITUDE)
+            add(i, s[i]);
+    }
+}
+
+SparseStatevector::SparseStatevector(const SparseStatevector &s) :
+qubit_n(s.qubit_n), keys(s.keys), values(s.values), entry_n(s.entry_n),
+dense_threshold(s.dense_threshold), dropping(s.dropping), removed_weight(s.removed_weight)
+{
+    if (s.dense)
+        dense = std::make_unique<Statevector>(*s.dense);
+}
+
+SparseStatevector &SparseStatevector::operator=(const SparseStatevector &s)
+{
+    if (&s == this)
+        return *this;
+
+    qubit_n = s.qubit_n;
+    keys = s.keys;
+    values = s.values;
+    entry_n = s.entry_n;
+    dense_threshold = s.dense_threshold;
+    dropping = s.dropping;
+    removed_weight = s.removed_weight;
+    dense = s.dense ? std::make_unique<Statevector>(*s.dense) : nullptr;
+    return *this;
+}
+
+// Slot holding index, or the free slot where it would be inserted (linear probing)
+size_t SparseStatevector::find_slot(size_t index) const
+{
+    const size_t mask = keys.size() - 1;
+    size_t hash = index * 0x9E3779B97F4A7C15ull;
+    size_t slot = (hash ^ (hash >> 32)) & mask;
+    while (keys[slot] != EMPTY_KEY && keys[slot] != index)
+        slot = (slot + 1) & mask;
+    return slot;
+}
+
+void SparseStatevector::rehash(size_t capacity)
+{
+    std::vector<size_t> old_keys(capacity, EMPTY_KEY);
+    std::vector<std::complex<double>> old_values(capacity);
+    old_keys.swap(keys);
+    old_values.swap(values);
+
+    for (size_t slot = 0; slot < old_keys.size(); slot++)
+    {
+        if (old_keys[slot] == EMPTY_KEY)
+            continue;
+        size_t new_slot = find_slot(old_keys[slot]);
+        keys[new_slot] = old_keys[slot];
+        values[new_slot] = old_values[slot];
+    }
+}
+
+size_t SparseStatevector::nonzero_num() const
+{
+    return dense ? dense->size() : entry_n;
+}
+
+double SparseStatevector::fill_ratio() const
+{
+    return static_cast<double>(nonzero_num()) / static_cast<double>(static_cast<size_t>(1) << qubit_n);
+}
+
+std::complex<double> SparseStatevector::get(size_t index) const
+{
+    if (dense)
+        return (*dense)[index];
+    size_t slot = find_slot(index);
+    return keys[slot] == EMPTY_KEY ? std::complex<double>(0, 0) : values[slot];
+}
+
+void SparseStatevector::add(size_t index, std::complex<double> a)
+{
+    if (dense)
+        throw std::invalid_argument("add() is only available before the state becomes dense!");
+
+    // Keep the table at most half full
+    if (2 * (entry_n + 1) > keys.size())
+        rehash(2 * keys.size());
+
+    size_t slot = find_slot(index);
+    if (keys[slot] == EMPTY_KEY)
+    {
+        keys[slot] = index;
+        values[slot] = a;
+        entry_n++;
+    }
+    else
+    {
+        values[slot] += a;
+    }
+}
+
+std::vector<std::pair<size_t, std::complex<double>>> SparseStatevector::entries() const
+{
+    std::vector<std::pair<size_t, std::complex<double>>> result;
+    result.reserve(entry_n);
+    for (size_t slot = 0; slot < keys.size(); slot++)
+    {
+        if (keys[slot] != EMPTY_KEY)
+            result.push_back({keys[slot], values[slot]});
+    }
+    return result;
+}
+
+SparseStatevector SparseStatevector::empty_copy() const
+{
+    SparseStatevector result(qubit_n);
+    result.keys.assign(std::max<size_t>(4, keys.size()), EMPTY_KEY);
+    result.values.assign(result.keys.size(), 0.0);
+    result.entry_n = 0;
+    result.dense_threshold = dense_threshold;
+    result.dropping = dropping;
+    result.removed_weight = removed_weight;
+    return result;
+}
+
+void SparseStatevector::multiply_masked(size_t mask, std::complex<double> factor)
+{
+    if (dense)
+        throw std::invalid_argument("multiply_masked() is only available before the state becomes dense!");
+
+    for (size_t slot = 0; slot < keys.size(); slot++)
+    {
+        if (keys[slot] != EMPTY_KEY && (keys[slot] & mask) == mask)
+            values[slot] *= factor;
+    }
+}
+
+void SparseStatevector::finish_gate()
+{
+    if (dense)
+        return;
+
+    const double minimum = dropping ? ROUND_MINIMUM : NEGLIGIBLE_AMPLITUDE;
+    bool removing = false;
+    for (size_t slot = 0; slot < keys.size() && !removing; slot++)
+    {
+        if (keys[slot] != EMPTY_KEY && std::abs(values[slot]) < minimum)
+            removing = true;
+    }
+
+    if (removing)
+    {
+        std::vector<std::pair<size_t, std::complex<double>>> kept = entries();
+        std::fill(keys.begin(), keys.end(), EMPTY_KEY);
+        entry_n = 0;
+        for (auto it = kept.begin(); it != kept.end(); it++)
+        {
+            if (std::abs(it->second) < minimum)
+                removed_weight += std::norm(it->second);
+            else
+                add(it->first, it->second);
+        }
+    }
+
+    if (fill_ratio() > dense_threshold)
+    {
+        dense = std::make_unique<Statevector>(qubit_n);
+        std::complex<double> *amp = dense->data();
+        for (size_t slot = 0; slot < keys.size(); slot++)
+        {
+            if (keys[slot] != EMPTY_KEY)
+                amp[keys[slot]] = values[slot];
+        }
+        std::vector<size_t>().swap(keys);
+        std::vector<std::complex<double>>().swap(values);
+        entry_n = 0;
+    }
+}
+
+void SparseStatevector::set_dense_threshold(double fill_ratio_)
+{
+    if (fill_ratio_ <= 0.0)
+        throw std::invalid_argument("The dense threshold must be positive!");
+    dense_threshold = fill_ratio_;
+}
+
+Statevector SparseStatevector::to_statevector() const
+{
+    if (dense)
+        return *dense;
+
+    Statevector result(qubit_n);
+    for (size_t slot = 0; slot < keys.size(); slot++)
+    {
+        if (keys[slot] != EMPTY_KEY)
+            result[keys[slot]] = values[slot];
+    }
+    return result;
+}
+
+static void check_qubit(const SparseStatevector &state, size_t qubit)
+{
+    if (qubit >= state.qubit_num())
+        throw std::invalid_argument("Target qubit is out of range!");
+}
+
+void apply_single_qubit_gate(SparseStatevector &state, size_t qubit, const QuantumGate &core)
+{
+    if (state.is_dense())
+        return apply_single_qubit_gate(state.dense_state(), qubit, core);
+    if (core.get_rows() != 2 || core.get_cols() != 2)
+        throw std::invalid_argument("A single qubit gate core must be a 2x2 matrix!");
+    check_qubit(state, qubit);
+
+    const std::complex<double> m[2][2] = {{core(1, 1), core(1, 2)}, {core(2, 1), core(2, 2)}};
+    const size_t mask = static_cast<size_t>(1) << (state.qubit_num() - 1 - qubit);
+
+    // Amplitude a at index i with bit b contributes m[0][b] a to i with bit 0 and m[1][b] a to i with bit 1
+    SparseStatevector result = state.empty_copy();
+    std::vector<std::pair<size_t, std::complex<double>>> entries = state.entries();
+    for (auto it = entries.begin(); it != entries.end(); it++)
+    {
+        const size_t b = (it->first & mask) ? 1 : 0;
+        if (m[0][b] != std::complex<double>(0, 0))
+            result.add(it->first & ~mask, m[0][b] * it->second);
+        if (m[1][b] != std::complex<double>(0, 0))
+            result.add(it->first | mask, m[1][b] * it->second);
+    }
+    result.finish_gate();
+    state = std::move(result);
+}
+
+void apply_diagonal_gate(SparseStatevector &state, size_t qubit, std::complex<double> d0, std::complex<double> d1)
+{
+    if (state.is_dense())
+        return apply_diagonal_gate(state.dense_state(), qubit, d0, d1);
+    check_qubit(state, qubit);
+
+    const size_t mask = static_cast<size_t>(1) << (state.qubit_num() - 1 - qubit);
+    SparseStatevector result = state.empty_copy();
+    std::vector<std::pair<size_t, std::complex<double>>> entries = state.entries();
+    for (auto it = entries.begin(); it != entries.end(); it++)
+        result.add(it->first, ((it->first & mask) ? d1 : d0) * it->second);
+    result.finish_gate();
+    state = std::move(result);
+}
+
+// Permutation gates only move the indices, index i goes to permutation(i)
+template <typename Permutation>
+static void permute_indices(SparseStatevector &state, Permutation permutation)
+{
+    SparseStatevector result = state.empty_copy();
+    std::vector<std::pair<size_t, std::complex<double>>> entries = state.entries();
+    for (auto it = entries.begin(); it != entries.end(); it++)
+        result.add(permutation(it->first), it->second);
+    result.finish_gate();
+    state = std::move(result);
+}
+
+void apply_pauli_x(SparseStatevector &state, size_t qubit)
+{
+    if (state.is_dense())
+        return apply_pauli_x(state.dense_state(), qubit);
+    check_qubit(state, qubit);
+
+    const size_t mask = static_cast<size_t>(1) << (state.qubit_num() - 1 - qubit);
+    permute_indices(state, [=](size_t i) { return i ^ mask; });
+}
+
+void apply_cnot(SparseStatevector &state, size_t control_qubit, size_t target_qubit)
+{
+    if (state.is_dense())
+        return apply_cnot(state.dense_state(), control_qubit, target_qubit);
+    check_qubit(state, control_qubit);
+    check_qubit(state, target_qubit);
+    if (control_qubit == target_qubit)
+        throw std::invalid_argument("The control qubit and the target qubit cannot be the same!");
+
+    const size_t control_mask = static_cast<size_t>(1) << (state.qubit_num() - 1 - control_qubit);
+    const size_t target_mask = static_cast<size_t>(1) << (state.qubit_num() - 1 - target_qubit);
+    permute_indices(state, [=](size_t i) { return (i & control_mask) ? i ^ target_mask : i; });
+}
+
+void apply_swap(SparseStatevector &state, size_t qubit1, size_t qubit2)
+{
+    if (state.is_dense())
+        return apply_swap(state.dense_state(), qubit1, qubit2);
+    check_qubit(state, qubit1);
+    check_qubit(state, qubit2);
+    if (qubit1 == qubit2)
+        throw std::invalid_argument("Invalid qubits for Swap!");
+
+    const size_t mask1 = static_cast<size_t>(1) << (state.qubit_num() - 1 - qubit1);
+    const size_t mask2 = static_cast<size_t>(1) << (state.qubit_num() - 1 - qubit2);
+    permute_indices(state, [=](size_t i) { return (((i & mask1) != 0) != ((i & mask2) != 0)) ? i ^ mask1 ^ mask2 : i; });
+}
+
+// A controlled phase keeps the stored indices, so the amplitudes are multiplied in place
+void apply_controlled_phase(SparseStatevector &state, size_t qubit1, size_t qubit2, std::complex<double> factor)
+{
+    if (state.is_dense())
+        return apply_controlled_phase(state.dense_state(), qubit1, qubit2, factor);
+    check_qubit(state, qubit1);
+    check_qubit(state, qubit2);
+    if (qubit1 == qubit2)
+        throw std::invalid_argument("Invalid qubits for the controlled phase!");
+
+    const size_t mask1 = static_cast<size_t>(1) << (state.qubit_num() - 1 - qubit1);
+    const size_t mask2 = static_cast<size_t>(1) << (state.qubit_num() - 1 - qubit2);
+    state.multiply_masked(mask1 | mask2, factor);
+    state.finish_gate();
+}
+
+void apply_multi_qubit_gate(SparseStatevector &state, const std::vector<size_t> &qubits, const QuantumGate &matrix)
+{
+    if (state.is_dense())
+        return apply_multi_qubit_gate(state.dense_state(), qubits, matrix);
+
+    const size_t k = qubits.size();
+    const size_t block = static_cast<size_t>(1) << k;
+    if (matrix.get_rows() != block || matrix.get_cols() != block)
+        throw std::invalid_argument("The gate matrix does not match the number of target qubits!");
+
+    // masks[l] is the index bit of qubits[l], qubits[0] being the most significant bit of a block index
+    std::vector<size_t> masks(k);
+    size_t all_masks = 0;
+    for (size_t l = 0; l < k; l++)
+    {
+        check_qubit(state, qubits[l]);
+        masks[l] = static_cast<size_t>(1) << (state.qubit_num() - 1 - qubits[l]);
+        all_masks |= masks[l];
+    }
+
+    // Amplitude a at index i (column c of its block) contributes matrix(r, c) a to every row r
+    SparseStatevector result = state.empty_copy();
+    std::vector<std::pair<size_t, std::complex<double>>> entries = state.entries();
+    for (auto it = entries.begin(); it != entries.end(); it++)
+    {
+        size_t column = 0;
+        for (size_t l = 0; l < k; l++)
+            column = 2 * column + ((it->first & masks[l]) ? 1 : 0);
+        const size_t base = it->first & ~all_masks;
+
+        for (size_t row = 0; row < block; row++)
+        {
+            const std::complex<double> m = matrix(row + 1, column + 1);
+            if (m == std::complex<double>(0, 0))
+                continue;
+            size_t index = base;
+            for (size_t l = 0; l < k; l++)
+            {
+                if ((row >> (k - 1 - l)) & 1)
+                    index |= masks[l];
+            }
+            result.add(index, m * it->second);
+        }
+    }
+    result.finish_gate();
+    state = std::move(result);
+}
@@ -0,0 +1,112 @@
+#include "../include/SplitStatevector.hpp"
+
+// Round a pointer up to the next multiple of SplitStatevector::ALIGNMENT
+static double *align_pointer(double *p)
+{
+    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(p);
+    std::uintptr_t aligned = (address + SplitStatevector::ALIGNMENT - 1) & ~(std::uintptr_t)(SplitStatevector::ALIGNMENT - 1);
+    return reinterpret_cast<double *>(aligned);
+}
+
+// Allocate both buffers for the current qubit_n and set all amplitudes to 0
+void SplitStatevector::allocate()
+{
+    const size_t padding = ALIGNMENT / sizeof(double);
+
+    real_buffer = std::make_unique<double[]>(size() + padding);
+    imag_buffer = std::make_unique<double[]>(size() + padding);
+    real_part = align_pointer(real_buffer.get());
+    imag_part = align_pointer(imag_buffer.get());
+}
+
+SplitStatevector::SplitStatevector() : qubit_n(0)
+{
+    allocate();
+}
+
+// Constructor for 0 statevector with n qubits
+SplitStatevector::SplitStatevector(size_t qubit_n_) : qubit_n(qubit_n_)
+{
+    allocate();
+}
+
+// Convert from the interleaved layout
+SplitStatevector::SplitStatevector(const Statevector &s) : qubit_n(s.qubit_num())
+{
+    allocate();
+
+    const std::complex<double> *amp = s.data();
+    for (size_t i = 0; i < size(); i++)
+    {
+        real_part[i] = amp[i].real();
+        imag_part[i] = amp[i].imag();
+    }
+}
+
+// Copy constructor
+SplitStatevector::SplitStatevector(const SplitStatevector &s) : qubit_n(s.qubit_n)
+{
+    allocate();
+    std::copy(s.real_part, s.real_part + size(), real_part);
+    std::copy(s.imag_part, s.imag_part + size(), imag_part);
+}
+
+// Copy assignment operator
+SplitStatevector &SplitStatevector::operator=(const SplitStatevector &s)
+{
+    if (this == &s)
+        return *this;
+
+    qubit_n = s.qubit_n;
+    allocate();
+    std::copy(s.real_part, s.real_part + size(), real_part);
+    std::copy(s.imag_part, s.imag_part + size(), imag_part);
+    return *this;
+}
+
+// Move constructor
+SplitStatevector::SplitStatevector(SplitStatevector &&s) :
+qubit_n(s.qubit_n), real_buffer(std::move(s.real_buffer)), imag_buffer(std::move(s.imag_buffer)),
+real_part(s.real_part), imag_part(s.imag_part)
+{
+    s.qubit_n = 0;
+    s.allocate();
+}
+
+// Move assignment operator
+SplitStatevector &SplitStatevector::operator=(SplitStatevector &&s)
+{
+    if (this == &s)
+        return *this;
+
+    qubit_n = s.qubit_n;
+    real_buffer = std::move(s.real_buffer);
+    imag_buffer = std::move(s.imag_buffer);
+    real_part = s.real_part;
+    imag_part = s.imag_part;
+
+    s.qubit_n = 0;
+    s.allocate();
+    return *this;
+}
+
+std::complex<double> SplitStatevector::amplitude(size_t i) const
+{
+    if (i >= size())
+    {
+        std::cout << "Error: trying to access an element out of bounds" << std::endl;
+        throw("index out of bounds");
+    }
+    return std::complex<double>(real_part[i], imag_part[i]);
+}
+
+Statevector SplitStatevector::to_statevector() const
+{
+    Statevector result(qubit_n);
+    std::complex<double> *amp = result.data();
+    for (size_t i = 0; i < size(); i++)
+    {
+        amp[i] = std::complex<double>(real_part[i], imag_part[i]);
+    }
+    return result;
+}
@@ -0,0 +1,304 @@
+#include "../include/StabilizerTableau.hpp"
+
+StabilizerTableau::StabilizerTableau(size_t qubit_n_) :
+qubit_n(qubit_n_), word_n((qubit_n_ + 63) / 64)
+{
+    if (qubit_n == 0)
+        throw std::invalid_argument("A stabilizer tableau needs at least one qubit!");
+
+    x_bits.assign((2 * qubit_n + 1) * word_n, 0);
+    z_bits.assign((2 * qubit_n + 1) * word_n, 0);
+    signs.assign(2 * qubit_n + 1, 0);
+
+    // Destabilizer i is X_i and stabilizer i is Z_i
+    for (size_t i = 0; i < qubit_n; i++)
+    {
+        x_row(i)[i / 64] |= static_cast<uint64_t>(1) << (i % 64);
+        z_row(qubit_n + i)[i / 64] |= static_cast<uint64_t>(1) << (i % 64);
+    }
+}
+
+StabilizerTableau::StabilizerTableau(size_t qubit_n_, const std::string &basis_state) :
+StabilizerTableau(qubit_n_)
+{
+    if (basis_state.length() != qubit_n)
+        throw std::invalid_argument("The length of the state must be equal to the number of qubits!");
+
+    for (size_t q = 0; q < qubit_n; q++)
+    {
+        if (basis_state[q] == '1')
+            pauli_x(q);
+        else if (basis_state[q] != '0')
+            throw std::invalid_argument("The state can only contain binary digits!");
+    }
+}
+
+void StabilizerTableau::check_qubit(size_t q) const
+{
+    if (q >= qubit_n)
+        throw std::invalid_argument("Target qubit is out of range!");
+}
+
+/*
+The sign of the product follows from the exponent of i picked up on every qubit. With (x1, z1) from
+row i and (x2, z2) from row h, the exponent is +1 for XY, YZ, ZX and -1 for YX, ZY, XZ, so the qubits
+of each kind are counted for 64 qubits at a time with a popcount.
+*/
+void StabilizerTableau::rowsum(size_t h, size_t i)
+{
+    uint64_t *xh = x_row(h), *zh = z_row(h);
+    const uint64_t *xi = x_row(i), *zi = z_row(i);
+
+    size_t plus = 0, minus = 0;
+    for (size_t w = 0; w < word_n; w++)
+    {
+        const uint64_t x1 = xi[w], z1 = zi[w], x2 = xh[w], z2 = zh[w];
+        const uint64_t p = (x1 & z1 & z2 & ~x2) | (x1 & ~z1 & z2 & x2) | (~x1 & z1 & x2 & ~z2);
+        const uint64_t m = (x1 & z1 & x2 & ~z2) | (x1 & ~z1 & z2 & ~x2) | (~x1 & z1 & x2 & z2);
+        plus += __builtin_popcountll(p);
+        minus += __builtin_popcountll(m);
+        xh[w] = x2 ^ x1;
+        zh[w] = z2 ^ z1;
+    }
+
+    // The exponent is always even for commuting rows: 0 for +, 2 for -
+    const size_t exponent = 2 * signs[h] + 2 * signs[i] + plus + 3 * minus;
+    signs[h] = (exponent % 4 == 0) ? 0 : 1;
+}
+
+void StabilizerTableau::copy_row(size_t destination, size_t source)
+{
+    std::copy(x_row(source), x_row(source) + word_n, x_row(destination));
+    std::copy(z_row(source), z_row(source) + word_n, z_row(destination));
+    signs[destination] = signs[source];
+}
+
+void StabilizerTableau::clear_row(size_t row)
+{
+    std::fill(x_row(row), x_row(row) + word_n, 0);
+    std::fill(z_row(row), z_row(row) + word_n, 0);
+    signs[row] = 0;
+}
+
+void StabilizerTableau::hadamard(size_t q)
+{
+    check_qubit(q);
+    const size_t w = q / 64;
+    const uint64_t mask = static_cast<uint64_t>(1) << (q % 64);
+    for (size_t row = 0; row < 2 * qubit_n; row++)
+    {
+        uint64_t &x = x_row(row)[w];
+        uint64_t &z = z_row(row)[w];
+        signs[row] ^= ((x & z & mask) != 0);
+        const uint64_t exchanged = (x ^ z) & mask;
+        x ^= exchanged;
+        z ^= exchanged;
+    }
+}
+
+void StabilizerTableau::phase_s(size_t q)
+{
+    check_qubit(q);
+    const size_t w = q / 64;
+    const uint64_t mask = static_cast<uint64_t>(1) << (q % 64);
+    for (size_t row = 0; row < 2 * qubit_n; row++)
+    {
+        uint64_t &x = x_row(row)[w];
+        uint64_t &z = z_row(row)[w];
+        signs[row] ^= ((x & z & mask) != 0);
+        z ^= x & mask;
+    }
+}
+
+void StabilizerTableau::pauli_x(size_t q)
+{
+    check_qubit(q);
+    for (size_t row = 0; row < 2 * qubit_n; row++)
+        signs[row] ^= get_z(row, q);
+}
+
+void StabilizerTableau::pauli_y(size_t q)
+{
+    check_qubit(q);
+    for (size_t row = 0; row < 2 * qubit_n; row++)
+        signs[row] ^= get_x(row, q) ^ get_z(row, q);
+}
+
+void StabilizerTableau::pauli_z(size_t q)
+{
+    check_qubit(q);
+    for (size_t row = 0; row < 2 * qubit_n; row++)
+        signs[row] ^= get_x(row, q);
+}
+
+void StabilizerTableau::cnot(size_t control_qubit, size_t target_qubit)
+{
+    check_qubit(control_qubit);
+    check_qubit(target_qubit);
+    if (control_qubit == target_qubit)
+        throw std::invalid_argument("The control qubit and the target qubit cannot be the same!");
+
+    const size_t a = control_qubit, b = target_qubit;
+    for (size_t row = 0; row < 2 * qubit_n; row++)
+    {
+        const bool xa = get_x(row, a), za = get_z(row, a);
+        const bool xb = get_x(row, b), zb = get_z(row, b);
+        signs[row] ^= xa && zb && !(xb ^ za);
+        if (xa)
+            x_row(row)[b / 64] ^= static_cast<uint64_t>(1) << (b % 64);
+        if (zb)
+            z_row(row)[a / 64] ^= static_cast<uint64_t>(1) << (a % 64);
+    }
+}
+
+void StabilizerTableau::swap(size_t q1, size_t q2)
+{
+    check_qubit(q1);
+    check_qubit(q2);
+    if (q1 == q2)
+        return;
+
+    const uint64_t mask1 = static_cast<uint64_t>(1) << (q1 % 64);
+    const uint64_t mask2 = static_cast<uint64_t>(1) << (q2 % 64);
+    for (size_t row = 0; row < 2 * qubit_n; row++)
+    {
+        if (get_x(row, q1) != get_x(row, q2))
+        {
+            x_row(row)[q1 / 64] ^= mask1;
+            x_row(row)[q2 / 64] ^= mask2;
+        }
+        if (get_z(row, q1) != get_z(row, q2))
+        {
+            z_row(row)[q1 / 64] ^= mask1;
+            z_row(row)[q2 / 64] ^= mask2;
+        }
+    }
+}
+
+bool StabilizerTableau::measure_qubit(size_t q, bool random_outcome)
+{
+    check_qubit(q);
+
+    // A stabilizer anticommuting with Z_q makes the outcome random
+    size_t p = qubit_n;
+    while (p < 2 * qubit_n && !get_x(p, q))
+        p++;
+
+    if (p < 2 * qubit_n)
+    {
+        for (size_t row = 0; row < 2 * qubit_n; row++)
+        {
+            if (row != p && get_x(row, q))
+                rowsum(row, p);
+        }
+        copy_row(p - qubit_n, p);
+        clear_row(p);
+        z_row(p)[q / 64] |= static_cast<uint64_t>(1) << (q % 64);
+        signs[p] = random_outcome;
+        return random_outcome;
+    }
+
+    // Otherwise +-Z_q is a product of stabilizers, collected in the scratch row
+    const size_t scratch = 2 * qubit_n;
+    clear_row(scratch);
+    for (size_t i = 0; i < qubit_n; i++)
+    {
+        if (get_x(i, q))
+            rowsum(scratch, i + qubit_n);
+    }
+    return signs[scratch];
+}
+
+bool StabilizerTableau::measure(size_t q, std::mt19937_64 &rng)
+{
+    return measure_qubit(q, rng() & 1);
+}
+
+std::map<std::string, size_t> StabilizerTableau::sample(size_t shots, std::mt19937_64 &rng) const
+{
+    // One outcome x0, with every random outcome taken as 0
+    StabilizerTableau copy = *this;
+    std::vector<uint64_t> x0(word_n, 0);
+    for (size_t q = 0; q < qubit_n; q++)
+    {
+        if (copy.measure_qubit(q, false))
+            x0[q / 64] |= static_cast<uint64_t>(1) << (q % 64);
+    }
+
+    // Gaussian elimination of the x parts of the stabilizers, the independent rows span the outcomes
+    std::vector<std::vector<uint64_t>> basis;
+    for (size_t i = 0; i < qubit_n; i++)
+        basis.emplace_back(x_row(qubit_n + i), x_row(qubit_n + i) + word_n);
+
+    size_t rank = 0;
+    for (size_t q = 0; q < qubit_n && rank < basis.size(); q++)
+    {
+        const uint64_t mask = static_cast<uint64_t>(1) << (q % 64);
+        size_t pivot = rank;
+        while (pivot < basis.size() && !(basis[pivot][q / 64] & mask))
+            pivot++;
+        if (pivot == basis.size())
+            continue;
+
+        std::swap(basis[rank], basis[pivot]);
+        for (size_t row = 0; row < basis.size(); row++)
+        {
+            if (row != rank && (basis[row][q / 64] & mask))
+            {
+                for (size_t w = 0; w < word_n; w++)
+                    basis[row][w] ^= basis[rank][w];
+            }
+        }
+        rank++;
+    }
+    basis.resize(rank);
+
+    std::map<std::string, size_t> counts;
+    std::vector<uint64_t> outcome(word_n);
+    for (size_t shot = 0; shot < shots; shot++)
+    {
+        outcome = x0;
+        for (auto it = basis.begin(); it != basis.end(); it++)
+        {
+            if (rng() & 1)
+            {
+                for (size_t w = 0; w < word_n; w++)
+                    outcome[w] ^= (*it)[w];
+            }
+        }
+
+        std::string bits(qubit_n, '0');
+        for (size_t q = 0; q < qubit_n; q++)
+        {
+            if ((outcome[q / 64] >> (q % 64)) & 1)
+                bits[q] = '1';
+        }
+        counts[bits]++;
+    }
+    return counts;
+}
+
+std::vector<std::string> StabilizerTableau::stabilizers() const
+{
+    std::vector<std::string> result;
+    for (size_t row = qubit_n; row < 2 * qubit_n; row++)
+    {
+        std::string pauli_string = signs[row] ? "-" : "+";
+        for (size_t q = 0; q < qubit_n; q++)
+        {
+            const bool x = get_x(row, q), z = get_z(row, q);
+            pauli_string += x ? (z ? 'Y' : 'X') : (z ? 'Z' : 'I');
+        }
+        result.push_back(pauli_string);
+    }
+    return result;
+}
+
+void StabilizerTableau::display_stabilizers() const
+{
+    std::vector<std::string> generators = stabilizers();
+    for (auto it = generators.begin(); it != generators.end(); it++)
+    {
+        std::cout << *it << std::endl;
+    }
+}
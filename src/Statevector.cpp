@@ -130,35 +130,22 @@ Statevector &Statevector::operator=(Statevector &&s)
     return *this;
 }
 
-// Overload + operator
-Statevector Statevector::operator+(const Statevector &s)
+Statevector &Statevector::operator*=(const std::complex<double> &c)
 {
-    Statevector result(s);
-    for (int i = 0; i < pow(2, qubit_n); i++)
-    {
-        result.array[i] += array[i];
-    }
-    return result;
-}
-
-Statevector Statevector::operator-(const Statevector &s)
-{
-    Statevector result(s);
-    for (int i = 0; i < pow(2, qubit_n); i++)
+    for (size_t i = 0; i < size(); i++)
     {
-        result.array[i] -= array[i];
+        array[i] *= c;
     }
-    return result;
+    return *this;
 }
 
-Statevector Statevector::operator/(const std::complex<double> &c)
+Statevector &Statevector::operator/=(const std::complex<double> &c)
 {
-    Statevector result(*this);
-    for (int i = 0; i < pow(2, qubit_n); i++)
+    for (size_t i = 0; i < size(); i++)
     {
-        result.array[i] /= c;
+        array[i] /= c;
     }
-    return result;
+    return *this;
 }
 
 // Overloading [] operator
@@ -259,26 +246,34 @@ Statevector generate_state(size_t qubit_n, std::string state_kind, std::string s
     Statevector s(qubit_n);
     if (state_kind == "std")
     {
-        // state_str = 000110, 110 ...
-        s = generate_std_basis(qubit_n)[state_str];
+        // state_str = 000110, 110 ... The leftmost digit is qubit 0, the most significant bit of the index.
+        // The amplitude is set directly, generate_std_basis() would build all 2^n basis states first.
+        size_t index = 0;
+        for (auto it = state_str.begin(); it != state_str.end(); it++)
+        {
+            index = 2 * index + (*it == '1' ? 1 : 0);
+        }
+        s[index] = 1;
     }
     else if (state_kind == "Bell")
     {
+        // The Bell states (|a> ± |b>) / sqrt(2), evaluated in one pass
+        Statevector ket00{0, 0}, ket01{0, 1}, ket10{1, 0}, ket11{1, 1};
         if (state_str == "00")
         {
-            s = (generate_std_basis(2)["00"] + generate_std_basis(2)["11"]) / sqrt(2);
+            s = (ket00 + ket11) / sqrt(2);
         }
         else if (state_str == "01")
         {
-            s = (generate_std_basis(2)["00"] - generate_std_basis(2)["11"]) / sqrt(2);
+            s = (ket00 - ket11) / sqrt(2);
         }
         else if (state_str == "10")
         {
-            s = (generate_std_basis(2)["01"] + generate_std_basis(2)["10"]) / sqrt(2);
+            s = (ket01 + ket10) / sqrt(2);
         }
         else if (state_str == "11")
         {
-            s = (generate_std_basis(2)["01"] - generate_std_basis(2)["10"]) / sqrt(2);
+            s = (ket01 - ket10) / sqrt(2);
         }
         else
         {
@@ -288,12 +283,12 @@ Statevector generate_state(size_t qubit_n, std::string state_kind, std::string s
     }
     else if (state_kind == "GHZ")
     {
-        s = generate_std_basis(3)["000"] + generate_std_basis(3)["111"];
+        s = Statevector{0, 0, 0} + Statevector{1, 1, 1};
     }
     else if (state_kind == "W")
     {
         // Custom W state
-        s = generate_std_basis(3)["001"] + generate_std_basis(3)["010"] + generate_std_basis(3)["100"];
+        s = Statevector{0, 0, 1} + Statevector{0, 1, 0} + Statevector{1, 0, 0};
     }
     else if (state_kind == "random")
     {
@@ -321,12 +316,9 @@ Statevector generate_state(size_t qubit_n, std::string state_kind, std::string s
 // Round the statevector to 0 if the absolute value is less than 1e-10
 void Statevector::round()
 {
-    for (int i = 0; i < pow(2, qubit_n); i++)
+    for (size_t i = 0; i < size(); i++)
     {
-        if (std::abs(array[i].real()) < 1e-10)
-            array[i].real(0);
-        if (std::abs(array[i].imag()) < 1e-10)
-            array[i].imag(0);
+        array[i] = round_amplitude(array[i]);
     }
 }
 
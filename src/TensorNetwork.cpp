@@ -0,0 +1,401 @@
+#include "../include/TensorNetwork.hpp"
+#include "../include/ThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Intermediate tensors above this number of elements (2 GB) are refused
+static const double MAX_TENSOR_ELEMENTS = double(size_t(1) << 27);
+// Temperatures of the annealing, in units of log2(flops)
+static const double INITIAL_TEMPERATURE = 1.0;
+static const double FINAL_TEMPERATURE = 0.01;
+
+typedef std::vector<size_t> IndexSet; // sorted
+
+void ContractionCost::display() const
+{
+    std::cout << "Contraction path: " << flops << " flops, largest tensor " << largest_tensor
+              << " elements, peak memory " << peak_memory << " bytes" << std::endl;
+}
+
+// The indices left after contracting a and b (the ones in only one of them), and the number in both
+static IndexSet remaining_indices(const IndexSet &a, const IndexSet &b, size_t &shared_n)
+{
+    IndexSet result;
+    std::set_symmetric_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+    shared_n = (a.size() + b.size() - result.size()) / 2;
+    return result;
+}
+
+/*
+The tensors as sets of indices, for the planning. Contracting two groups of tensors gives a new node of
+the contraction tree; the groups are kept in a union-find structure over the original tensors.
+*/
+struct PlanState
+{
+    std::vector<size_t> parent;  // union-find over the original tensors
+    std::vector<size_t> node;    // node of the contraction tree of each group (at its root)
+    std::vector<IndexSet> sets;  // indices of each group (at its root)
+    size_t next_node;
+    ContractionCost cost;
+    double live_bytes{0.0};
+
+    PlanState(const std::vector<IndexSet> &initial) :
+    parent(initial.size()), node(initial.size()), sets(initial), next_node(initial.size())
+    {
+        for (size_t t = 0; t < initial.size(); t++)
+        {
+            parent[t] = node[t] = t;
+            live_bytes += 16.0 * std::ldexp(1.0, initial[t].size());
+        }
+        cost.peak_memory = live_bytes;
+    }
+
+    size_t find(size_t t)
+    {
+        while (parent[t] != t)
+            t = parent[t] = parent[parent[t]];
+        return t;
+    }
+
+    // Contract the groups with roots a and b, and return the root of the result
+    size_t merge(size_t a, size_t b, std::vector<std::pair<size_t, size_t>> *path)
+    {
+        size_t shared_n;
+        IndexSet result = remaining_indices(sets[a], sets[b], shared_n);
+        const double out_size = std::ldexp(1.0, result.size());
+        cost.flops += 8.0 * std::ldexp(1.0, result.size() + shared_n);
+        cost.largest_tensor = std::max(cost.largest_tensor, out_size);
+        cost.peak_memory = std::max(cost.peak_memory, live_bytes + 16.0 * out_size);
+        live_bytes += 16.0 * (out_size - std::ldexp(1.0, sets[a].size()) - std::ldexp(1.0, sets[b].size()));
+
+        if (path)
+            path->push_back(std::make_pair(node[a], node[b]));
+        parent[b] = a;
+        node[a] = next_node++;
+        sets[a].swap(result);
+        return a;
+    }
+
+    // Contract the disconnected groups that are left (scalars for a closed network)
+    void merge_remaining(std::vector<std::pair<size_t, size_t>> *path)
+    {
+        size_t first = find(0);
+        for (size_t t = 1; t < parent.size(); t++)
+            if (find(t) != first)
+                first = merge(first, find(t), path);
+    }
+};
+
+// The tensors that each index connects
+static std::vector<std::pair<size_t, size_t>> index_ends(const std::vector<IndexSet> &sets, size_t index_n)
+{
+    std::vector<std::pair<size_t, size_t>> ends(index_n, std::make_pair(size_t(-1), size_t(-1)));
+    for (size_t t = 0; t < sets.size(); t++)
+        for (auto it = sets[t].begin(); it != sets[t].end(); it++)
+        {
+            if (ends[*it].first == size_t(-1))
+                ends[*it].first = t;
+            else
+                ends[*it].second = t;
+        }
+    return ends;
+}
+
+/*
+Contract the tensors by summing the indices in the given order: for each index, the two groups it
+connects are contracted (which sums all their shared indices), unless they are already one group.
+*/
+static ContractionCost evaluate_order(const std::vector<IndexSet> &sets, const std::vector<std::pair<size_t, size_t>> &ends,
+                                      const std::vector<size_t> &order, std::vector<std::pair<size_t, size_t>> *path)
+{
+    PlanState state(sets);
+    for (auto it = order.begin(); it != order.end(); it++)
+    {
+        const size_t a = state.find(ends[*it].first), b = state.find(ends[*it].second);
+        if (a != b)
+            state.merge(a, b, path);
+    }
+    state.merge_remaining(path);
+    return state.cost;
+}
+
+/*
+Greedy order: repeatedly contract the connected pair whose result is the smallest compared with the two
+operands, and append their shared indices to the order.
+*/
+static std::vector<size_t> greedy_order(const std::vector<IndexSet> &sets, const std::vector<std::pair<size_t, size_t>> &ends)
+{
+    PlanState state(sets);
+    std::vector<bool> summed(ends.size(), false);
+    std::vector<size_t> order;
+
+    while (order.size() < ends.size())
+    {
+        size_t best_a = 0, best_b = 0;
+        double best_score = 0.0;
+        bool found = false;
+        for (size_t e = 0; e < ends.size(); e++)
+        {
+            if (summed[e])
+                continue;
+            const size_t a = state.find(ends[e].first), b = state.find(ends[e].second);
+            size_t shared_n;
+            const IndexSet result = remaining_indices(state.sets[a], state.sets[b], shared_n);
+            const double score = std::ldexp(1.0, result.size()) - std::ldexp(1.0, state.sets[a].size()) -
+                                 std::ldexp(1.0, state.sets[b].size());
+            if (!found || score < best_score)
+            {
+                best_a = a;
+                best_b = b;
+                best_score = score;
+                found = true;
+            }
+        }
+
+        std::vector<size_t> shared;
+        std::set_intersection(state.sets[best_a].begin(), state.sets[best_a].end(), state.sets[best_b].begin(),
+                              state.sets[best_b].end(), std::back_inserter(shared));
+        for (auto it = shared.begin(); it != shared.end(); it++)
+        {
+            summed[*it] = true;
+            order.push_back(*it);
+        }
+        state.merge(best_a, best_b, nullptr);
+    }
+    return order;
+}
+
+TensorNetwork::TensorNetwork(size_t qubit_n_) :
+TensorNetwork(qubit_n_, std::string(qubit_n_, '0'))
+{
+}
+
+TensorNetwork::TensorNetwork(size_t qubit_n_, const std::string &basis_state) :
+qubit_n(qubit_n_)
+{
+    if (qubit_n == 0)
+        throw std::invalid_argument("A tensor network needs at least one qubit!");
+    if (basis_state.length() != qubit_n)
+        throw std::invalid_argument("The length of the state must be equal to the number of qubits!");
+
+    // One input vector per qubit, its index is the first wire of the qubit
+    for (size_t q = 0; q < qubit_n; q++)
+    {
+        if (basis_state[q] != '0' && basis_state[q] != '1')
+            throw std::invalid_argument("The state can only contain binary digits!");
+        Tensor input{{index_n}, {0.0, 0.0}};
+        input.data[basis_state[q] - '0'] = 1.0;
+        tensors.push_back(input);
+        wires.push_back(index_n++);
+    }
+}
+
+void TensorNetwork::add_gate(const std::vector<size_t> &qubits, const QuantumGate &gate)
+{
+    const size_t k = qubits.size();
+    if (gate.get_rows() != (size_t(1) << k))
+        throw std::invalid_argument("The size of the gate does not match the number of target qubits!");
+    for (size_t i = 0; i < k; i++)
+    {
+        if (qubits[i] >= qubit_n)
+            throw std::invalid_argument("The target qubit is out of range!");
+        if (std::find(qubits.begin(), qubits.begin() + i, qubits[i]) != qubits.begin() + i)
+            throw std::invalid_argument("The target qubits must be different!");
+    }
+
+    // Indices: the new wires (rows), then the current wires (columns) of the targets
+    Tensor tensor;
+    for (size_t i = 0; i < k; i++)
+        tensor.indices.push_back(index_n + i);
+    for (size_t i = 0; i < k; i++)
+        tensor.indices.push_back(wires[qubits[i]]);
+    tensor.data.resize(gate.get_rows() * gate.get_cols());
+    for (size_t r = 0; r < gate.get_rows(); r++)
+        for (size_t c = 0; c < gate.get_cols(); c++)
+            tensor.data[(r << k) | c] = gate(r + 1, c + 1);
+    tensors.push_back(tensor);
+
+    for (size_t i = 0; i < k; i++)
+        wires[qubits[i]] = index_n++;
+    planned = false;
+}
+
+TensorNetwork::Tensor TensorNetwork::output_vector(size_t q, char bit) const
+{
+    if (bit != '0' && bit != '1')
+        throw std::invalid_argument("The state can only contain binary digits!");
+    Tensor output{{wires[q]}, {0.0, 0.0}};
+    output.data[bit - '0'] = 1.0;
+    return output;
+}
+
+const ContractionCost &TensorNetwork::plan_contraction(size_t annealing_steps, unsigned seed)
+{
+    std::vector<IndexSet> sets;
+    for (auto it = tensors.begin(); it != tensors.end(); it++)
+    {
+        sets.push_back(it->indices);
+        std::sort(sets.back().begin(), sets.back().end());
+    }
+    for (size_t q = 0; q < qubit_n; q++)
+        sets.push_back(IndexSet{wires[q]});
+    const std::vector<std::pair<size_t, size_t>> ends = index_ends(sets, index_n);
+
+    std::vector<size_t> order = greedy_order(sets, ends);
+    std::vector<size_t> best_order = order;
+    double current = std::log2(evaluate_order(sets, ends, order, nullptr).flops);
+    double best = current;
+
+    // Annealing over the order of the indices: swap two positions, accept the worse orders with the Boltzmann probability
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    for (size_t step = 0; step < annealing_steps && order.size() > 1; step++)
+    {
+        const double temperature = INITIAL_TEMPERATURE *
+                                   std::pow(FINAL_TEMPERATURE / INITIAL_TEMPERATURE, double(step) / annealing_steps);
+        const size_t i = rng() % order.size(), j = rng() % order.size();
+        if (i == j)
+            continue;
+        std::swap(order[i], order[j]);
+
+        const double candidate = std::log2(evaluate_order(sets, ends, order, nullptr).flops);
+        if (candidate <= current || uniform(rng) < std::exp((current - candidate) / temperature))
+        {
+            current = candidate;
+            if (current < best)
+            {
+                best = current;
+                best_order = order;
+            }
+        }
+        else
+            std::swap(order[i], order[j]);
+    }
+
+    path.clear();
+    cost = evaluate_order(sets, ends, best_order, &path);
+    planned = true;
+    return cost;
+}
+
+TensorNetwork::Tensor TensorNetwork::contract(const Tensor &a, const Tensor &b)
+{
+    const size_t rank_a = a.indices.size(), rank_b = b.indices.size();
+
+    // Bit of each kept and shared index in the data of a and b (0 if the tensor does not have it)
+    std::vector<size_t> kept_a, kept_b, shared_a, shared_b;
+    Tensor result;
+    for (size_t i = 0; i < rank_a; i++)
+    {
+        auto it = std::find(b.indices.begin(), b.indices.end(), a.indices[i]);
+        if (it == b.indices.end())
+        {
+            result.indices.push_back(a.indices[i]);
+            kept_a.push_back(size_t(1) << (rank_a - 1 - i));
+            kept_b.push_back(0);
+        }
+        else
+        {
+            shared_a.push_back(size_t(1) << (rank_a - 1 - i));
+            shared_b.push_back(size_t(1) << (rank_b - 1 - (it - b.indices.begin())));
+        }
+    }
+    for (size_t i = 0; i < rank_b; i++)
+    {
+        if (std::find(a.indices.begin(), a.indices.end(), b.indices[i]) == a.indices.end())
+        {
+            result.indices.push_back(b.indices[i]);
+            kept_a.push_back(0);
+            kept_b.push_back(size_t(1) << (rank_b - 1 - i));
+        }
+    }
+
+    // Offsets of every value of the kept and the shared indices, built from the offset without the lowest set bit
+    const size_t kept_n = kept_a.size(), shared_n = shared_a.size();
+    std::vector<size_t> kept_offset_a(size_t(1) << kept_n, 0), kept_offset_b(size_t(1) << kept_n, 0);
+    for (size_t x = 1; x < kept_offset_a.size(); x++)
+    {
+        const size_t low = __builtin_ctzll(x);
+        kept_offset_a[x] = kept_offset_a[x & (x - 1)] | kept_a[kept_n - 1 - low];
+        kept_offset_b[x] = kept_offset_b[x & (x - 1)] | kept_b[kept_n - 1 - low];
+    }
+    std::vector<size_t> shared_offset_a(size_t(1) << shared_n, 0), shared_offset_b(size_t(1) << shared_n, 0);
+    for (size_t x = 1; x < shared_offset_a.size(); x++)
+    {
+        const size_t low = __builtin_ctzll(x);
+        shared_offset_a[x] = shared_offset_a[x & (x - 1)] | shared_a[shared_n - 1 - low];
+        shared_offset_b[x] = shared_offset_b[x & (x - 1)] | shared_b[shared_n - 1 - low];
+    }
+
+    result.data.assign(kept_offset_a.size(), 0.0);
+    const std::complex<double> *data_a = a.data.data(), *data_b = b.data.data();
+    std::complex<double> *data_r = result.data.data();
+    parallel_for(0, result.data.size(), [&](size_t begin, size_t end)
+    {
+        for (size_t r = begin; r < end; r++)
+        {
+            const std::complex<double> *row_a = data_a + kept_offset_a[r], *row_b = data_b + kept_offset_b[r];
+            std::complex<double> sum = 0.0;
+            for (size_t s = 0; s < shared_offset_a.size(); s++)
+                sum += row_a[shared_offset_a[s]] * row_b[shared_offset_b[s]];
+            data_r[r] = sum;
+        }
+    });
+    return result;
+}
+
+std::complex<double> TensorNetwork::amplitude(const std::string &bitstring)
+{
+    return amplitudes(std::vector<std::string>{bitstring})[0];
+}
+
+std::vector<std::complex<double>> TensorNetwork::amplitudes(const std::vector<std::string> &bitstrings)
+{
+    for (auto it = bitstrings.begin(); it != bitstrings.end(); it++)
+        if (it->length() != qubit_n)
+            throw std::invalid_argument("The length of the state must be equal to the number of qubits!");
+    if (!planned)
+        plan_contraction();
+    if (cost.largest_tensor > MAX_TENSOR_ELEMENTS)
+        throw std::invalid_argument("The contraction path needs too much memory!");
+
+    // The nodes of the tree are the tensors, the output vectors, then the results of the path
+    const size_t input_n = tensors.size(), leaf_n = input_n + qubit_n;
+    std::vector<bool> depends(leaf_n + path.size(), false);
+    for (size_t i = input_n; i < leaf_n; i++)
+        depends[i] = true;
+    for (size_t k = 0; k < path.size(); k++)
+        depends[leaf_n + k] = depends[path[k].first] || depends[path[k].second];
+
+    // The nodes that do not depend on the bitstring are contracted once for the whole batch
+    std::vector<Tensor> nodes(leaf_n + path.size());
+    auto operand = [&](size_t id) -> const Tensor & { return id < input_n ? tensors[id] : nodes[id]; };
+    for (size_t k = 0; k < path.size(); k++)
+    {
+        if (depends[leaf_n + k])
+            continue;
+        nodes[leaf_n + k] = contract(operand(path[k].first), operand(path[k].second));
+        std::vector<std::complex<double>>().swap(nodes[path[k].first].data);
+        std::vector<std::complex<double>>().swap(nodes[path[k].second].data);
+    }
+
+    std::vector<std::complex<double>> result;
+    for (auto it = bitstrings.begin(); it != bitstrings.end(); it++)
+    {
+        for (size_t q = 0; q < qubit_n; q++)
+            nodes[input_n + q] = output_vector(q, (*it)[q]);
+        for (size_t k = 0; k < path.size(); k++)
+        {
+            if (!depends[leaf_n + k])
+                continue;
+            nodes[leaf_n + k] = contract(operand(path[k].first), operand(path[k].second));
+            // Operands that depend on the bitstring are not needed any more
+            if (path[k].first >= input_n && depends[path[k].first])
+                std::vector<std::complex<double>>().swap(nodes[path[k].first].data);
+            if (path[k].second >= input_n && depends[path[k].second])
+                std::vector<std::complex<double>>().swap(nodes[path[k].second].data);
+        }
+        result.push_back(nodes.back().data[0]);
+    }
+    return result;
+}
@@ -0,0 +1,180 @@
+#include "../include/ThreadPool.hpp"
+#include <memory>
+#include <algorithm>
+#include <exception>
+
+ThreadPool::ThreadPool(size_t thread_n)
+{
+    for (size_t i = 1; i < thread_n; i++)
+    {
+        workers.emplace_back(&ThreadPool::worker_loop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    task_available.notify_all();
+
+    for (auto it = workers.begin(); it != workers.end(); it++)
+    {
+        it->join();
+    }
+}
+
+/*
+Each worker waits for a task, runs it and reports back until the pool is destroyed. The tasks of
+parallel_for() catch the exceptions of their chunk, so a task never throws here.
+*/
+void ThreadPool::worker_loop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            task_available.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty())
+                return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+
+        task();
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            unfinished_tasks--;
+        }
+        task_finished.notify_all();
+    }
+}
+
+// True on a thread while it runs a chunk of a parallel_for(), the nested calls of the kernels then stay serial
+static thread_local bool inside_parallel_region = false;
+
+// Sets inside_parallel_region for the lifetime of a chunk and restores the previous value, also on unwind
+struct ParallelRegionGuard
+{
+    bool outer;
+
+    ParallelRegionGuard() : outer(inside_parallel_region) { inside_parallel_region = true; }
+    ~ParallelRegionGuard() { inside_parallel_region = outer; }
+};
+
+static void run_chunk(const std::function<void(size_t, size_t)> &body, size_t begin, size_t end)
+{
+    ParallelRegionGuard guard;
+    body(begin, end);
+}
+
+/*
+The queued tasks refer to body and to the local error, so the call always waits until every task is
+finished, even if a chunk (or queuing a task) throws. The first exception is rethrown afterwards on the
+calling thread.
+*/
+void ThreadPool::parallel_for(size_t begin, size_t end, size_t alignment, const std::function<void(size_t, size_t)> &body)
+{
+    if (end <= begin)
+        return;
+
+    const size_t thread_n = size();
+    // Chunk size rounded up to a multiple of the alignment
+    size_t chunk = (end - begin + thread_n - 1) / thread_n;
+    chunk = (chunk + alignment - 1) / alignment * alignment;
+
+    std::exception_ptr error;
+    auto run_guarded = [&](size_t chunk_begin, size_t chunk_end)
+    {
+        try
+        {
+            run_chunk(body, chunk_begin, chunk_end);
+        }
+        catch (...)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!error)
+                error = std::current_exception();
+        }
+    };
+
+    // The first chunk is kept for the calling thread, the others go to the workers
+    bool queued = true;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        try
+        {
+            for (size_t chunk_begin = begin + chunk; chunk_begin < end; chunk_begin += chunk)
+            {
+                size_t chunk_end = std::min(chunk_begin + chunk, end);
+                tasks.push_back([&run_guarded, chunk_begin, chunk_end] { run_guarded(chunk_begin, chunk_end); });
+                unfinished_tasks++;
+            }
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+            queued = false;
+        }
+    }
+    task_available.notify_all();
+
+    if (queued)
+        run_guarded(begin, std::min(begin + chunk, end));
+
+    std::unique_lock<std::mutex> lock(mutex);
+    task_finished.wait(lock, [this] { return unfinished_tasks == 0; });
+    if (error)
+        std::rethrow_exception(error);
+}
+
+static size_t default_thread_count()
+{
+    size_t hardware = std::thread::hardware_concurrency();
+    return hardware == 0 ? 1 : hardware;
+}
+
+static size_t thread_count = default_thread_count();
+static size_t parallel_grain = static_cast<size_t>(1) << 14;
+static std::unique_ptr<ThreadPool> global_pool;
+
+void set_thread_count(size_t thread_n)
+{
+    thread_count = std::max<size_t>(thread_n, 1);
+    global_pool.reset();
+}
+
+size_t get_thread_count()
+{
+    return thread_count;
+}
+
+void set_parallel_grain(size_t grain)
+{
+    parallel_grain = grain;
+}
+
+size_t get_parallel_grain()
+{
+    return parallel_grain;
+}
+
+void parallel_for(size_t begin, size_t end, const std::function<void(size_t, size_t)> &body, size_t alignment, size_t grain)
+{
+    if (end <= begin)
+        return;
+    if (thread_count == 1 || inside_parallel_region || end - begin < grain || end - begin < 2 * alignment)
+    {
+        body(begin, end);
+        return;
+    }
+
+    // The pool is created on first use, so purely serial runs never start any thread
+    if (!global_pool || global_pool->size() != thread_count)
+        global_pool = std::make_unique<ThreadPool>(thread_count);
+
+    global_pool->parallel_for(begin, end, alignment, body);
+}